@@ -0,0 +1,762 @@
+/*
+  ==============================================================================
+
+    CascadeKernel.cpp
+    The LowCut -> Peak -> HighCut cascade as one fused pass over the block.
+
+  ==============================================================================
+*/
+
+#include "CascadeKernel.h"
+
+namespace
+{
+    // a section with every coefficient already broadcast to the sample type
+    template <typename SampleType>
+    struct SectionOf
+    {
+        SampleType b0, b1, b2, a1, a2;
+    };
+
+    template <typename SampleType, typename CoefficientType>
+    SampleType broadcast(CoefficientType value) noexcept
+    {
+        if constexpr (std::is_floating_point_v<SampleType>)
+            return static_cast<SampleType>(value);
+        else
+            return SampleType::expand(value);
+    }
+
+    template <typename SampleType, typename CoefficientType>
+    SectionOf<SampleType> broadcast(const BiquadSectionOf<CoefficientType>& section) noexcept
+    {
+        return { broadcast<SampleType>(section.b0), broadcast<SampleType>(section.b1), broadcast<SampleType>(section.b2),
+                 broadcast<SampleType>(section.a1), broadcast<SampleType>(section.a2) };
+    }
+
+    // the double kernel reads the double designs, everything else the float ones
+    template <typename SampleType>
+    SectionOf<SampleType> getSection(const BiquadSection& section, const PreciseBiquadSection& preciseSection) noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return broadcast<SampleType>(preciseSection);
+        else
+            return broadcast<SampleType>(section);
+    }
+
+    template <int NumSections, typename SampleType>
+    forcedinline SampleType processSections(const SectionOf<SampleType>* coefficients, BiquadStateOf<SampleType>* state, SampleType x) noexcept
+    {
+        for (int i = 0; i < NumSections; ++i)
+        {
+            const auto& c = coefficients[i];
+            auto& s = state[i];
+
+            auto y = c.b0 * x + s.s1;
+            s.s1 = c.b1 * x - c.a1 * y + s.s2;
+            s.s2 = c.b2 * x - c.a2 * y;
+            x = y;
+        }
+
+        return x;
+    }
+
+    // sections whose bit is set in preciseMask run in double with their double memory, the sample goes from one
+    // to the next in double so nothing is lost in between. the branch goes the same way every sample of the block
+    template <int NumSections>
+    forcedinline double processMixedSections(const SectionOf<float>* coefficients, const SectionOf<double>* preciseCoefficients,
+                                             BiquadState* state, PreciseBiquadState* preciseState, juce::uint32 preciseMask, double x) noexcept
+    {
+        for (int i = 0; i < NumSections; ++i)
+        {
+            if ((preciseMask & (1u << i)) != 0)
+                x = processSections<1>(preciseCoefficients + i, preciseState + i, x);
+            else
+                x = processSections<1>(coefficients + i, state + i, static_cast<float>(x));
+        }
+
+        return x;
+    }
+
+    // s1 and s2 are the integrators ic1eq and ic2eq
+    template <typename SampleType>
+    forcedinline SampleType processStateVariablePeak(const SVFPeakCoefficients& coefficients, BiquadStateOf<SampleType>& state, SampleType x) noexcept
+    {
+        auto a1 = broadcast<SampleType>(coefficients.a1);
+        auto a2 = broadcast<SampleType>(coefficients.a2);
+        auto a3 = broadcast<SampleType>(coefficients.a3);
+        auto m1 = broadcast<SampleType>(coefficients.m1);
+
+        auto v3 = x - state.s2;
+        auto v1 = a1 * state.s1 + a2 * v3;
+        auto v2 = state.s2 + a2 * state.s1 + a3 * v3;
+        state.s1 = v1 + v1 - state.s1;
+        state.s2 = v2 + v2 - state.s2;
+
+        return x + m1 * v1;
+    }
+
+    template <int NumLowCut, int NumHighCut, PeakTopology Topology>
+    void processMixedCascade(const CascadeCoefficients& coefficients, CascadeState& state, float* samples, int numSamples,
+                             const SVFPeakCoefficients* peakRamp) noexcept
+    {
+        std::array<SectionOf<float>, NumLowCut> lowCut;
+        std::array<SectionOf<float>, NumHighCut> highCut;
+        std::array<SectionOf<double>, NumLowCut> preciseLowCut;
+        std::array<SectionOf<double>, NumHighCut> preciseHighCut;
+        std::array<BiquadState, NumLowCut> lowCutState;
+        std::array<BiquadState, NumHighCut> highCutState;
+        std::array<PreciseBiquadState, NumLowCut> preciseLowCutState;
+        std::array<PreciseBiquadState, NumHighCut> preciseHighCutState;
+
+        for (size_t i = 0; i < NumLowCut; ++i)
+        {
+            lowCut[i] = broadcast<float>(coefficients.lowCut[i]);
+            preciseLowCut[i] = broadcast<double>(coefficients.preciseLowCut[i]);
+        }
+
+        for (size_t i = 0; i < NumHighCut; ++i)
+        {
+            highCut[i] = broadcast<float>(coefficients.highCut[i]);
+            preciseHighCut[i] = broadcast<double>(coefficients.preciseHighCut[i]);
+        }
+
+        std::copy_n(state.lowCut.begin(), NumLowCut, lowCutState.begin());
+        std::copy_n(state.highCut.begin(), NumHighCut, highCutState.begin());
+        std::copy_n(state.preciseLowCut.begin(), NumLowCut, preciseLowCutState.begin());
+        std::copy_n(state.preciseHighCut.begin(), NumHighCut, preciseHighCutState.begin());
+
+        auto peak = broadcast<float>(coefficients.peak);
+        auto precisePeak = broadcast<double>(coefficients.precisePeak);
+        auto peakState = state.peak;
+        auto precisePeakState = state.precisePeak;
+
+        const auto& precision = coefficients.precision;
+        auto peakMask = precision.peak ? 1u : 0u;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = processMixedSections<NumLowCut>(lowCut.data(), preciseLowCut.data(), lowCutState.data(), preciseLowCutState.data(),
+                                                     precision.lowCut, static_cast<double>(samples[i]));
+
+            if constexpr (Topology == PeakTopology::StateVariable)
+                x = processStateVariablePeak(peakRamp[i], peakState, static_cast<float>(x));
+            else
+                x = processMixedSections<1>(&peak, &precisePeak, &peakState, &precisePeakState, peakMask, x);
+
+            samples[i] = static_cast<float>(processMixedSections<NumHighCut>(highCut.data(), preciseHighCut.data(), highCutState.data(),
+                                                                             preciseHighCutState.data(), precision.highCut, x));
+        }
+
+        std::copy_n(lowCutState.begin(), NumLowCut, state.lowCut.begin());
+        std::copy_n(highCutState.begin(), NumHighCut, state.highCut.begin());
+        std::copy_n(preciseLowCutState.begin(), NumLowCut, state.preciseLowCut.begin());
+        std::copy_n(preciseHighCutState.begin(), NumHighCut, state.preciseHighCut.begin());
+        state.peak = peakState;
+        state.precisePeak = precisePeakState;
+    }
+
+    template <typename SampleType, int NumLowCut, int NumHighCut, PeakTopology Topology>
+    void processCascade(const CascadeCoefficients& coefficients, CascadeStateOf<SampleType>& state, SampleType* samples, int numSamples,
+                        const SVFPeakCoefficients* peakRamp) noexcept
+    {
+        jassert(Topology == PeakTopology::Biquad || peakRamp != nullptr);
+        juce::ignoreUnused(peakRamp);
+
+        // the SIMD path has no double lanes, the processor keeps mixed cascades on the scalar path
+        jassert((std::is_same_v<SampleType, float> || std::is_same_v<SampleType, double> || ! coefficients.precision.isMixed()));
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            if (coefficients.precision.isMixed())
+            {
+                processMixedCascade<NumLowCut, NumHighCut, Topology>(coefficients, state, samples, numSamples, peakRamp);
+                return;
+            }
+        }
+
+        // local copies, so nothing the compiler has to assume aliases the samples and it all stays in registers
+        std::array<SectionOf<SampleType>, NumLowCut> lowCut;
+        std::array<SectionOf<SampleType>, NumHighCut> highCut;
+        std::array<BiquadStateOf<SampleType>, NumLowCut> lowCutState;
+        std::array<BiquadStateOf<SampleType>, NumHighCut> highCutState;
+
+        for (size_t i = 0; i < NumLowCut; ++i)
+            lowCut[i] = getSection<SampleType>(coefficients.lowCut[i], coefficients.preciseLowCut[i]);
+
+        for (size_t i = 0; i < NumHighCut; ++i)
+            highCut[i] = getSection<SampleType>(coefficients.highCut[i], coefficients.preciseHighCut[i]);
+
+        std::copy_n(state.lowCut.begin(), NumLowCut, lowCutState.begin());
+        std::copy_n(state.highCut.begin(), NumHighCut, highCutState.begin());
+
+        auto peak = getSection<SampleType>(coefficients.peak, coefficients.precisePeak);
+        auto peakState = state.peak;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = processSections<NumLowCut>(lowCut.data(), lowCutState.data(), samples[i]);
+
+            if constexpr (Topology == PeakTopology::StateVariable)
+                x = processStateVariablePeak(peakRamp[i], peakState, x);
+            else
+                x = processSections<1>(&peak, &peakState, x);
+
+            samples[i] = processSections<NumHighCut>(highCut.data(), highCutState.data(), x);
+        }
+
+        std::copy_n(lowCutState.begin(), NumLowCut, state.lowCut.begin());
+        std::copy_n(highCutState.begin(), NumHighCut, state.highCut.begin());
+        state.peak = peakState;
+    }
+
+    // one cascade with its coefficients and memory in locals for the length of a block, the peak always a biquad
+    template <typename SampleType, int NumLowCut, int NumHighCut>
+    struct LocalCascade
+    {
+        LocalCascade(const CascadeCoefficients& coefficients, const CascadeStateOf<SampleType>& state) noexcept
+        {
+            for (size_t i = 0; i < NumLowCut; ++i)
+                lowCut[i] = getSection<SampleType>(coefficients.lowCut[i], coefficients.preciseLowCut[i]);
+
+            for (size_t i = 0; i < NumHighCut; ++i)
+                highCut[i] = getSection<SampleType>(coefficients.highCut[i], coefficients.preciseHighCut[i]);
+
+            std::copy_n(state.lowCut.begin(), NumLowCut, lowCutState.begin());
+            std::copy_n(state.highCut.begin(), NumHighCut, highCutState.begin());
+            peak = getSection<SampleType>(coefficients.peak, coefficients.precisePeak);
+            peakState = state.peak;
+        }
+
+        forcedinline SampleType process(SampleType x) noexcept
+        {
+            x = processSections<NumLowCut>(lowCut.data(), lowCutState.data(), x);
+            x = processSections<1>(&peak, &peakState, x);
+            return processSections<NumHighCut>(highCut.data(), highCutState.data(), x);
+        }
+
+        void store(CascadeStateOf<SampleType>& state) const noexcept
+        {
+            std::copy_n(lowCutState.begin(), NumLowCut, state.lowCut.begin());
+            std::copy_n(highCutState.begin(), NumHighCut, state.highCut.begin());
+            state.peak = peakState;
+        }
+
+        std::array<SectionOf<SampleType>, NumLowCut> lowCut;
+        std::array<SectionOf<SampleType>, NumHighCut> highCut;
+        std::array<BiquadStateOf<SampleType>, NumLowCut> lowCutState;
+        std::array<BiquadStateOf<SampleType>, NumHighCut> highCutState;
+        SectionOf<SampleType> peak;
+        BiquadStateOf<SampleType> peakState;
+    };
+
+    // the same for a float cascade with some of its sections in double, see processMixedCascade
+    template <int NumLowCut, int NumHighCut>
+    struct LocalMixedCascade
+    {
+        LocalMixedCascade(const CascadeCoefficients& coefficients, const CascadeState& state) noexcept
+            : precision(coefficients.precision)
+        {
+            for (size_t i = 0; i < NumLowCut; ++i)
+            {
+                lowCut[i] = broadcast<float>(coefficients.lowCut[i]);
+                preciseLowCut[i] = broadcast<double>(coefficients.preciseLowCut[i]);
+            }
+
+            for (size_t i = 0; i < NumHighCut; ++i)
+            {
+                highCut[i] = broadcast<float>(coefficients.highCut[i]);
+                preciseHighCut[i] = broadcast<double>(coefficients.preciseHighCut[i]);
+            }
+
+            std::copy_n(state.lowCut.begin(), NumLowCut, lowCutState.begin());
+            std::copy_n(state.highCut.begin(), NumHighCut, highCutState.begin());
+            std::copy_n(state.preciseLowCut.begin(), NumLowCut, preciseLowCutState.begin());
+            std::copy_n(state.preciseHighCut.begin(), NumHighCut, preciseHighCutState.begin());
+
+            peak = broadcast<float>(coefficients.peak);
+            precisePeak = broadcast<double>(coefficients.precisePeak);
+            peakState = state.peak;
+            precisePeakState = state.precisePeak;
+        }
+
+        forcedinline double process(double x) noexcept
+        {
+            x = processMixedSections<NumLowCut>(lowCut.data(), preciseLowCut.data(), lowCutState.data(), preciseLowCutState.data(),
+                                                precision.lowCut, x);
+            x = processMixedSections<1>(&peak, &precisePeak, &peakState, &precisePeakState, precision.peak ? 1u : 0u, x);
+            return processMixedSections<NumHighCut>(highCut.data(), preciseHighCut.data(), highCutState.data(), preciseHighCutState.data(),
+                                                    precision.highCut, x);
+        }
+
+        void store(CascadeState& state) const noexcept
+        {
+            std::copy_n(lowCutState.begin(), NumLowCut, state.lowCut.begin());
+            std::copy_n(highCutState.begin(), NumHighCut, state.highCut.begin());
+            std::copy_n(preciseLowCutState.begin(), NumLowCut, state.preciseLowCut.begin());
+            std::copy_n(preciseHighCutState.begin(), NumHighCut, state.preciseHighCut.begin());
+            state.peak = peakState;
+            state.precisePeak = precisePeakState;
+        }
+
+        SectionPrecision precision;
+        std::array<SectionOf<float>, NumLowCut> lowCut;
+        std::array<SectionOf<float>, NumHighCut> highCut;
+        std::array<SectionOf<double>, NumLowCut> preciseLowCut;
+        std::array<SectionOf<double>, NumHighCut> preciseHighCut;
+        std::array<BiquadState, NumLowCut> lowCutState;
+        std::array<BiquadState, NumHighCut> highCutState;
+        std::array<PreciseBiquadState, NumLowCut> preciseLowCutState;
+        std::array<PreciseBiquadState, NumHighCut> preciseHighCutState;
+        SectionOf<float> peak;
+        SectionOf<double> precisePeak;
+        BiquadState peakState;
+        PreciseBiquadState precisePeakState;
+    };
+
+    // the encode, both cascades and the decode in one pass. mid and side are two independent dependency
+    // chains through the same loop, so the core overlaps them the way it overlaps two channels
+    template <typename SampleType, int NumLowCut, int NumHighCut>
+    void processMidSideCascade(const CascadeCoefficients& mid, const CascadeCoefficients& side,
+                               CascadeStateOf<SampleType>& midState, CascadeStateOf<SampleType>& sideState,
+                               SampleType* left, SampleType* right, int numSamples) noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            if (mid.precision.isMixed() || side.precision.isMixed())
+            {
+                LocalMixedCascade<NumLowCut, NumHighCut> midPath(mid, midState), sidePath(side, sideState);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    auto l = static_cast<double>(left[i]), r = static_cast<double>(right[i]);
+                    auto m = midPath.process(0.5 * (l + r));
+                    auto s = sidePath.process(0.5 * (l - r));
+                    left[i] = static_cast<float>(m + s);
+                    right[i] = static_cast<float>(m - s);
+                }
+
+                midPath.store(midState);
+                sidePath.store(sideState);
+                return;
+            }
+        }
+
+        LocalCascade<SampleType, NumLowCut, NumHighCut> midPath(mid, midState), sidePath(side, sideState);
+        const auto half = static_cast<SampleType>(0.5);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto l = left[i], r = right[i];
+            auto m = midPath.process(half * (l + r));
+            auto s = sidePath.process(half * (l - r));
+            left[i] = m + s;
+            right[i] = m - s;
+        }
+
+        midPath.store(midState);
+        sidePath.store(sideState);
+    }
+
+    // indexed by section count - 1
+    template <typename SampleType, PeakTopology Topology, size_t LowCut, size_t... HighCut>
+    constexpr std::array<CascadeProcessFunctionOf<SampleType>, maxCutSections> makeDispatchRow(std::index_sequence<HighCut...>) noexcept
+    {
+        return { { &processCascade<SampleType, static_cast<int>(LowCut) + 1, static_cast<int>(HighCut) + 1, Topology>... } };
+    }
+
+    template <typename SampleType, PeakTopology Topology, size_t... LowCut>
+    constexpr std::array<std::array<CascadeProcessFunctionOf<SampleType>, maxCutSections>, maxCutSections> makeDispatchTable(std::index_sequence<LowCut...>) noexcept
+    {
+        return { { makeDispatchRow<SampleType, Topology, LowCut>(std::make_index_sequence<maxCutSections>())... } };
+    }
+
+    constexpr auto dispatchTable = makeDispatchTable<float, PeakTopology::Biquad>(std::make_index_sequence<maxCutSections>());
+    constexpr auto simdDispatchTable = makeDispatchTable<SIMDSample, PeakTopology::Biquad>(std::make_index_sequence<maxCutSections>());
+    constexpr auto stateVariableDispatchTable = makeDispatchTable<float, PeakTopology::StateVariable>(std::make_index_sequence<maxCutSections>());
+    constexpr auto simdStateVariableDispatchTable = makeDispatchTable<SIMDSample, PeakTopology::StateVariable>(std::make_index_sequence<maxCutSections>());
+    constexpr auto preciseDispatchTable = makeDispatchTable<double, PeakTopology::Biquad>(std::make_index_sequence<maxCutSections>());
+    constexpr auto preciseStateVariableDispatchTable = makeDispatchTable<double, PeakTopology::StateVariable>(std::make_index_sequence<maxCutSections>());
+
+    template <typename SampleType, size_t LowCut, size_t... HighCut>
+    constexpr std::array<MidSideProcessFunctionOf<SampleType>, maxCutSections> makeMidSideDispatchRow(std::index_sequence<HighCut...>) noexcept
+    {
+        return { { &processMidSideCascade<SampleType, static_cast<int>(LowCut) + 1, static_cast<int>(HighCut) + 1>... } };
+    }
+
+    template <typename SampleType, size_t... LowCut>
+    constexpr std::array<std::array<MidSideProcessFunctionOf<SampleType>, maxCutSections>, maxCutSections> makeMidSideDispatchTable(std::index_sequence<LowCut...>) noexcept
+    {
+        return { { makeMidSideDispatchRow<SampleType, LowCut>(std::make_index_sequence<maxCutSections>())... } };
+    }
+
+    constexpr auto midSideDispatchTable = makeMidSideDispatchTable<float>(std::make_index_sequence<maxCutSections>());
+    constexpr auto preciseMidSideDispatchTable = makeMidSideDispatchTable<double>(std::make_index_sequence<maxCutSections>());
+
+    size_t getDispatchIndex(int numSections) noexcept
+    {
+        jassert(numSections >= 1 && numSections <= maxCutSections);
+        return static_cast<size_t>(juce::jlimit(1, maxCutSections, numSections) - 1);
+    }
+}
+
+PreciseBiquadSection makePreciseBiquadSection(const BiquadCoefficients& coefficients) noexcept
+{
+    auto a0 = coefficients[3];
+    jassert(a0 != 0);
+
+    PreciseBiquadSection section;
+    section.b0 = coefficients[0] / a0;
+    section.b1 = coefficients[1] / a0;
+    section.b2 = coefficients[2] / a0;
+    section.a1 = coefficients[4] / a0;
+    section.a2 = coefficients[5] / a0;
+
+    return section;
+}
+
+BiquadSection makeBiquadSection(const BiquadCoefficients& coefficients) noexcept
+{
+    // normalised in double, rounded once
+    auto precise = makePreciseBiquadSection(coefficients);
+
+    return { static_cast<float>(precise.b0), static_cast<float>(precise.b1), static_cast<float>(precise.b2),
+             static_cast<float>(precise.a1), static_cast<float>(precise.a2) };
+}
+
+CascadeCoefficients makeCascadeCoefficients(const CutCoefficients& lowCut, int numLowCutSections,
+                                            const CutCoefficients& peak,
+                                            const CutCoefficients& highCut, int numHighCutSections) noexcept
+{
+    CascadeCoefficients cascade;
+
+    for (size_t i = 0; i < static_cast<size_t>(numLowCutSections); ++i)
+    {
+        cascade.lowCut[i] = makeBiquadSection(lowCut[i]);
+        cascade.preciseLowCut[i] = makePreciseBiquadSection(lowCut[i]);
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(numHighCutSections); ++i)
+    {
+        cascade.highCut[i] = makeBiquadSection(highCut[i]);
+        cascade.preciseHighCut[i] = makePreciseBiquadSection(highCut[i]);
+    }
+
+    cascade.peak = makeBiquadSection(peak[0]);
+    cascade.precisePeak = makePreciseBiquadSection(peak[0]);
+    cascade.numLowCutSections = numLowCutSections;
+    cascade.numHighCutSections = numHighCutSections;
+
+    return cascade;
+}
+
+CascadeProcessFunction getCascadeProcessFunction(int numLowCutSections, int numHighCutSections, PeakTopology peakTopology) noexcept
+{
+    const auto& table = peakTopology == PeakTopology::StateVariable ? stateVariableDispatchTable : dispatchTable;
+    return table[getDispatchIndex(numLowCutSections)][getDispatchIndex(numHighCutSections)];
+}
+
+SIMDCascadeProcessFunction getSIMDCascadeProcessFunction(int numLowCutSections, int numHighCutSections, PeakTopology peakTopology) noexcept
+{
+    const auto& table = peakTopology == PeakTopology::StateVariable ? simdStateVariableDispatchTable : simdDispatchTable;
+    return table[getDispatchIndex(numLowCutSections)][getDispatchIndex(numHighCutSections)];
+}
+
+PreciseCascadeProcessFunction getPreciseCascadeProcessFunction(int numLowCutSections, int numHighCutSections, PeakTopology peakTopology) noexcept
+{
+    const auto& table = peakTopology == PeakTopology::StateVariable ? preciseStateVariableDispatchTable : preciseDispatchTable;
+    return table[getDispatchIndex(numLowCutSections)][getDispatchIndex(numHighCutSections)];
+}
+
+MidSideProcessFunction getMidSideProcessFunction(int numLowCutSections, int numHighCutSections) noexcept
+{
+    return midSideDispatchTable[getDispatchIndex(numLowCutSections)][getDispatchIndex(numHighCutSections)];
+}
+
+PreciseMidSideProcessFunction getPreciseMidSideProcessFunction(int numLowCutSections, int numHighCutSections) noexcept
+{
+    return preciseMidSideDispatchTable[getDispatchIndex(numLowCutSections)][getDispatchIndex(numHighCutSections)];
+}
+
+SectionPrecision getSectionPrecision(const CascadeCoefficients& coefficients, bool includeCuts, bool includePeak) noexcept
+{
+    auto getMask = [](const std::array<PreciseBiquadSection, maxCutSections>& sections, int numSections)
+    {
+        juce::uint32 mask = 0;
+
+        for (int i = 0; i < numSections; ++i)
+            if (getPoleRadius(sections[static_cast<size_t>(i)]) > mixedPrecisionPoleRadius)
+                mask |= 1u << i;
+
+        return mask;
+    };
+
+    SectionPrecision precision;
+
+    if (includeCuts)
+    {
+        precision.lowCut = getMask(coefficients.preciseLowCut, coefficients.numLowCutSections);
+        precision.highCut = getMask(coefficients.preciseHighCut, coefficients.numHighCutSections);
+    }
+
+    precision.peak = includePeak && getPoleRadius(coefficients.precisePeak) > mixedPrecisionPoleRadius;
+    return precision;
+}
+
+CascadeProcessFunction getPeakProcessFunction(PeakTopology peakTopology) noexcept
+{
+    return peakTopology == PeakTopology::StateVariable ? &processCascade<float, 0, 0, PeakTopology::StateVariable>
+                                                       : &processCascade<float, 0, 0, PeakTopology::Biquad>;
+}
+
+PreciseCascadeProcessFunction getPrecisePeakProcessFunction(PeakTopology peakTopology) noexcept
+{
+    return peakTopology == PeakTopology::StateVariable ? &processCascade<double, 0, 0, PeakTopology::StateVariable>
+                                                       : &processCascade<double, 0, 0, PeakTopology::Biquad>;
+}
+
+SIMDCascadeProcessFunction getSIMDPeakProcessFunction(PeakTopology peakTopology) noexcept
+{
+    return peakTopology == PeakTopology::StateVariable ? &processCascade<SIMDSample, 0, 0, PeakTopology::StateVariable>
+                                                       : &processCascade<SIMDSample, 0, 0, PeakTopology::Biquad>;
+}
+
+float approximateTan(float x) noexcept
+{
+    jassert(x >= 0.0f && x < juce::MathConstants<float>::halfPi);
+
+    auto x2 = x * x;
+    return x * (945.0f - x2 * (105.0f - x2)) / (945.0f - x2 * (420.0f - 15.0f * x2));
+}
+
+SVFPeakCoefficients makeSVFPeakCoefficients(float g, float quality, float amplitude) noexcept
+{
+    auto k = 1.0f / (quality * amplitude);
+
+    SVFPeakCoefficients coefficients;
+    coefficients.a1 = 1.0f / (1.0f + g * (g + k));
+    coefficients.a2 = g * coefficients.a1;
+    coefficients.a3 = g * coefficients.a2;
+    coefficients.m1 = k * (amplitude * amplitude - 1.0f);
+
+    return coefficients;
+}
+
+bool statesMatch(const CascadeState& a, const CascadeState& b, float tolerance) noexcept
+{
+    auto match = [tolerance](const BiquadState& x, const BiquadState& y)
+    {
+        return std::abs(x.s1 - y.s1) <= tolerance && std::abs(x.s2 - y.s2) <= tolerance;
+    };
+
+    auto matchPrecise = [tolerance](const PreciseBiquadState& x, const PreciseBiquadState& y)
+    {
+        return std::abs(x.s1 - y.s1) <= tolerance && std::abs(x.s2 - y.s2) <= tolerance;
+    };
+
+    for (size_t i = 0; i < maxCutSections; ++i)
+        if (! match(a.lowCut[i], b.lowCut[i]) || ! match(a.highCut[i], b.highCut[i])
+            || ! matchPrecise(a.preciseLowCut[i], b.preciseLowCut[i]) || ! matchPrecise(a.preciseHighCut[i], b.preciseHighCut[i]))
+            return false;
+
+    return match(a.peak, b.peak) && matchPrecise(a.precisePeak, b.precisePeak);
+}
+
+void changeSectionPrecision(CascadeState& state, SectionPrecision from, SectionPrecision to) noexcept
+{
+    // the memory carries straight over, rounding to float is far below anything audible for one sample
+    auto change = [](BiquadState& single, PreciseBiquadState& precise, bool wasPrecise, bool isPrecise)
+    {
+        if (wasPrecise == isPrecise)
+            return;
+
+        if (isPrecise)
+        {
+            precise = { single.s1, single.s2 };
+            single = {};
+        }
+        else
+        {
+            single = { static_cast<float>(precise.s1), static_cast<float>(precise.s2) };
+            precise = {};
+        }
+    };
+
+    for (size_t i = 0; i < maxCutSections; ++i)
+    {
+        auto bit = 1u << i;
+        change(state.lowCut[i], state.preciseLowCut[i], (from.lowCut & bit) != 0, (to.lowCut & bit) != 0);
+        change(state.highCut[i], state.preciseHighCut[i], (from.highCut & bit) != 0, (to.highCut & bit) != 0);
+    }
+
+    change(state.peak, state.precisePeak, from.peak, to.peak);
+}
+
+void copyStateToLane(const CascadeState& source, SIMDCascadeState& destination, size_t lane) noexcept
+{
+    auto copy = [lane](const BiquadState& from, BiquadStateOf<SIMDSample>& to)
+    {
+        to.s1.set(lane, from.s1);
+        to.s2.set(lane, from.s2);
+    };
+
+    for (size_t i = 0; i < maxCutSections; ++i)
+    {
+        copy(source.lowCut[i], destination.lowCut[i]);
+        copy(source.highCut[i], destination.highCut[i]);
+    }
+
+    copy(source.peak, destination.peak);
+}
+
+void copyStateFromLane(const SIMDCascadeState& source, size_t lane, CascadeState& destination) noexcept
+{
+    auto copy = [lane](const BiquadStateOf<SIMDSample>& from, BiquadState& to)
+    {
+        to.s1 = from.s1.get(lane);
+        to.s2 = from.s2.get(lane);
+    };
+
+    for (size_t i = 0; i < maxCutSections; ++i)
+    {
+        copy(source.lowCut[i], destination.lowCut[i]);
+        copy(source.highCut[i], destination.highCut[i]);
+    }
+
+    copy(source.peak, destination.peak);
+}
+
+void interleave(const float* const* channels, int numChannels, SIMDSample* frames, int numSamples) noexcept
+{
+    jassert(numChannels <= static_cast<int>(SIMDSample::SIMDNumElements));
+
+    // a SIMDRegister is laid out as its lanes back to back, so the frames can be written as plain floats
+    auto* lanes = reinterpret_cast<float*>(frames);
+    constexpr auto stride = static_cast<int>(SIMDSample::SIMDNumElements);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = channels[channel];
+
+        for (int i = 0; i < numSamples; ++i)
+            lanes[i * stride + channel] = source[i];
+    }
+
+    // lanes without a channel would otherwise filter whatever the last group left in the frames
+    for (int channel = numChannels; channel < stride; ++channel)
+        for (int i = 0; i < numSamples; ++i)
+            lanes[i * stride + channel] = 0;
+}
+
+void deinterleave(const SIMDSample* frames, float* const* channels, int numChannels, int numSamples) noexcept
+{
+    jassert(numChannels <= static_cast<int>(SIMDSample::SIMDNumElements));
+
+    const auto* lanes = reinterpret_cast<const float*>(frames);
+    constexpr auto stride = static_cast<int>(SIMDSample::SIMDNumElements);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* destination = channels[channel];
+
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] = lanes[i * stride + channel];
+    }
+}
+
+double getPoleRadius(const BiquadSection& section) noexcept
+{
+    return getPoleRadius(PreciseBiquadSection{ section.b0, section.b1, section.b2, section.a1, section.a2 });
+}
+
+double getPoleRadius(const PreciseBiquadSection& section) noexcept
+{
+    // poles of z^2 + a1 z + a2, a complex pair sits at radius sqrt(a2)
+    auto a1 = section.a1;
+    auto a2 = section.a2;
+    auto discriminant = a1 * a1 - 4.0 * a2;
+
+    if (discriminant < 0.0)
+        return std::sqrt(a2);
+
+    auto root = std::sqrt(discriminant);
+    return juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root)) * 0.5;
+}
+
+int getTailLengthSamples(const CascadeCoefficients& coefficients, float decayDecibels, bool includeCuts) noexcept
+{
+    jassert(decayDecibels > 0.0f);
+    // straight from the decibels, Decibels::decibelsToGain would call anything under -100 dB zero
+    auto logThreshold = -static_cast<double>(decayDecibels) * std::log(10.0) / 20.0;
+
+    // each section's envelope falls by its pole radius every sample. running them one after another stretches
+    // the tail, adding the sections' decay times up lands at one to two times the measured impulse response
+    // of the butterworth cascades, so hosts and the silence gate never cut it short by much
+    auto getSectionTail = [logThreshold](const PreciseBiquadSection& section)
+    {
+        auto radius = getPoleRadius(section);
+
+        // an unstable or marginal section would ring forever, the designs should never hand us one
+        jassert(radius < 1.0);
+        radius = juce::jlimit(0.0, 1.0 - 1.0e-9, radius);
+
+        // two samples of FIR memory even when the poles are at the origin
+        return radius <= 0.0 ? 2.0 : 2.0 + logThreshold / std::log(radius);
+    };
+
+    auto tail = getSectionTail(coefficients.precisePeak);
+
+    if (! includeCuts)
+        return static_cast<int>(std::ceil(tail));
+
+    for (int i = 0; i < coefficients.numLowCutSections; ++i)
+        tail += getSectionTail(coefficients.preciseLowCut[static_cast<size_t>(i)]);
+
+    for (int i = 0; i < coefficients.numHighCutSections; ++i)
+        tail += getSectionTail(coefficients.preciseHighCut[static_cast<size_t>(i)]);
+
+    return static_cast<int>(juce::jmin(std::ceil(tail), static_cast<double>(std::numeric_limits<int>::max())));
+}
+
+float measureSIMDDeviation(const CascadeCoefficients& mixedCoefficients, int numSamples, const SVFPeakCoefficients* peakRamp)
+{
+    // the lanes are float all the way, so compare them against the float kernel without any double sections
+    auto coefficients = mixedCoefficients;
+    coefficients.precision = {};
+
+    auto topology = peakRamp != nullptr ? PeakTopology::StateVariable : PeakTopology::Biquad;
+    auto process = getCascadeProcessFunction(coefficients.numLowCutSections, coefficients.numHighCutSections, topology);
+    auto processSIMD = getSIMDCascadeProcessFunction(coefficients.numLowCutSections, coefficients.numHighCutSections, topology);
+
+    constexpr auto numLanes = static_cast<int>(SIMDSample::SIMDNumElements);
+
+    // different noise in every lane, so a lane mix up shows as well
+    juce::Random random(0x5eed);
+    juce::AudioBuffer<float> scalar(numLanes, numSamples), simd(numLanes, numSamples);
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        for (int i = 0; i < numSamples; ++i)
+            scalar.setSample(lane, i, random.nextFloat() * 2.f - 1.f);
+
+    simd.makeCopyOf(scalar);
+
+    std::vector<SIMDSample> frames(static_cast<size_t>(numSamples));
+    SIMDCascadeState simdState;
+
+    interleave(simd.getArrayOfReadPointers(), numLanes, frames.data(), numSamples);
+    processSIMD(coefficients, simdState, frames.data(), numSamples, peakRamp);
+    deinterleave(frames.data(), simd.getArrayOfWritePointers(), numLanes, numSamples);
+
+    auto deviation = 0.f;
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        CascadeState state;
+        process(coefficients, state, scalar.getWritePointer(lane), numSamples, peakRamp);
+
+        for (int i = 0; i < numSamples; ++i)
+            deviation = juce::jmax(deviation, std::abs(scalar.getSample(lane, i) - simd.getSample(lane, i)));
+    }
+
+    return deviation;
+}
@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    CascadeKernel.h
+    The LowCut -> Peak -> HighCut cascade as one fused pass over the block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "CoefficientCache.h"
+
+// one section, already normalised by a0
+template <typename CoefficientType>
+struct BiquadSectionOf
+{
+    CoefficientType b0{ 1 }, b1{ 0 }, b2{ 0 }, a1{ 0 }, a2{ 0 };
+};
+
+using BiquadSection = BiquadSectionOf<float>;
+using PreciseBiquadSection = BiquadSectionOf<double>;
+
+// transposed direct form II, same as juce::dsp::IIR::Filter. SampleType is float, double, or a
+// SIMDRegister holding one channel per lane when the channels run side by side
+template <typename SampleType>
+struct BiquadStateOf
+{
+    SampleType s1{}, s2{};
+};
+
+using BiquadState = BiquadStateOf<float>;
+using PreciseBiquadState = BiquadStateOf<double>;
+using SIMDSample = juce::dsp::SIMDRegister<float>;
+
+constexpr int maxCutSections = 8;
+
+// sections whose poles sit within 1% of the unit circle run in double in the float kernel. float coefficients
+// and memory leave those sections less than 90 dB clean (a steep 20 Hz LowCut section at 192 kHz gets down to ~35 dB),
+// everything further in stays above ~95 dB in plain float
+constexpr double mixedPrecisionPoleRadius = 0.99;
+
+// which sections the float kernel runs in double (mixed precision), bit i for section i of a cut
+struct SectionPrecision
+{
+    juce::uint32 lowCut{ 0 }, highCut{ 0 };
+    bool peak{ false };
+
+    bool isMixed() const noexcept { return lowCut != 0 || highCut != 0 || peak; }
+    bool operator==(const SectionPrecision& other) const noexcept { return lowCut == other.lowCut && highCut == other.highCut && peak == other.peak; }
+    bool operator!=(const SectionPrecision& other) const noexcept { return ! (*this == other); }
+};
+
+// everything the kernel reads, built by the designer so the audio thread never normalises anything
+struct CascadeCoefficients
+{
+    std::array<BiquadSection, maxCutSections> lowCut{}, highCut{};
+    BiquadSection peak;
+
+    // the same sections in double, for the double precision kernels and the mixed precision sections
+    std::array<PreciseBiquadSection, maxCutSections> preciseLowCut{}, preciseHighCut{};
+    PreciseBiquadSection precisePeak;
+
+    // how many of the sections above are active, which depends on both the slope and the cut filter type
+    int numLowCutSections{ 1 }, numHighCutSections{ 1 };
+
+    SectionPrecision precision;
+};
+
+// the Peak band as a topology preserving state variable filter (Andrew Simper's bell), same response as
+// makePeakFilter but its coefficients are a handful of multiplies away from frequency, Q and gain, so they
+// can follow a smoothed parameter every few samples. the kernel reads one set per sample
+struct SVFPeakCoefficients
+{
+    float a1{ 1 }, a2{ 0 }, a3{ 0 }, m1{ 0 };
+};
+
+// tan(x) for 0 <= x < pi/2 as a [5/4] pade approximant, under 0.01 cents of tuning error up to 0.47 fs
+float approximateTan(float x) noexcept;
+
+// g is tan(pi f / fs), amplitude is the square root of the linear gain (10^(dB / 40))
+SVFPeakCoefficients makeSVFPeakCoefficients(float g, float quality, float amplitude) noexcept;
+
+// the filter memory of one channel's chain, or of one lane per channel for the SIMD path
+template <typename SampleType>
+struct CascadeStateOf
+{
+    std::array<BiquadStateOf<SampleType>, maxCutSections> lowCut{}, highCut{};
+    // s1 and s2 hold the two integrator states instead while the peak runs as a state variable filter
+    BiquadStateOf<SampleType> peak;
+
+    // the double memory of the mixed precision sections, only the float kernel uses it
+    std::array<PreciseBiquadState, maxCutSections> preciseLowCut{}, preciseHighCut{};
+    PreciseBiquadState precisePeak;
+
+    void reset() noexcept { *this = {}; }
+};
+
+using CascadeState = CascadeStateOf<float>;
+using PreciseCascadeState = CascadeStateOf<double>;
+using SIMDCascadeState = CascadeStateOf<SIMDSample>;
+
+// true when every state of a and b is within tolerance of each other
+bool statesMatch(const CascadeState& a, const CascadeState& b, float tolerance) noexcept;
+
+// moves the memory of every section whose precision changes between its float and double state
+void changeSectionPrecision(CascadeState& state, SectionPrecision from, SectionPrecision to) noexcept;
+
+// moving a channel's memory in and out of a lane, for switching between the scalar and SIMD paths
+void copyStateToLane(const CascadeState& source, SIMDCascadeState& destination, size_t lane) noexcept;
+void copyStateFromLane(const SIMDCascadeState& source, size_t lane, CascadeState& destination) noexcept;
+
+// the SIMD path works on frames, one SIMDSample per sample index with channel n in lane n
+void interleave(const float* const* channels, int numChannels, SIMDSample* frames, int numSamples) noexcept;
+void deinterleave(const SIMDSample* frames, float* const* channels, int numChannels, int numSamples) noexcept;
+
+BiquadSection makeBiquadSection(const BiquadCoefficients& coefficients) noexcept;
+PreciseBiquadSection makePreciseBiquadSection(const BiquadCoefficients& coefficients) noexcept;
+CascadeCoefficients makeCascadeCoefficients(const CutCoefficients& lowCut, int numLowCutSections,
+                                            const CutCoefficients& peak,
+                                            const CutCoefficients& highCut, int numHighCutSections) noexcept;
+
+// the sections of a cascade whose pole radius is past mixedPrecisionPoleRadius. leave out the stages that aren't running
+SectionPrecision getSectionPrecision(const CascadeCoefficients& coefficients, bool includeCuts, bool includePeak) noexcept;
+
+/*
+    One instantiation per pair of LowCut/HighCut section counts (1 to 8 each), so the counts are
+    known at compile time. Every sample goes through all active sections and the peak before the next
+    one is read, so the block is read and written once instead of once per stage, the loops
+    are fully unrolled, and the out of order core can overlap section n of one sample with
+    section n + 1 of the previous one.
+
+    With PeakTopology::StateVariable the peak section is replaced by the state variable filter, reading
+    peakRamp[i] for sample i. The biquad variants ignore peakRamp, pass nullptr.
+
+    The float kernel runs the sections flagged in coefficients.precision with double coefficients and
+    memory, carrying the sample between sections in double while it does. The double kernel runs every
+    section in double, the SIMD one ignores the flags, so don't hand it a mixed cascade.
+*/
+template <typename SampleType>
+using CascadeProcessFunctionOf = void (*)(const CascadeCoefficients&, CascadeStateOf<SampleType>&, SampleType*, int,
+                                          const SVFPeakCoefficients* peakRamp) noexcept;
+
+using CascadeProcessFunction = CascadeProcessFunctionOf<float>;
+using PreciseCascadeProcessFunction = CascadeProcessFunctionOf<double>;
+using SIMDCascadeProcessFunction = CascadeProcessFunctionOf<SIMDSample>;
+
+// just the peak, for when the cuts run in the linear phase convolver instead
+CascadeProcessFunction getPeakProcessFunction(PeakTopology peakTopology) noexcept;
+PreciseCascadeProcessFunction getPrecisePeakProcessFunction(PeakTopology peakTopology) noexcept;
+SIMDCascadeProcessFunction getSIMDPeakProcessFunction(PeakTopology peakTopology) noexcept;
+
+// pick these when the section counts or the peak topology change, not per block
+CascadeProcessFunction getCascadeProcessFunction(int numLowCutSections, int numHighCutSections,
+                                                 PeakTopology peakTopology = PeakTopology::Biquad) noexcept;
+SIMDCascadeProcessFunction getSIMDCascadeProcessFunction(int numLowCutSections, int numHighCutSections,
+                                                         PeakTopology peakTopology = PeakTopology::Biquad) noexcept;
+PreciseCascadeProcessFunction getPreciseCascadeProcessFunction(int numLowCutSections, int numHighCutSections,
+                                                               PeakTopology peakTopology = PeakTopology::Biquad) noexcept;
+
+/*
+    Mid/Side in one pass: each sample is encoded to mid = (L + R) / 2 and side = (L - R) / 2, mid goes
+    through the mid cascade and side through the side cascade, and L = mid + side, R = mid - side are
+    written back before the next sample is read. That's four adds and two multiplies a sample on top of
+    the two cascades, and no passes over the block of their own.
+
+    Both cascades run the same section counts, the larger of the two per cut. The one with fewer active
+    sections runs identity sections at the end, which cost a few multiplies but let one instantiation
+    cover both. Keep the memory of those identity sections at zero. The peak is always a biquad.
+*/
+template <typename SampleType>
+using MidSideProcessFunctionOf = void (*)(const CascadeCoefficients& mid, const CascadeCoefficients& side,
+                                          CascadeStateOf<SampleType>& midState, CascadeStateOf<SampleType>& sideState,
+                                          SampleType* left, SampleType* right, int numSamples) noexcept;
+
+using MidSideProcessFunction = MidSideProcessFunctionOf<float>;
+using PreciseMidSideProcessFunction = MidSideProcessFunctionOf<double>;
+
+MidSideProcessFunction getMidSideProcessFunction(int numLowCutSections, int numHighCutSections) noexcept;
+PreciseMidSideProcessFunction getPreciseMidSideProcessFunction(int numLowCutSections, int numHighCutSections) noexcept;
+
+// largest pole radius of one section, how fast its ringing dies away
+double getPoleRadius(const BiquadSection& section) noexcept;
+double getPoleRadius(const PreciseBiquadSection& section) noexcept;
+
+// how many samples the active sections keep ringing until they are decayDecibels below where they started
+int getTailLengthSamples(const CascadeCoefficients& coefficients, float decayDecibels, bool includeCuts = true) noexcept;
+
+// runs the same noise through both paths and returns the largest difference, for checking the SIMD path.
+// with a peakRamp of numSamples the state variable peak runs instead of the biquad one
+float measureSIMDDeviation(const CascadeCoefficients& coefficients, int numSamples, const SVFPeakCoefficients* peakRamp = nullptr);
@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+    ChainSettings.cpp
+    The parameter values one filter chain is designed from.
+
+  ==============================================================================
+*/
+
+#include "ChainSettings.h"
+
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState& apvts)
+    : lowCutFreq(apvts.getRawParameterValue("LowCut Freq")),
+      highCutFreq(apvts.getRawParameterValue("HighCut Freq")),
+      peakFreq(apvts.getRawParameterValue("Peak Freq")),
+      peakGainInDecibels(apvts.getRawParameterValue("Peak Gain")),
+      peakQuality(apvts.getRawParameterValue("Peak Quality")),
+      lowCutSlope(apvts.getRawParameterValue("LowCut Slope")),
+      highCutSlope(apvts.getRawParameterValue("HighCut Slope")),
+      coefficientMode(apvts.getRawParameterValue("Coefficient Mode")),
+      peakTopology(apvts.getRawParameterValue("Peak Topology")),
+      peakSmoothing(apvts.getRawParameterValue("Peak Smoothing")),
+      peakDynamics(apvts.getRawParameterValue("Peak Dynamics")),
+      peakThresholdInDecibels(apvts.getRawParameterValue("Peak Threshold")),
+      peakAttackMilliseconds(apvts.getRawParameterValue("Peak Attack")),
+      peakReleaseMilliseconds(apvts.getRawParameterValue("Peak Release")),
+      cutMode(apvts.getRawParameterValue("Cut Mode")),
+      cutFilterType(apvts.getRawParameterValue("Cut Filter Type")),
+      oversampling(apvts.getRawParameterValue("Oversampling")),
+      oversamplingFilter(apvts.getRawParameterValue("Oversampling Filter")),
+      precisionMode(apvts.getRawParameterValue("Precision")),
+      stereoMode(apvts.getRawParameterValue("Stereo Mode")),
+      sideLowCutFreq(apvts.getRawParameterValue("Side LowCut Freq")),
+      sideHighCutFreq(apvts.getRawParameterValue("Side HighCut Freq")),
+      sidePeakFreq(apvts.getRawParameterValue("Side Peak Freq")),
+      sidePeakGainInDecibels(apvts.getRawParameterValue("Side Peak Gain")),
+      sidePeakQuality(apvts.getRawParameterValue("Side Peak Quality")),
+      sideLowCutSlope(apvts.getRawParameterValue("Side LowCut Slope")),
+      sideHighCutSlope(apvts.getRawParameterValue("Side HighCut Slope"))
+{
+    jassert(lowCutFreq != nullptr && highCutFreq != nullptr && peakFreq != nullptr
+        && peakGainInDecibels != nullptr && peakQuality != nullptr
+        && lowCutSlope != nullptr && highCutSlope != nullptr
+        && coefficientMode != nullptr && peakTopology != nullptr
+        && peakSmoothing != nullptr && cutMode != nullptr
+        && peakDynamics != nullptr && peakThresholdInDecibels != nullptr
+        && peakAttackMilliseconds != nullptr && peakReleaseMilliseconds != nullptr
+        && cutFilterType != nullptr && oversampling != nullptr
+        && oversamplingFilter != nullptr && precisionMode != nullptr
+        && stereoMode != nullptr && sideLowCutFreq != nullptr && sideHighCutFreq != nullptr
+        && sidePeakFreq != nullptr && sidePeakGainInDecibels != nullptr && sidePeakQuality != nullptr
+        && sideLowCutSlope != nullptr && sideHighCutSlope != nullptr); // a parameter got renamed in createParameterLayout
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        auto& parameters = bands[static_cast<size_t>(band)];
+        parameters.type = apvts.getRawParameterValue(getBandParameterID(band, "Type"));
+        parameters.freq = apvts.getRawParameterValue(getBandParameterID(band, "Freq"));
+        parameters.gainInDecibels = apvts.getRawParameterValue(getBandParameterID(band, "Gain"));
+        parameters.quality = apvts.getRawParameterValue(getBandParameterID(band, "Q"));
+
+        jassert(parameters.type != nullptr && parameters.freq != nullptr
+            && parameters.gainInDecibels != nullptr && parameters.quality != nullptr);
+    }
+}
+
+juce::String getBandParameterID(int band, const juce::String& name)
+{
+    return "Band " + juce::String(band + 1) + " " + name;
+}
+
+// getting params, off the cached pointers so the audio thread can use it
+ChainSettings getChainSettings(const ChainParameters& parameters)
+{
+    ChainSettings settings;
+
+    settings.lowCutFreq = parameters.lowCutFreq->load();
+    settings.highCutFreq = parameters.highCutFreq->load();
+    settings.peakFreq = parameters.peakFreq->load();
+    settings.peakGainInDecibels = parameters.peakGainInDecibels->load();
+    settings.peakQuality = parameters.peakQuality->load();
+    settings.lowCutSlope = static_cast<Slope>(parameters.lowCutSlope->load());
+    settings.highCutSlope = static_cast<Slope>(parameters.highCutSlope->load());
+    settings.coefficientMode = static_cast<CoefficientMode>(parameters.coefficientMode->load());
+    settings.peakTopology = static_cast<PeakTopology>(parameters.peakTopology->load());
+    settings.peakSmoothing = static_cast<PeakSmoothing>(parameters.peakSmoothing->load());
+    settings.peakDynamics = static_cast<PeakDynamics>(parameters.peakDynamics->load());
+    settings.peakThresholdInDecibels = parameters.peakThresholdInDecibels->load();
+    settings.peakAttackMilliseconds = parameters.peakAttackMilliseconds->load();
+    settings.peakReleaseMilliseconds = parameters.peakReleaseMilliseconds->load();
+    settings.cutMode = static_cast<CutMode>(parameters.cutMode->load());
+    settings.cutFilterType = static_cast<CutFilterType>(parameters.cutFilterType->load());
+    settings.oversampling = static_cast<OversamplingFactor>(parameters.oversampling->load());
+    settings.oversamplingFilter = static_cast<OversamplingFilter>(parameters.oversamplingFilter->load());
+    settings.precisionMode = static_cast<PrecisionMode>(parameters.precisionMode->load());
+
+    for (size_t band = 0; band < settings.bands.size(); ++band)
+    {
+        auto& bandParameters = parameters.bands[band];
+        auto& bandSettings = settings.bands[band];
+        bandSettings.type = static_cast<BandType>(bandParameters.type->load());
+        bandSettings.freq = bandParameters.freq->load();
+        bandSettings.gainInDecibels = bandParameters.gainInDecibels->load();
+        bandSettings.quality = bandParameters.quality->load();
+    }
+
+    settings.stereoMode = static_cast<StereoMode>(parameters.stereoMode->load());
+    settings.sideLowCutFreq = parameters.sideLowCutFreq->load();
+    settings.sideHighCutFreq = parameters.sideHighCutFreq->load();
+    settings.sidePeakFreq = parameters.sidePeakFreq->load();
+    settings.sidePeakGainInDecibels = parameters.sidePeakGainInDecibels->load();
+    settings.sidePeakQuality = parameters.sidePeakQuality->load();
+    settings.sideLowCutSlope = static_cast<Slope>(parameters.sideLowCutSlope->load());
+    settings.sideHighCutSlope = static_cast<Slope>(parameters.sideHighCutSlope->load());
+
+    return settings;
+}
+
+bool lowCutChanged(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.lowCutFreq != b.lowCutFreq || a.lowCutSlope != b.lowCutSlope || a.cutFilterType != b.cutFilterType;
+}
+
+bool peakChanged(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.peakFreq != b.peakFreq
+        || a.peakGainInDecibels != b.peakGainInDecibels
+        || a.peakQuality != b.peakQuality;
+}
+
+bool highCutChanged(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.highCutFreq != b.highCutFreq || a.highCutSlope != b.highCutSlope || a.cutFilterType != b.cutFilterType;
+}
+
+bool oversamplingChanged(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.oversampling != b.oversampling || a.oversamplingFilter != b.oversamplingFilter;
+}
+
+bool bandsChanged(const ChainSettings& a, const ChainSettings& b)
+{
+    for (size_t band = 0; band < a.bands.size(); ++band)
+    {
+        auto& x = a.bands[band];
+        auto& y = b.bands[band];
+
+        if (x.type != y.type || x.freq != y.freq || x.gainInDecibels != y.gainInDecibels || x.quality != y.quality)
+            return true;
+    }
+
+    return false;
+}
+
+bool sideChanged(const ChainSettings& a, const ChainSettings& b)
+{
+    // nothing of the side's is designed in Left/Right mode, so only the switch itself counts there
+    if (a.stereoMode != b.stereoMode)
+        return true;
+
+    if (b.stereoMode != StereoMode::MidSide)
+        return false;
+
+    auto side = getSideSettings(a);
+    auto otherSide = getSideSettings(b);
+    return lowCutChanged(side, otherSide) || peakChanged(side, otherSide) || highCutChanged(side, otherSide);
+}
+
+ChainSettings getSideSettings(const ChainSettings& settings)
+{
+    auto side = settings;
+    side.lowCutFreq = settings.sideLowCutFreq;
+    side.highCutFreq = settings.sideHighCutFreq;
+    side.peakFreq = settings.sidePeakFreq;
+    side.peakGainInDecibels = settings.sidePeakGainInDecibels;
+    side.peakQuality = settings.sidePeakQuality;
+    side.lowCutSlope = settings.sideLowCutSlope;
+    side.highCutSlope = settings.sideHighCutSlope;
+    return side;
+}
+
+int getOversamplingFactor(OversamplingFactor oversampling) noexcept
+{
+    jassert(oversampling >= Oversampling_1x && oversampling <= Oversampling_4x);
+    return 1 << static_cast<int>(oversampling);
+}
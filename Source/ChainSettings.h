@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    ChainSettings.h
+    The parameter values one filter chain is designed from.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Defining and extracting our parameters from the tree states
+enum Slope 
+{
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48,
+    Slope_96
+};
+
+// exact designs every time, or table lookups while a parameter is moving
+enum CoefficientMode
+{
+    Exact,
+    Table
+};
+
+// how the Peak band is run: the designer's biquad, or a state variable filter the audio thread
+// retunes itself while "Peak Freq", "Peak Gain" and "Peak Quality" glide
+enum PeakTopology
+{
+    Biquad,
+    StateVariable
+};
+
+// how often the state variable peak gets new coefficients while it glides
+enum PeakSmoothing
+{
+    ControlRate,
+    AudioRate
+};
+
+// a fixed "Peak Gain", or one the Peak only goes towards while its band is over "Peak Threshold". the
+// dynamic peak runs as the state variable filter whatever "Peak Topology" says
+enum PeakDynamics
+{
+    StaticPeak,
+    DynamicPeak
+};
+
+// the LowCut and HighCut as IIR sections, or as one linear phase brickwall FIR (the "straight line" cut)
+enum CutMode
+{
+    IIR,
+    LinearPhase
+};
+
+// the design behind the IIR LowCut and HighCut. past Butterworth each type trades some flatness
+// for a steeper knee, so it gets to the slope's attenuation with fewer sections
+enum CutFilterType
+{
+    Butterworth,
+    ChebyshevI,
+    ChebyshevII,
+    Elliptic
+};
+
+// runs the whole chain at 2x or 4x the host rate, so the Peak and HighCut near nyquist keep their analog shape
+enum OversamplingFactor
+{
+    Oversampling_1x,
+    Oversampling_2x,
+    Oversampling_4x
+};
+
+// the half band filters of the oversampler: polyphase IIR allpasses (minimum phase, a few samples of latency)
+// or equiripple FIRs (linear phase, more latency)
+enum OversamplingFilter
+{
+    PolyphaseIIR,
+    EquirippleFIR
+};
+
+// plain float everywhere, or double coefficients and memory for the float path's sections that sit close
+// enough to the unit circle to need them (low cutoffs at high sample rates)
+enum PrecisionMode
+{
+    SinglePrecision,
+    MixedPrecision
+};
+
+// left and right through the same chain, or mid and side each through their own (a stereo bus in IIR cut mode only)
+enum StereoMode
+{
+    LeftRight,
+    MidSide
+};
+
+// what one of the parametric bands does. the cuts are 12 dB/oct, one biquad like every other band
+enum BandType
+{
+    BandOff,
+    BandPeak,
+    BandLowShelf,
+    BandHighShelf,
+    BandNotch,
+    BandLowCut,
+    BandHighCut
+};
+
+// the parametric bands after LowCut -> Peak -> HighCut. the parameters, the designer and the band storage
+// are all sized from this, so more bands is this number and nothing else (up to 32, the active mask is 32 bits)
+constexpr int maxBands = 16;
+
+struct BandSettings
+{
+    BandType type{ BandType::BandOff };
+    float freq{ 1000.f }, gainInDecibels{ 0.f }, quality{ 1.f };
+};
+
+struct ChainSettings 
+{
+    float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
+    float lowCutFreq{ 0 }, highCutFreq{ 0 };
+    Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
+    CoefficientMode coefficientMode{ CoefficientMode::Exact };
+    PeakTopology peakTopology{ PeakTopology::Biquad };
+    PeakSmoothing peakSmoothing{ PeakSmoothing::ControlRate };
+    PeakDynamics peakDynamics{ PeakDynamics::StaticPeak };
+    float peakThresholdInDecibels{ 0 }, peakAttackMilliseconds{ 0 }, peakReleaseMilliseconds{ 0 };
+    CutMode cutMode{ CutMode::IIR };
+    CutFilterType cutFilterType{ CutFilterType::Butterworth };
+    OversamplingFactor oversampling{ OversamplingFactor::Oversampling_1x };
+    OversamplingFilter oversamplingFilter{ OversamplingFilter::PolyphaseIIR };
+    PrecisionMode precisionMode{ PrecisionMode::MixedPrecision };
+    std::array<BandSettings, maxBands> bands{};
+
+    // in Mid/Side mode the settings above are the mid's, the side has its own cuts and peak
+    StereoMode stereoMode{ StereoMode::LeftRight };
+    float sidePeakFreq{ 0 }, sidePeakGainInDecibels{ 0 }, sidePeakQuality{ 1.f };
+    float sideLowCutFreq{ 0 }, sideHighCutFreq{ 0 };
+    Slope sideLowCutSlope{ Slope::Slope_12 }, sideHighCutSlope{ Slope::Slope_12 };
+};
+
+// the raw parameter atomics, looked up once so the audio thread never searches the tree by string
+struct ChainParameters
+{
+    explicit ChainParameters(juce::AudioProcessorValueTreeState& apvts);
+
+    std::atomic<float>* lowCutFreq{ nullptr };
+    std::atomic<float>* highCutFreq{ nullptr };
+    std::atomic<float>* peakFreq{ nullptr };
+    std::atomic<float>* peakGainInDecibels{ nullptr };
+    std::atomic<float>* peakQuality{ nullptr };
+    std::atomic<float>* lowCutSlope{ nullptr };
+    std::atomic<float>* highCutSlope{ nullptr };
+    std::atomic<float>* coefficientMode{ nullptr };
+    std::atomic<float>* peakTopology{ nullptr };
+    std::atomic<float>* peakSmoothing{ nullptr };
+    std::atomic<float>* peakDynamics{ nullptr };
+    std::atomic<float>* peakThresholdInDecibels{ nullptr };
+    std::atomic<float>* peakAttackMilliseconds{ nullptr };
+    std::atomic<float>* peakReleaseMilliseconds{ nullptr };
+    std::atomic<float>* cutMode{ nullptr };
+    std::atomic<float>* cutFilterType{ nullptr };
+    std::atomic<float>* oversampling{ nullptr };
+    std::atomic<float>* oversamplingFilter{ nullptr };
+    std::atomic<float>* precisionMode{ nullptr };
+
+    struct BandParameters
+    {
+        std::atomic<float>* type{ nullptr };
+        std::atomic<float>* freq{ nullptr };
+        std::atomic<float>* gainInDecibels{ nullptr };
+        std::atomic<float>* quality{ nullptr };
+    };
+
+    std::array<BandParameters, maxBands> bands{};
+
+    std::atomic<float>* stereoMode{ nullptr };
+    std::atomic<float>* sideLowCutFreq{ nullptr };
+    std::atomic<float>* sideHighCutFreq{ nullptr };
+    std::atomic<float>* sidePeakFreq{ nullptr };
+    std::atomic<float>* sidePeakGainInDecibels{ nullptr };
+    std::atomic<float>* sidePeakQuality{ nullptr };
+    std::atomic<float>* sideLowCutSlope{ nullptr };
+    std::atomic<float>* sideHighCutSlope{ nullptr };
+};
+
+// "Band 1 Freq" and so on, band counts from 0 here and from 1 in the id
+juce::String getBandParameterID(int band, const juce::String& name);
+
+// help func to give us our parameters values
+ChainSettings getChainSettings(const ChainParameters& parameters);
+
+// per stage change checks, so only the stage that moved gets redesigned
+bool lowCutChanged(const ChainSettings& a, const ChainSettings& b);
+bool peakChanged(const ChainSettings& a, const ChainSettings& b);
+bool highCutChanged(const ChainSettings& a, const ChainSettings& b);
+bool oversamplingChanged(const ChainSettings& a, const ChainSettings& b);
+bool bandsChanged(const ChainSettings& a, const ChainSettings& b);
+bool sideChanged(const ChainSettings& a, const ChainSettings& b);
+
+// the side's cuts and peak moved into the main fields, so the side is designed by the same code as the mid
+ChainSettings getSideSettings(const ChainSettings& settings);
+
+// 1, 2 or 4
+int getOversamplingFactor(OversamplingFactor oversampling) noexcept;
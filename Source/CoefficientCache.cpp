@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+    Process-wide cache of designed stages, shared by every plugin instance.
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+
+bool StageKey::operator==(const StageKey& other) const noexcept
+{
+    return type == other.type
+        && frequency == other.frequency
+        && quality == other.quality
+        && gainInDecibels == other.gainInDecibels
+        && order == other.order
+        && filterType == other.filterType
+        && sampleRate == other.sampleRate;
+}
+
+size_t StageKeyHash::operator()(const StageKey& key) const noexcept
+{
+    auto hash = std::hash<int>()(static_cast<int>(key.type));
+
+    auto combine = [&hash](size_t value)
+    {
+        hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+
+    combine(std::hash<float>()(key.frequency));
+    combine(std::hash<float>()(key.quality));
+    combine(std::hash<float>()(key.gainInDecibels));
+    combine(std::hash<int>()(key.order));
+    combine(std::hash<int>()(static_cast<int>(key.filterType)));
+    combine(std::hash<double>()(key.sampleRate));
+
+    return hash;
+}
+
+//==============================================================================
+CoefficientCache::StagePtr CoefficientCache::find(const StageKey& key)
+{
+    const juce::ScopedLock sl(lock);
+
+    auto found = lookup.find(key);
+
+    if (found == lookup.end())
+    {
+        ++misses;
+        return nullptr;
+    }
+
+    // move it to the front, it's the most recently used now
+    entries.splice(entries.begin(), entries, found->second);
+    ++hits;
+
+    return found->second->coefficients;
+}
+
+CoefficientCache::StagePtr CoefficientCache::insert(const StageKey& key, StagePtr designed)
+{
+    const juce::ScopedLock sl(lock);
+
+    // someone else designed the same thing while we were, keep theirs so the instances share it
+    auto found = lookup.find(key);
+
+    if (found != lookup.end())
+    {
+        entries.splice(entries.begin(), entries, found->second);
+        return found->second->coefficients;
+    }
+
+    entries.push_front({ key, designed });
+    lookup[key] = entries.begin();
+
+    while (static_cast<int>(entries.size()) > maxEntries)
+    {
+        lookup.erase(entries.back().key);
+        entries.pop_back();
+        ++evictions;
+    }
+
+    numEntries = static_cast<int>(entries.size());
+    return designed;
+}
+
+CoefficientCache::Statistics CoefficientCache::getStatistics() const noexcept
+{
+    Statistics statistics;
+
+    statistics.hits = hits.load();
+    statistics.misses = misses.load();
+    statistics.evictions = evictions.load();
+    statistics.numEntries = numEntries.load();
+
+    return statistics;
+}
+
+void CoefficientCache::clear()
+{
+    const juce::ScopedLock sl(lock);
+
+    lookup.clear();
+    entries.clear();
+    numEntries = 0;
+}
@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+    Process-wide cache of designed stages, shared by every plugin instance.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+
+// one biquad as b0, b1, b2, a0, a1, a2 -> lives on the stack, so designing it never touches the heap.
+// designed in double, the kernel rounds to float only for the sections that can take it
+using BiquadCoefficients = std::array<double, 6>;
+
+// the sections of one stage of the chain, a cut uses up to all 8, the peak only uses the first
+using CutCoefficients = std::array<BiquadCoefficients, 8>;
+
+enum class StageType
+{
+    LowCut,
+    Peak,
+    HighCut
+};
+
+// everything a stage's design depends on, unused fields are left at 0 so they still compare equal
+struct StageKey
+{
+    StageType type{ StageType::Peak };
+    float frequency{ 0 }, quality{ 0 }, gainInDecibels{ 0 };
+    int order{ 0 };
+    CutFilterType filterType{ CutFilterType::Butterworth };
+    double sampleRate{ 0.0 };
+
+    bool operator==(const StageKey& other) const noexcept;
+};
+
+struct StageKeyHash
+{
+    size_t operator()(const StageKey& key) const noexcept;
+};
+
+//==============================================================================
+/**
+    Hands out shared, read-only designs so a session full of instances with the
+    same cut settings only runs each design once.
+
+    Held through a SharedResourcePointer, so there is one per process. Memory is
+    bounded by maxEntries, the least recently used design is dropped first, and
+    anything still referenced by an instance stays alive until that instance lets
+    go of it. Never call this from the audio thread, it takes a lock.
+*/
+class CoefficientCache
+{
+public:
+    using StagePtr = std::shared_ptr<const CutCoefficients>;
+
+    struct Statistics
+    {
+        juce::uint64 hits{ 0 }, misses{ 0 }, evictions{ 0 };
+        int numEntries{ 0 };
+    };
+
+    static constexpr int maxEntries = 512;
+
+    // returns the cached design for key, or runs design() and caches what it returns
+    template <typename DesignFunction>
+    StagePtr getOrDesign(const StageKey& key, DesignFunction&& design)
+    {
+        if (auto cached = find(key))
+            return cached;
+
+        // designed outside the lock, two threads racing on the same key just both design it
+        auto designed = std::make_shared<const CutCoefficients>(design());
+        return insert(key, std::move(designed));
+    }
+
+    Statistics getStatistics() const noexcept;
+    void clear();
+
+private:
+    StagePtr find(const StageKey& key);
+    StagePtr insert(const StageKey& key, StagePtr designed);
+
+    struct Entry
+    {
+        StageKey key;
+        StagePtr coefficients;
+    };
+
+    // front is the most recently used
+    std::list<Entry> entries;
+    std::unordered_map<StageKey, std::list<Entry>::iterator, StageKeyHash> lookup;
+    juce::CriticalSection lock;
+
+    std::atomic<juce::uint64> hits{ 0 }, misses{ 0 }, evictions{ 0 };
+    std::atomic<int> numEntries{ 0 };
+};
@@ -0,0 +1,368 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.cpp
+    Designs the chain's coefficients off the audio thread and hands them over
+    as complete, immutable sets.
+
+  ==============================================================================
+*/
+
+#include "CoefficientDesigner.h"
+
+int getOrderForSlope(Slope slope)
+{
+    switch (slope)
+    {
+    case Slope_12: return 2;
+    case Slope_24: return 4;
+    case Slope_36: return 6;
+    case Slope_48: return 8;
+    case Slope_96: return 16;
+    }
+    jassertfalse; // unexpected slope
+    return 2;
+}
+
+CutCoefficients makeCutCoefficients(float frequency, double sampleRate, int order, bool isHighpass)
+{
+    // FilterDesign hands back a ReferenceCountedArray of heap coefficients, so we do the same maths ourselves:
+    // every 2 orders is one butterworth biquad with its own Q, the rest of the array is left unused
+    jassert(order % 2 == 0 && order / 2 <= 8);
+
+    CutCoefficients coefficients{};
+
+    for (int i = 0; i < order / 2; ++i)
+    {
+        auto quality = 1.0 / (2.0 * std::cos((2.0 * i + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+
+        coefficients[static_cast<size_t>(i)] = isHighpass
+            ? juce::dsp::IIR::ArrayCoefficients<double>::makeHighPass(sampleRate, frequency, quality)
+            : juce::dsp::IIR::ArrayCoefficients<double>::makeLowPass(sampleRate, frequency, quality);
+    }
+
+    return coefficients;
+}
+
+BiquadCoefficients makePeakCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::IIR::ArrayCoefficients<double>::makePeakFilter(
+        sampleRate,
+        chainSettings.peakFreq,
+        chainSettings.peakQuality,
+        juce::Decibels::decibelsToGain(static_cast<double>(chainSettings.peakGainInDecibels)));
+}
+
+//==============================================================================
+CoefficientDesigner::CoefficientDesigner(const ChainParameters& params)
+    : parameters(params)
+{
+}
+
+CoefficientDesigner::~CoefficientDesigner()
+{
+    release();
+    deleteEverythingPending();
+    delete active;
+}
+
+void CoefficientDesigner::prepare(double newSampleRate)
+{
+    // the audio thread isn't running while we're in here, so we're free to touch everything
+    release();
+    deleteEverythingPending();
+
+    sampleRate = newSampleRate;
+    tables.prepare(sampleRate);
+    linearPhaseDesigner.prepare(sampleRate);
+
+    auto first = design(getChainSettings(parameters), allStages, false);
+    approximatedStages = 0;
+    lastPublished = *first;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(publishedLock);
+        published = { first->sampleRate, first->settings, first->cascade, first->bands };
+        ++publishedSerial;
+    }
+
+    delete active;
+    active = first.release();
+
+    designThread->addTimeSliceClient(this);
+    isWatching = true;
+}
+
+void CoefficientDesigner::release()
+{
+    // blocks until useTimeSlice() has returned if it happens to be running
+    if (isWatching)
+        designThread->removeTimeSliceClient(this);
+
+    isWatching = false;
+}
+
+const ChainCoefficients* CoefficientDesigner::acquireLatest() noexcept
+{
+    // if the designer is behind on cleaning up, keep the current set for another block instead of leaking it
+    if (retiredFifo.getFreeSpace() == 0)
+        return nullptr;
+
+    auto* latest = pending.exchange(nullptr, std::memory_order_acq_rel);
+
+    if (latest == nullptr)
+        return nullptr;
+
+    {
+        const auto scope = retiredFifo.write(1);
+        retired[static_cast<size_t>(scope.startIndex1)] = active;
+    }
+
+    active = latest;
+    return latest;
+}
+
+bool CoefficientDesigner::getPublished(PublishedCascade& destination, juce::uint32& lastSerial) const
+{
+    const juce::SpinLock::ScopedLockType lock(publishedLock);
+
+    if (publishedSerial == lastSerial)
+        return false;
+
+    destination = published;
+    lastSerial = publishedSerial;
+    return true;
+}
+
+int CoefficientDesigner::useTimeSlice()
+{
+    reclaimRetired();
+
+    // half a state is no state at all, come back once the batch is done
+    const juce::ScopedTryLock batch(batchLock);
+
+    if (! batch.isLocked())
+        return activeIntervalMs;
+
+    auto chainSettings = getChainSettings(parameters);
+    auto changedStages = getChangedStages(chainSettings, lastPublished.settings);
+
+    if (changedStages == 0)
+    {
+        if (approximatedStages == 0)
+            return idleIntervalMs;
+
+        // the knob has stopped, swap the table approximations for the exact designs
+        auto coefficients = design(chainSettings, approximatedStages, false);
+        approximatedStages = 0;
+
+        lastPublished = *coefficients;
+        publish(std::move(coefficients));
+        return activeIntervalMs;
+    }
+
+    auto fromTables = chainSettings.coefficientMode == CoefficientMode::Table;
+
+    auto coefficients = design(chainSettings, changedStages, fromTables);
+    approximatedStages = fromTables ? (approximatedStages | (changedStages & tableStages)) : (approximatedStages & ~changedStages);
+
+    lastPublished = *coefficients;
+    publish(std::move(coefficients));
+
+    // something is moving, look again soon so a sweep follows the knob closely
+    return activeIntervalMs;
+}
+
+int CoefficientDesigner::getChangedStages(const ChainSettings& a, const ChainSettings& b)
+{
+    // the IIR stages, the side's and the bands are designed at the oversampled rate, so they all follow the oversampling
+    return (lowCutChanged(a, b) ? lowCutStage : 0)
+         | (peakChanged(a, b) ? peakStage : 0)
+         | (highCutChanged(a, b) ? highCutStage : 0)
+         | (a.cutMode != b.cutMode || a.lowCutFreq != b.lowCutFreq || a.highCutFreq != b.highCutFreq ? linearPhaseStage : 0)
+         | (bandsChanged(a, b) ? bandStage : 0)
+         | (sideChanged(a, b) || a.cutMode != b.cutMode ? sideStage : 0)
+         | (oversamplingChanged(a, b) ? tableStages | bandStage | sideStage : 0)
+         | (a.precisionMode != b.precisionMode || a.peakTopology != b.peakTopology || a.peakDynamics != b.peakDynamics ? peakStage : 0);
+}
+
+std::unique_ptr<ChainCoefficients> CoefficientDesigner::design(const ChainSettings& chainSettings, int stages, bool fromTables) const
+{
+    // start from what's already out there and only redesign the stages asked for
+    auto coefficients = std::make_unique<ChainCoefficients>(lastPublished);
+
+    auto oversamplingFactor = getOversamplingFactor(chainSettings.oversampling);
+    auto designRate = sampleRate * oversamplingFactor;
+
+    // a new rate invalidates every stage designed for it, and the tables only ever cover the host rate
+    if (lastPublished.sampleRate != designRate)
+        stages |= tableStages | bandStage | sideStage;
+
+    fromTables = fromTables && tables.isPreparedFor(designRate) && tables.isAccurate();
+
+    if ((stages & lowCutStage) != 0)
+    {
+        coefficients->lowCut = designLowCut(chainSettings, fromTables, designRate);
+        ++coefficients->stageDesigns[static_cast<size_t>(StageType::LowCut)];
+    }
+
+    if ((stages & peakStage) != 0)
+    {
+        coefficients->peak = designPeak(chainSettings, fromTables, designRate);
+        ++coefficients->stageDesigns[static_cast<size_t>(StageType::Peak)];
+    }
+
+    if ((stages & highCutStage) != 0)
+    {
+        coefficients->highCut = designHighCut(chainSettings, fromTables, designRate);
+        ++coefficients->stageDesigns[static_cast<size_t>(StageType::HighCut)];
+    }
+
+    if ((stages & bandStage) != 0)
+        coefficients->bands = makeBandCoefficients(chainSettings.bands, designRate);
+
+    // the side runs in the same kernel as the mid's cuts, there's none with the cuts in the linear phase convolver
+    auto isMidSide = chainSettings.stereoMode == StereoMode::MidSide && chainSettings.cutMode == CutMode::IIR;
+
+    // the side is never approximated, it's the same cached designs as the mid's and rarely swept.
+    // all three are asked for every time, the ones that didn't change come straight out of the cache
+    if ((stages & sideStage) != 0)
+    {
+        auto sideSettings = getSideSettings(chainSettings);
+        coefficients->sideLowCut = isMidSide ? designLowCut(sideSettings, false, designRate) : nullptr;
+        coefficients->sidePeak = isMidSide ? designPeak(sideSettings, false, designRate) : nullptr;
+        coefficients->sideHighCut = isMidSide ? designHighCut(sideSettings, false, designRate) : nullptr;
+    }
+
+    if ((stages & linearPhaseStage) != 0)
+    {
+        // a set keeps the filter it replaced for as long as its own filter is current, so whichever set the
+        // audio thread picks up it can fade from there
+        coefficients->previousLinearPhase = lastPublished.linearPhase;
+        coefficients->linearPhase = chainSettings.cutMode == CutMode::LinearPhase
+                                  ? linearPhaseDesigner.design(chainSettings.lowCutFreq, chainSettings.highCutFreq)
+                                  : nullptr;
+    }
+
+    coefficients->sampleRate = designRate;
+    coefficients->oversamplingFactor = oversamplingFactor;
+    coefficients->settings = chainSettings;
+    coefficients->cascade = makeCascadeCoefficients(*coefficients->lowCut, getNumCutSections(chainSettings.cutFilterType, chainSettings.lowCutSlope),
+                                                    *coefficients->peak,
+                                                    *coefficients->highCut, getNumCutSections(chainSettings.cutFilterType, chainSettings.highCutSlope));
+    coefficients->sideCascade = isMidSide ? makeCascadeCoefficients(*coefficients->sideLowCut, getNumCutSections(chainSettings.cutFilterType, chainSettings.sideLowCutSlope),
+                                                                    *coefficients->sidePeak,
+                                                                    *coefficients->sideHighCut, getNumCutSections(chainSettings.cutFilterType, chainSettings.sideHighCutSlope))
+                                          : CascadeCoefficients{};
+    auto isLinearPhase = chainSettings.cutMode == CutMode::LinearPhase;
+
+    // only the sections the kernel really runs as biquads get a say in the precision. the Mid/Side kernel
+    // always runs both peaks as biquads, the dynamic peak is always the state variable filter otherwise
+    auto isPeakBiquad = isMidSide || (chainSettings.peakTopology == PeakTopology::Biquad && chainSettings.peakDynamics == PeakDynamics::StaticPeak);
+
+    if (chainSettings.precisionMode == PrecisionMode::MixedPrecision)
+    {
+        coefficients->cascade.precision = getSectionPrecision(coefficients->cascade, ! isLinearPhase, isPeakBiquad);
+
+        if (isMidSide)
+            coefficients->sideCascade.precision = getSectionPrecision(coefficients->sideCascade, true, true);
+    }
+
+    // the cascade rings at the oversampled rate, the FIR runs at the host rate. mid and side ring side by side
+    auto cascadeTail = juce::jmax(getTailLengthSamples(coefficients->cascade, tailDecayDecibels, ! isLinearPhase),
+                                  isMidSide ? getTailLengthSamples(coefficients->sideCascade, tailDecayDecibels, true) : 0)
+                     + getTailLengthSamples(coefficients->bands, tailDecayDecibels);
+    coefficients->tailSamples = cascadeTail / oversamplingFactor + (cascadeTail % oversamplingFactor != 0 ? 1 : 0);
+
+    if (isLinearPhase)
+        coefficients->tailSamples += getLinearPhaseFirLength(sampleRate) + linearPhasePartitionSize;
+
+    return coefficients;
+}
+
+CoefficientCache::StagePtr CoefficientDesigner::designLowCut(const ChainSettings& chainSettings, bool fromTables, double designRate) const
+{
+    // sweeps would only churn the cache, so table designs never go into it. the tables only know Butterworth
+    if (fromTables && chainSettings.cutFilterType == CutFilterType::Butterworth)
+        return std::make_shared<const CutCoefficients>(tables.makeCut(chainSettings.lowCutFreq, chainSettings.lowCutSlope, true));
+
+    return designCut(StageType::LowCut, chainSettings.lowCutFreq, chainSettings.lowCutSlope, chainSettings.cutFilterType, designRate);
+}
+
+CoefficientCache::StagePtr CoefficientDesigner::designPeak(const ChainSettings& chainSettings, bool fromTables, double designRate) const
+{
+    if (fromTables)
+        return std::make_shared<const CutCoefficients>(tables.makePeak(chainSettings));
+
+    StageKey key;
+    key.type = StageType::Peak;
+    key.frequency = chainSettings.peakFreq;
+    key.quality = chainSettings.peakQuality;
+    key.gainInDecibels = chainSettings.peakGainInDecibels;
+    key.sampleRate = designRate;
+
+    return cache->getOrDesign(key, [&chainSettings, designRate]
+    {
+        CutCoefficients peak{};
+        peak[0] = makePeakCoefficients(chainSettings, designRate);
+        return peak;
+    });
+}
+
+CoefficientCache::StagePtr CoefficientDesigner::designHighCut(const ChainSettings& chainSettings, bool fromTables, double designRate) const
+{
+    if (fromTables && chainSettings.cutFilterType == CutFilterType::Butterworth)
+        return std::make_shared<const CutCoefficients>(tables.makeCut(chainSettings.highCutFreq, chainSettings.highCutSlope, false));
+
+    return designCut(StageType::HighCut, chainSettings.highCutFreq, chainSettings.highCutSlope, chainSettings.cutFilterType, designRate);
+}
+
+CoefficientCache::StagePtr CoefficientDesigner::designCut(StageType type, float frequency, Slope slope, CutFilterType filterType, double designRate) const
+{
+    // the slope's Butterworth order stands in for the slope itself, the other types work their own order out from it
+    StageKey key;
+    key.type = type;
+    key.frequency = frequency;
+    key.order = getOrderForSlope(slope);
+    key.filterType = filterType;
+    key.sampleRate = designRate;
+
+    return cache->getOrDesign(key, [&key, slope]
+    {
+        auto isHighpass = key.type == StageType::LowCut;
+
+        return key.filterType == CutFilterType::Butterworth
+            ? makeCutCoefficients(key.frequency, key.sampleRate, key.order, isHighpass)
+            : makeCutFilterCoefficients(key.filterType, key.frequency, key.sampleRate, slope, isHighpass);
+    });
+}
+
+void CoefficientDesigner::publish(std::unique_ptr<ChainCoefficients> coefficients)
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(publishedLock);
+        published = { coefficients->sampleRate, coefficients->settings, coefficients->cascade, coefficients->bands };
+        ++publishedSerial;
+    }
+
+    // anything still sitting in pending was never seen by the audio thread, so it's ours to delete
+    std::unique_ptr<ChainCoefficients> unused(pending.exchange(coefficients.release(), std::memory_order_acq_rel));
+}
+
+void CoefficientDesigner::reclaimRetired()
+{
+    const auto scope = retiredFifo.read(retiredFifo.getNumReady());
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        delete retired[static_cast<size_t>(scope.startIndex1 + i)];
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        delete retired[static_cast<size_t>(scope.startIndex2 + i)];
+}
+
+void CoefficientDesigner::deleteEverythingPending()
+{
+    delete pending.exchange(nullptr);
+    reclaimRetired();
+    retiredFifo.reset();
+}
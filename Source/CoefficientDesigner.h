@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.h
+    Designs the chain's coefficients off the audio thread and hands them over
+    as complete, immutable sets.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "CoefficientCache.h"
+#include "CoefficientTables.h"
+#include "CascadeKernel.h"
+#include "LinearPhaseCut.h"
+#include "CutFilterDesigns.h"
+#include "ParametricBands.h"
+
+// custom helper for the switch statements, 2 orders per biquad section
+int getOrderForSlope(Slope slope);
+
+// same section layout FilterDesign's butterworth methods give us, minus the allocations
+CutCoefficients makeCutCoefficients(float frequency, double sampleRate, int order, bool isHighpass);
+BiquadCoefficients makePeakCoefficients(const ChainSettings& chainSettings, double sampleRate);
+
+// everything one MonoChain needs for LowCut, Peak and HighCut, never modified once published.
+// the stages themselves come out of the CoefficientCache, so instances with the same settings share them
+struct ChainCoefficients
+{
+    // the rate the stages are designed for, the host rate times oversamplingFactor
+    double sampleRate{ 0.0 };
+    int oversamplingFactor{ 1 };
+    ChainSettings settings;
+
+    CoefficientCache::StagePtr lowCut, peak, highCut;
+
+    // the same stages normalised and laid out for the kernel
+    CascadeCoefficients cascade;
+
+    // the parametric bands that do something, designed exactly every time, they're one biquad each
+    BandCoefficients bands;
+
+    // the side's own cuts and peak in Mid/Side mode, always exact. empty in Left/Right mode
+    CoefficientCache::StagePtr sideLowCut, sidePeak, sideHighCut;
+    CascadeCoefficients sideCascade;
+
+    // the brickwall FIR while "Cut Mode" is Linear Phase, and the one it replaced so the convolver can crossfade
+    std::shared_ptr<const LinearPhaseFilter> linearPhase, previousLinearPhase;
+
+    // how long the cascade rings on after its input stops in samples at the host rate, see tailDecayDecibels
+    int tailSamples{ 0 };
+
+    // how many times each stage has been designed since the designer was made, indexed by StageType.
+    // running totals, so the audio thread still gets the right counts when it skips a set
+    std::array<juce::uint64, 3> stageDesigns{};
+};
+
+// the tail ends once the ringing is this far below where it started, which is under the float noise floor
+constexpr float tailDecayDecibels = 120.0f;
+
+// the part of a published set the editor draws the response from
+struct PublishedCascade
+{
+    double sampleRate{ 0.0 };
+    ChainSettings settings;
+    CascadeCoefficients cascade;
+    BandCoefficients bands;
+};
+
+//==============================================================================
+/**
+    Watches the parameters from a shared background thread and, whenever one of
+    them moves, designs a fresh ChainCoefficients for all three stages.
+
+    The audio thread picks the newest set up with a single atomic exchange at the
+    start of the block, and hands the one it replaced back through a fifo so it is
+    deleted here rather than in the audio callback. How fast a knob moves only
+    changes how often sets get published, never how long a block takes.
+*/
+class CoefficientDesigner : private juce::TimeSliceClient
+{
+public:
+    explicit CoefficientDesigner(const ChainParameters& parameters);
+    ~CoefficientDesigner() override;
+
+    // not on the audio thread, designs the first set synchronously and starts watching
+    void prepare(double sampleRate);
+    void release();
+
+    // the set the audio thread is currently using, valid until the next acquireLatest() call
+    const ChainCoefficients& getActive() const noexcept { return *active; }
+
+    // audio thread, wait-free: the newest set if one got published since the last call, otherwise nullptr
+    const ChainCoefficients* acquireLatest() noexcept;
+
+    // not the audio thread: copies the newest set published if there was one since lastSerial.
+    // the audio thread picks the same set up at the start of its next block
+    bool getPublished(PublishedCascade& destination, juce::uint32& lastSerial) const;
+
+    // holds the designer off while several parameters change together (a whole state being restored), so
+    // it designs once for all of them rather than once for whichever ones it happened to see first
+    class ScopedParameterBatch
+    {
+    public:
+        explicit ScopedParameterBatch(CoefficientDesigner& designer) : lock(designer.batchLock) {}
+
+    private:
+        const juce::ScopedLock lock;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedParameterBatch)
+    };
+
+    // how far the Table coefficient mode strays from the exact designs at the prepared sample rate
+    CoefficientTables::Accuracy getTableAccuracy() const noexcept { return tables.getAccuracy(); }
+
+private:
+    int useTimeSlice() override;
+
+    enum Stages
+    {
+        lowCutStage = 1,
+        peakStage = 2,
+        highCutStage = 4,
+        linearPhaseStage = 8,
+        bandStage = 16,
+        sideStage = 32,
+        allStages = lowCutStage | peakStage | highCutStage | linearPhaseStage | bandStage | sideStage,
+
+        // the ones the tables can approximate, the FIR is always designed exactly
+        tableStages = lowCutStage | peakStage | highCutStage
+    };
+
+    static int getChangedStages(const ChainSettings& a, const ChainSettings& b);
+
+    std::unique_ptr<ChainCoefficients> design(const ChainSettings& chainSettings, int stages, bool fromTables) const;
+    void publish(std::unique_ptr<ChainCoefficients> coefficients);
+    void reclaimRetired();
+    void deleteEverythingPending();
+
+    // designRate is the host rate times the oversampling factor
+    CoefficientCache::StagePtr designLowCut(const ChainSettings& chainSettings, bool fromTables, double designRate) const;
+    CoefficientCache::StagePtr designPeak(const ChainSettings& chainSettings, bool fromTables, double designRate) const;
+    CoefficientCache::StagePtr designHighCut(const ChainSettings& chainSettings, bool fromTables, double designRate) const;
+    CoefficientCache::StagePtr designCut(StageType type, float frequency, Slope slope, CutFilterType filterType, double designRate) const;
+
+    // one thread for every instance in the process, rather than a thread each
+    struct SharedDesignThread : public juce::TimeSliceThread
+    {
+        SharedDesignThread() : juce::TimeSliceThread("CustomEQ Coefficient Designer") { startThread(); }
+        ~SharedDesignThread() override { stopThread(2000); }
+    };
+
+    // how long the thread waits before looking at the parameters again
+    static constexpr int activeIntervalMs = 1;
+    static constexpr int idleIntervalMs = 5;
+
+    const ChainParameters& parameters;
+    double sampleRate{ 0.0 };
+
+    juce::SharedResourcePointer<CoefficientCache> cache;
+    CoefficientTables tables;
+    LinearPhaseDesigner linearPhaseDesigner;
+
+    // stages whose published design came from the tables and still needs the exact one
+    int approximatedStages{ 0 };
+
+    // designer side copy of the last set published, so unchanged stages are copied rather than redesigned
+    ChainCoefficients lastPublished;
+
+    // a copy of what got published for the editor, the pending set itself belongs to the audio thread once it's out
+    PublishedCascade published;
+    juce::uint32 publishedSerial{ 0 };
+    mutable juce::SpinLock publishedLock;
+
+    // held by a ScopedParameterBatch, the designer thread only ever tries it
+    juce::CriticalSection batchLock;
+
+    std::atomic<ChainCoefficients*> pending{ nullptr };
+    ChainCoefficients* active{ nullptr };
+
+    // sets the audio thread swapped out, waiting to be deleted on the designer thread
+    static constexpr int retiredCapacity = 32;
+    juce::AbstractFifo retiredFifo{ retiredCapacity };
+    std::array<ChainCoefficients*, retiredCapacity> retired{};
+
+    juce::SharedResourcePointer<SharedDesignThread> designThread;
+    bool isWatching{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientDesigner)
+};
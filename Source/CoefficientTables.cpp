@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+    CoefficientTables.cpp
+    Table driven approximations of the chain's designs, for when the
+    parameters are being swept.
+
+  ==============================================================================
+*/
+
+#include "CoefficientTables.h"
+#include "CoefficientDesigner.h"
+
+namespace
+{
+    // bilinear transform of 1 / (s^2 + ks + 1) and s^2 / (s^2 + ks + 1), prewarped so g = tan(pi * f / fs).
+    // all in double: at a low cutoff g^2 is tiny and a1 = 2 (g^2 - 1) is right next to -(a0 + a2), in float
+    // that cancellation is worth several dB on a steep slope
+    BiquadCoefficients makeCutSection(double g, double k, bool isHighpass) noexcept
+    {
+        auto gg = g * g;
+        auto a0 = 1.0 + k * g + gg;
+        auto a1 = 2.0 * (gg - 1.0);
+        auto a2 = 1.0 - k * g + gg;
+
+        if (isHighpass)
+            return { 1.0, -2.0, 1.0, a0, a1, a2 };
+
+        return { gg, 2.0 * gg, gg, a0, a1, a2 };
+    }
+
+    // same thing for (s^2 + kAs + 1) / (s^2 + (k / A)s + 1), which is exactly what makePeakFilter builds
+    BiquadCoefficients makePeakSection(double g, double k, double A) noexcept
+    {
+        auto gg = g * g;
+        auto c = 2.0 * (gg - 1.0);
+
+        return { 1.0 + k * A * g + gg, c, 1.0 - k * A * g + gg,
+                 1.0 + k / A * g + gg, c, 1.0 - k / A * g + gg };
+    }
+
+    double getMagnitudeInDecibels(const CutCoefficients& sections, int numSections, double frequency, double sampleRate)
+    {
+        auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        auto z1 = std::polar(1.0, -w);
+        auto z2 = z1 * z1;
+
+        auto magnitude = 1.0;
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            const auto& c = sections[static_cast<size_t>(i)];
+
+            auto numerator = static_cast<double>(c[0]) + static_cast<double>(c[1]) * z1 + static_cast<double>(c[2]) * z2;
+            auto denominator = static_cast<double>(c[3]) + static_cast<double>(c[4]) * z1 + static_cast<double>(c[5]) * z2;
+
+            magnitude *= std::abs(numerator) / std::abs(denominator);
+        }
+
+        // anything below the floor is stopband noise as far as the comparison is concerned
+        return juce::Decibels::gainToDecibels(magnitude, -100.0);
+    }
+}
+
+void CoefficientTables::prepare(double sampleRate)
+{
+    if (isPreparedFor(sampleRate))
+        return;
+
+    // stay clear of nyquist, tan() runs away up there
+    maxFrequency = static_cast<float>(juce::jmin(20000.0, sampleRate * 0.49));
+
+    auto numPoints = static_cast<int>(std::ceil(std::log2(maxFrequency / minFrequency) * pointsPerOctave)) + 2;
+    warpedFrequencies.resize(static_cast<size_t>(numPoints));
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        auto frequency = juce::jmin(static_cast<double>(minFrequency) * std::exp2(i / static_cast<double>(pointsPerOctave)), sampleRate * 0.49);
+        warpedFrequencies[static_cast<size_t>(i)] = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    }
+
+    auto numGains = static_cast<int>((maxGainInDecibels - minGainInDecibels) / gainStep) + 1;
+    peakGains.resize(static_cast<size_t>(numGains));
+
+    for (int i = 0; i < numGains; ++i)
+        peakGains[static_cast<size_t>(i)] = std::sqrt(juce::Decibels::decibelsToGain(static_cast<double>(minGainInDecibels + i * gainStep)));
+
+    // the same butterworth Qs makeCutCoefficients uses, stored as k = 1 / Q
+    for (int slope = Slope_12; slope <= Slope_96; ++slope)
+    {
+        auto order = getOrderForSlope(static_cast<Slope>(slope));
+
+        for (int i = 0; i < order / 2; ++i)
+            sectionDamping[static_cast<size_t>(slope)][static_cast<size_t>(i)] =
+                2.0 * std::cos((2.0 * i + 1.0) * juce::MathConstants<double>::pi / (order * 2.0));
+    }
+
+    preparedSampleRate = sampleRate;
+    accuracy = measureAccuracy();
+
+    // up near nyquist at low host rates the grid can't follow tan() closely enough, the designer stays exact then
+    accurate = accuracy.maxErrorDecibels < maxErrorDecibels && accuracy.maxPeakErrorDecibels < maxErrorDecibels;
+}
+
+double CoefficientTables::lookupWarpedFrequency(float frequency) const noexcept
+{
+    jassert(! warpedFrequencies.empty());
+
+    auto position = std::log2(static_cast<double>(juce::jlimit(minFrequency, maxFrequency, frequency) / minFrequency)) * pointsPerOctave;
+    auto index = juce::jlimit(0, static_cast<int>(warpedFrequencies.size()) - 2, static_cast<int>(position));
+    auto fraction = position - static_cast<double>(index);
+
+    auto lower = warpedFrequencies[static_cast<size_t>(index)];
+    auto upper = warpedFrequencies[static_cast<size_t>(index + 1)];
+
+    return lower + fraction * (upper - lower);
+}
+
+double CoefficientTables::lookupPeakGain(float gainInDecibels) const noexcept
+{
+    jassert(! peakGains.empty());
+
+    auto position = static_cast<double>(juce::jlimit(minGainInDecibels, maxGainInDecibels, gainInDecibels) - minGainInDecibels) / gainStep;
+    auto index = juce::jlimit(0, static_cast<int>(peakGains.size()) - 2, static_cast<int>(position));
+    auto fraction = position - static_cast<double>(index);
+
+    auto lower = peakGains[static_cast<size_t>(index)];
+    auto upper = peakGains[static_cast<size_t>(index + 1)];
+
+    return lower + fraction * (upper - lower);
+}
+
+CutCoefficients CoefficientTables::makeCut(float frequency, Slope slope, bool isHighpass) const noexcept
+{
+    CutCoefficients coefficients{};
+
+    auto g = lookupWarpedFrequency(frequency);
+    auto numSections = getOrderForSlope(slope) / 2;
+
+    for (int i = 0; i < numSections; ++i)
+        coefficients[static_cast<size_t>(i)] = makeCutSection(g, sectionDamping[static_cast<size_t>(slope)][static_cast<size_t>(i)], isHighpass);
+
+    return coefficients;
+}
+
+CutCoefficients CoefficientTables::makePeak(const ChainSettings& chainSettings) const noexcept
+{
+    CutCoefficients coefficients{};
+
+    coefficients[0] = makePeakSection(lookupWarpedFrequency(chainSettings.peakFreq),
+                                      1.0 / chainSettings.peakQuality,
+                                      lookupPeakGain(chainSettings.peakGainInDecibels));
+
+    return coefficients;
+}
+
+CoefficientTables::Accuracy CoefficientTables::measureAccuracy() const
+{
+    // the interpolation is at its worst halfway between two grid points, so that's where we test
+    Accuracy worst;
+
+    constexpr int numTestFrequencies = 48;
+    constexpr int numEvaluationFrequencies = 32;
+
+    for (int slope = Slope_12; slope <= Slope_96; ++slope)
+    {
+        auto numSections = getOrderForSlope(static_cast<Slope>(slope)) / 2;
+
+        for (int t = 0; t < numTestFrequencies; ++t)
+        {
+            auto gridPosition = std::floor((t + 0.5f) / numTestFrequencies * (warpedFrequencies.size() - 2)) + 0.5f;
+            auto frequency = minFrequency * std::exp2(gridPosition / pointsPerOctave);
+
+            if (frequency >= maxFrequency)
+                continue;
+
+            for (auto isHighpass : { true, false })
+            {
+                auto exact = makeCutCoefficients(frequency, preparedSampleRate, getOrderForSlope(static_cast<Slope>(slope)), isHighpass);
+                auto approximate = makeCut(frequency, static_cast<Slope>(slope), isHighpass);
+
+                for (int e = 0; e < numEvaluationFrequencies; ++e)
+                {
+                    auto evaluationFrequency = juce::mapToLog10(static_cast<double>(e) / (numEvaluationFrequencies - 1), 10.0, static_cast<double>(maxFrequency));
+                    auto error = std::abs(getMagnitudeInDecibels(exact, numSections, evaluationFrequency, preparedSampleRate)
+                                        - getMagnitudeInDecibels(approximate, numSections, evaluationFrequency, preparedSampleRate));
+
+                    if (error > worst.maxErrorDecibels)
+                    {
+                        worst.maxErrorDecibels = static_cast<float>(error);
+                        worst.worstFrequency = frequency;
+                        worst.worstSlope = static_cast<Slope>(slope);
+                    }
+                }
+            }
+        }
+    }
+
+    for (int t = 0; t < numTestFrequencies; ++t)
+    {
+        auto gridPosition = std::floor((t + 0.5f) / numTestFrequencies * (warpedFrequencies.size() - 2)) + 0.5f;
+
+        ChainSettings chainSettings;
+        chainSettings.peakFreq = minFrequency * std::exp2(gridPosition / pointsPerOctave);
+        chainSettings.peakQuality = 1.f;
+
+        if (chainSettings.peakFreq >= maxFrequency)
+            continue;
+
+        for (auto gainInDecibels : { minGainInDecibels, -6.25f, 6.25f, maxGainInDecibels })
+        {
+            chainSettings.peakGainInDecibels = gainInDecibels;
+
+            CutCoefficients exact{};
+            exact[0] = makePeakCoefficients(chainSettings, preparedSampleRate);
+            auto approximate = makePeak(chainSettings);
+
+            for (int e = 0; e < numEvaluationFrequencies; ++e)
+            {
+                auto evaluationFrequency = juce::mapToLog10(static_cast<double>(e) / (numEvaluationFrequencies - 1), 10.0, static_cast<double>(maxFrequency));
+                auto error = std::abs(getMagnitudeInDecibels(exact, 1, evaluationFrequency, preparedSampleRate)
+                                    - getMagnitudeInDecibels(approximate, 1, evaluationFrequency, preparedSampleRate));
+
+                worst.maxPeakErrorDecibels = juce::jmax(worst.maxPeakErrorDecibels, static_cast<float>(error));
+            }
+        }
+    }
+
+    return worst;
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    CoefficientTables.h
+    Table driven approximations of the chain's designs, for when the
+    parameters are being swept.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "CoefficientCache.h"
+
+//==============================================================================
+/**
+    Every design in the chain is a bilinear transformed analog prototype, so each
+    section boils down to a warped frequency g = tan(pi * f / fs), a damping k = 1 / Q
+    and, for the peak, a gain A. prepare() tabulates g on a log frequency grid for
+    the current sample rate, the damping of every section of every slope, and A over
+    the peak gain range.
+
+    A lookup interpolates g and A and rebuilds the biquads from (g, k, A) with a few
+    multiplies, no trig. Interpolating there rather than in the biquad coefficients
+    keeps every section stable: g and k stay positive, so the poles stay inside the
+    unit circle whatever the interpolation error is.
+
+    The grid and the sections are all double. The approximate design is swapped
+    for the exact one as soon as a sweep stops, so anything the tables get wrong
+    is heard as a jump right then.
+
+    prepare() also measures how far the interpolated designs stray from the exact
+    ones, see getAccuracy(). Past maxErrorDecibels isAccurate() is false and the
+    designer doesn't use the tables at that rate.
+*/
+class CoefficientTables
+{
+public:
+    struct Accuracy
+    {
+        // worst magnitude response difference to the exact design across every slope
+        float maxErrorDecibels{ 0 };
+        float worstFrequency{ 0 };
+        Slope worstSlope{ Slope::Slope_12 };
+
+        // and the same for the peak, across the gain range
+        float maxPeakErrorDecibels{ 0 };
+    };
+
+    // not on the audio thread, allocates the grid
+    void prepare(double sampleRate);
+    bool isPreparedFor(double sampleRate) const noexcept { return sampleRate == preparedSampleRate; }
+
+    CutCoefficients makeCut(float frequency, Slope slope, bool isHighpass) const noexcept;
+    CutCoefficients makePeak(const ChainSettings& chainSettings) const noexcept;
+
+    Accuracy getAccuracy() const noexcept { return accuracy; }
+
+    // the largest difference to the exact designs, cut or peak, that the swap back to them can hide
+    static constexpr float maxErrorDecibels = 0.1f;
+    bool isAccurate() const noexcept { return accurate; }
+
+private:
+    double lookupWarpedFrequency(float frequency) const noexcept;
+    double lookupPeakGain(float gainInDecibels) const noexcept;
+    Accuracy measureAccuracy() const;
+
+    static constexpr float minFrequency = 10.f;
+    static constexpr float pointsPerOctave = 96.f;
+    static constexpr float minGainInDecibels = -24.f, maxGainInDecibels = 24.f, gainStep = 0.5f;
+
+    double preparedSampleRate{ 0.0 };
+    float maxFrequency{ 0 };
+
+    std::vector<double> warpedFrequencies;
+    std::vector<double> peakGains;
+
+    // damping of section i of each slope, the same at every sample rate
+    std::array<std::array<double, 8>, 5> sectionDamping{};
+
+    Accuracy accuracy;
+    bool accurate{ false };
+};
@@ -0,0 +1,381 @@
+/*
+  ==============================================================================
+
+    CutFilterDesigns.cpp
+    Chebyshev I, Chebyshev II and elliptic designs for the LowCut and HighCut,
+    for when steepness matters more than a flat, smooth knee.
+
+  ==============================================================================
+*/
+
+#include "CutFilterDesigns.h"
+#include "CoefficientDesigner.h"
+
+namespace
+{
+    using Complex = std::complex<double>;
+
+    constexpr double pi = juce::MathConstants<double>::pi;
+    constexpr Complex j{ 0.0, 1.0 };
+
+    // where the attenuation is checked, one octave past a cutoff at 1 rad/s
+    constexpr double octave = 2.0;
+
+    constexpr int maxOrder = 16;
+
+    double getEpsilon(double decibels) noexcept
+    {
+        return std::sqrt(std::pow(10.0, decibels / 10.0) - 1.0);
+    }
+
+    //==============================================================================
+    // the elliptic machinery, after Orfanidis' "Lecture Notes on Elliptic Filter Design":
+    // jacobi's cd and sn through descending landen transformations, and their inverses
+    std::array<double, 8> getLandenSequence(double k) noexcept
+    {
+        std::array<double, 8> moduli{};
+
+        for (auto& modulus : moduli)
+        {
+            k = k / (1.0 + std::sqrt(1.0 - k * k));
+            k *= k;
+            modulus = k;
+        }
+
+        return moduli;
+    }
+
+    Complex ascend(Complex w, double k) noexcept
+    {
+        auto moduli = getLandenSequence(k);
+
+        for (auto it = moduli.rbegin(); it != moduli.rend(); ++it)
+            w = (1.0 + *it) * w / (1.0 + *it * w * w);
+
+        return w;
+    }
+
+    Complex cd(Complex u, double k) noexcept { return ascend(std::cos(u * pi / 2.0), k); }
+    Complex sn(Complex u, double k) noexcept { return ascend(std::sin(u * pi / 2.0), k); }
+
+    Complex inverseCd(Complex w, double k) noexcept
+    {
+        auto moduli = getLandenSequence(k);
+        auto previous = k;
+
+        for (auto modulus : moduli)
+        {
+            w = w / (1.0 + std::sqrt(1.0 - w * w * previous * previous)) * 2.0 / (1.0 + modulus);
+            previous = modulus;
+        }
+
+        return std::acos(w) * 2.0 / pi;
+    }
+
+    Complex inverseSn(Complex w, double k) noexcept { return 1.0 - inverseCd(w, k); }
+
+    // complete elliptic integral of the first kind, through the arithmetic-geometric mean
+    double ellipticK(double k) noexcept
+    {
+        auto a = 1.0, b = std::sqrt(1.0 - k * k);
+
+        for (int i = 0; i < 32 && std::abs(a - b) > 1.0e-15 * a; ++i)
+        {
+            auto mean = (a + b) * 0.5;
+            b = std::sqrt(a * b);
+            a = mean;
+        }
+
+        return pi / (2.0 * a);
+    }
+
+    double getComplement(double k) noexcept { return std::sqrt(1.0 - k * k); }
+
+    // the selectivity an integer order really reaches for a given discrimination k1
+    double solveDegreeEquation(int order, double k1) noexcept
+    {
+        auto k1Complement = getComplement(k1);
+        auto complement = std::pow(k1Complement, order);
+
+        for (int i = 1; i <= order / 2; ++i)
+            complement *= std::pow(sn((2.0 * i - 1.0) / order, k1Complement).real(), 4.0);
+
+        return getComplement(complement);
+    }
+
+    //==============================================================================
+    // one pole of every conjugate pair (or a real pole), with the zero pair it is paired with, if any
+    struct PolePair
+    {
+        Complex pole;
+        bool hasZero{ false };
+        double zeroFrequency{ 0.0 };
+    };
+
+    struct Prototype
+    {
+        std::vector<PolePair> pairs;
+
+        // how far an even order design's DC sits under the passband peak
+        double passbandGain{ 1.0 };
+    };
+
+    std::vector<Complex> makeChebyshevPoles(int order, double epsilon)
+    {
+        std::vector<Complex> poles;
+        auto mu = std::asinh(1.0 / epsilon) / order;
+
+        // the upper half plane and the real pole, the rest are their conjugates
+        for (int k = 1; k <= (order + 1) / 2; ++k)
+        {
+            auto theta = (2.0 * k - 1.0) * pi / (2.0 * order);
+            poles.push_back({ -std::sinh(mu) * std::sin(theta), std::cosh(mu) * std::cos(theta) });
+        }
+
+        return poles;
+    }
+
+    Prototype makeChebyshevIPrototype(int order)
+    {
+        auto epsilon = getEpsilon(cutFilterRippleDecibels);
+
+        Prototype prototype;
+
+        for (auto pole : makeChebyshevPoles(order, epsilon))
+            prototype.pairs.push_back({ pole });
+
+        if (order % 2 == 0)
+            prototype.passbandGain = 1.0 / std::sqrt(1.0 + epsilon * epsilon);
+
+        return prototype;
+    }
+
+    Prototype makeChebyshevIIPrototype(int order, double stopbandDecibels)
+    {
+        auto stopbandEpsilon = getEpsilon(stopbandDecibels);
+
+        // the textbook prototype has its stop band edge at 1, move it out so the -3 dB point is there instead
+        auto scale = std::cosh(std::acosh(stopbandEpsilon) / order);
+
+        Prototype prototype;
+        auto poles = makeChebyshevPoles(order, 1.0 / stopbandEpsilon);
+
+        for (size_t k = 0; k < poles.size(); ++k)
+        {
+            auto theta = (2.0 * static_cast<double>(k + 1) - 1.0) * pi / (2.0 * order);
+
+            PolePair pair;
+            pair.pole = std::conj(1.0 / poles[k]) * scale;
+
+            // the middle one of an odd order has its zero at infinity
+            if (std::abs(std::cos(theta)) > 1.0e-9)
+            {
+                pair.hasZero = true;
+                pair.zeroFrequency = scale / std::cos(theta);
+            }
+
+            prototype.pairs.push_back(pair);
+        }
+
+        return prototype;
+    }
+
+    int getEllipticOrder(double stopbandDecibels) noexcept
+    {
+        auto k = 1.0 / octave;
+        auto k1 = getEpsilon(cutFilterRippleDecibels) / getEpsilon(stopbandDecibels);
+
+        auto exact = ellipticK(k) * ellipticK(getComplement(k1)) / (ellipticK(getComplement(k)) * ellipticK(k1));
+        return static_cast<int>(std::ceil(exact - 1.0e-9));
+    }
+
+    Prototype makeEllipticPrototype(int order, double stopbandDecibels)
+    {
+        auto passbandEpsilon = getEpsilon(cutFilterRippleDecibels);
+        auto k1 = passbandEpsilon / getEpsilon(stopbandDecibels);
+        auto k = solveDegreeEquation(order, k1);
+
+        auto v0 = (-j * inverseSn(j / passbandEpsilon, k1) / static_cast<double>(order)).real();
+
+        Prototype prototype;
+
+        for (int i = 1; i <= order / 2; ++i)
+        {
+            auto u = (2.0 * i - 1.0) / order;
+            auto zeta = cd(u, k).real();
+
+            PolePair pair;
+            pair.pole = j * cd(u - j * v0, k);
+            pair.hasZero = true;
+            pair.zeroFrequency = 1.0 / (k * zeta);
+            prototype.pairs.push_back(pair);
+        }
+
+        if (order % 2 == 1)
+            prototype.pairs.push_back({ Complex((j * sn(j * v0, k)).real(), 0.0) });
+        else
+            prototype.passbandGain = 1.0 / std::sqrt(1.0 + passbandEpsilon * passbandEpsilon);
+
+        return prototype;
+    }
+
+    // attenuation one octave out, for the orders that don't come out of a closed form
+    double getChebyshevIAttenuation(int order) noexcept
+    {
+        auto epsilon = getEpsilon(cutFilterRippleDecibels);
+        auto chebyshev = std::cosh(order * std::acosh(octave));
+        return 10.0 * std::log10(1.0 + epsilon * epsilon * chebyshev * chebyshev);
+    }
+
+    //==============================================================================
+    // H(s) = (b2 s^2 + b1 s + b0) / (a2 s^2 + a1 s + a0), unity gain at DC
+    struct AnalogSection
+    {
+        double b0, b1, b2, a0, a1, a2;
+        bool isFirstOrder;
+    };
+
+    AnalogSection makeAnalogSection(const PolePair& pair) noexcept
+    {
+        auto isReal = std::abs(pair.pole.imag()) < 1.0e-12;
+
+        if (isReal)
+        {
+            // (-p) / (s - p)
+            auto p = pair.pole.real();
+            return { -p, 0.0, 0.0, -p, 1.0, 0.0, true };
+        }
+
+        auto magnitudeSquared = std::norm(pair.pole);
+        auto a1 = -2.0 * pair.pole.real();
+
+        if (! pair.hasZero)
+            return { magnitudeSquared, 0.0, 0.0, magnitudeSquared, a1, 1.0, false };
+
+        // (s^2 + wz^2) scaled so DC comes out at 1
+        auto zeroSquared = pair.zeroFrequency * pair.zeroFrequency;
+        auto scale = magnitudeSquared / zeroSquared;
+
+        return { zeroSquared * scale, 0.0, scale, magnitudeSquared, a1, 1.0, false };
+    }
+
+    BiquadCoefficients transformSection(AnalogSection section, double warpedFrequency, bool isHighpass) noexcept
+    {
+        auto K = warpedFrequency;
+
+        if (section.isFirstOrder)
+        {
+            // (b1 s + b0) / (a1 s + a0), the high pass being (b0 s + b1) / (a0 s + a1)
+            if (isHighpass)
+            {
+                std::swap(section.b0, section.b1);
+                std::swap(section.a0, section.a1);
+            }
+
+            return { section.b1 + section.b0 * K, section.b0 * K - section.b1, 0.0,
+                     section.a1 + section.a0 * K, section.a0 * K - section.a1, 0.0 };
+        }
+
+        // s -> 1 / s, the low pass prototype becomes the high pass with the same cutoff
+        if (isHighpass)
+        {
+            std::swap(section.b0, section.b2);
+            std::swap(section.a0, section.a2);
+        }
+
+        auto bilinear = [K](double c0, double c1, double c2)
+        {
+            return std::array<double, 3>{ c2 + c1 * K + c0 * K * K, 2.0 * (c0 * K * K - c2), c2 - c1 * K + c0 * K * K };
+        };
+
+        auto b = bilinear(section.b0, section.b1, section.b2);
+        auto a = bilinear(section.a0, section.a1, section.a2);
+
+        return { b[0], b[1], b[2], a[0], a[1], a[2] };
+    }
+
+    double getPoleQuality(Complex pole) noexcept
+    {
+        return std::abs(pole) / (-2.0 * pole.real());
+    }
+}
+
+double getCutAttenuationTarget(Slope slope) noexcept
+{
+    auto order = getOrderForSlope(slope);
+    return 10.0 * std::log10(1.0 + std::pow(octave, 2.0 * order));
+}
+
+int getCutFilterOrder(CutFilterType type, Slope slope) noexcept
+{
+    auto target = getCutAttenuationTarget(slope);
+    auto order = getOrderForSlope(slope);
+
+    switch (type)
+    {
+        case ChebyshevI:
+            order = 1;
+            while (order < maxOrder && getChebyshevIAttenuation(order) < target)
+                ++order;
+            break;
+
+        case ChebyshevII:
+            // the stop band edge has to come in at or under the octave
+            order = static_cast<int>(std::ceil(std::acosh(getEpsilon(target)) / std::acosh(octave) - 1.0e-9));
+            break;
+
+        case Elliptic:
+            order = getEllipticOrder(target);
+            break;
+
+        case Butterworth:
+        default:
+            break;
+    }
+
+    return juce::jlimit(1, maxOrder, order);
+}
+
+int getNumCutSections(CutFilterType type, Slope slope) noexcept
+{
+    return (getCutFilterOrder(type, slope) + 1) / 2;
+}
+
+CutCoefficients makeCutFilterCoefficients(CutFilterType type, float frequency, double sampleRate, Slope slope, bool isHighpass)
+{
+    jassert(type != CutFilterType::Butterworth);
+
+    auto order = getCutFilterOrder(type, slope);
+    auto stopbandDecibels = getCutAttenuationTarget(slope);
+
+    auto prototype = type == ChebyshevI ? makeChebyshevIPrototype(order)
+                   : type == ChebyshevII ? makeChebyshevIIPrototype(order, stopbandDecibels)
+                                         : makeEllipticPrototype(order, stopbandDecibels);
+
+    // the gentle sections go first, so the sharp ones further down don't get hit by anything they could ring on
+    std::sort(prototype.pairs.begin(), prototype.pairs.end(), [](const PolePair& a, const PolePair& b)
+    {
+        return getPoleQuality(a.pole) < getPoleQuality(b.pole);
+    });
+
+    auto nyquistSafeFrequency = juce::jmin(static_cast<double>(frequency), sampleRate * 0.49);
+    auto warpedFrequency = std::tan(pi * nyquistSafeFrequency / sampleRate);
+
+    CutCoefficients coefficients{};
+
+    for (size_t i = 0; i < prototype.pairs.size(); ++i)
+    {
+        auto section = makeAnalogSection(prototype.pairs[i]);
+
+        if (i == 0)
+        {
+            section.b0 *= prototype.passbandGain;
+            section.b1 *= prototype.passbandGain;
+            section.b2 *= prototype.passbandGain;
+        }
+
+        coefficients[i] = transformSection(section, warpedFrequency, isHighpass);
+    }
+
+    return coefficients;
+}
@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    CutFilterDesigns.h
+    Chebyshev I, Chebyshev II and elliptic designs for the LowCut and HighCut,
+    for when steepness matters more than a flat, smooth knee.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "CoefficientCache.h"
+
+// passband ripple of the Chebyshev I and elliptic designs, the cutoff sits where the ripple ends
+constexpr double cutFilterRippleDecibels = 0.5;
+
+// how far the Butterworth of a slope is down one octave past its cutoff, the target every other type has to meet
+double getCutAttenuationTarget(Slope slope) noexcept;
+
+/*
+    The lowest order of a filter type that is at least as far down as the slope's Butterworth
+    one octave past the cutoff, and stays there from that octave on. Capped at 16, so it still
+    fits the 8 sections of a stage. An odd order starts with its first order section, the
+    sections run from gentlest to sharpest.
+*/
+int getCutFilterOrder(CutFilterType type, Slope slope) noexcept;
+int getNumCutSections(CutFilterType type, Slope slope) noexcept;
+
+/*
+    Designed on the analog prototype (the ripple band or -3 dB point at 1 rad/s), turned into a
+    high pass by s -> 1/s for the LowCut, and bilinear transformed with the cutoff prewarped, the
+    same way the Butterworth sections are. Every section has unity gain in the passband, the
+    first one takes the ripple of an even order design, so the passband peaks at 0 dB.
+
+    The order comes from getCutFilterOrder(), and the stop band of Chebyshev II and elliptic is
+    set to the slope's attenuation target, so two slopes that end up with the same order still
+    get different designs. Not meant for Butterworth, makeCutCoefficients() does those.
+*/
+CutCoefficients makeCutFilterCoefficients(CutFilterType type, float frequency, double sampleRate, Slope slope, bool isHighpass);
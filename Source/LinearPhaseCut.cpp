@@ -0,0 +1,415 @@
+/*
+  ==============================================================================
+
+    LinearPhaseCut.cpp
+    The "straight line" LowCut/HighCut: a linear phase brickwall FIR, run
+    through uniformly partitioned overlap-save convolution.
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseCut.h"
+
+namespace
+{
+    constexpr int partitionSize = linearPhasePartitionSize;
+    constexpr int numBins = partitionSize + 1;
+
+    // overlap-save needs an FFT of two partitions
+    constexpr int fftOrder = 9;
+    static_assert((1 << fftOrder) == 2 * partitionSize, "the FFT has to cover two partitions");
+
+    constexpr double firSeconds = 0.17;
+    constexpr double kaiserBeta = 8.6;
+
+    // zeroth order modified bessel function of the first kind, for the kaiser window
+    double besselI0(double x) noexcept
+    {
+        auto sum = 1.0, term = 1.0;
+
+        for (int k = 1; term > sum * 1.0e-12; ++k)
+        {
+            auto factor = x / (2.0 * k);
+            term *= factor * factor;
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    // sum += x * h over every bin. spelled out, std::complex's operator* checks for infinities and won't vectorise
+    void multiplyAdd(const std::complex<float>* x, const std::complex<float>* h, std::complex<float>* sum) noexcept
+    {
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            auto xr = x[bin].real(), xi = x[bin].imag();
+            auto hr = h[bin].real(), hi = h[bin].imag();
+            sum[bin] += std::complex<float>(xr * hr - xi * hi, xr * hi + xi * hr);
+        }
+    }
+}
+
+int getLinearPhaseNumPartitions(double sampleRate) noexcept
+{
+    return juce::jmax(1, static_cast<int>(std::ceil(sampleRate * firSeconds / partitionSize)));
+}
+
+int getLinearPhaseFirLength(double sampleRate) noexcept
+{
+    return getLinearPhaseNumPartitions(sampleRate) * partitionSize - 1;
+}
+
+int getLinearPhaseLatency(double sampleRate) noexcept
+{
+    return partitionSize + (getLinearPhaseFirLength(sampleRate) - 1) / 2;
+}
+
+//==============================================================================
+std::atomic<juce::uint64> LinearPhaseDesigner::nextId{ 1 };
+
+void LinearPhaseDesigner::prepare(double sampleRate)
+{
+    preparedSampleRate = sampleRate;
+    numPartitions = getLinearPhaseNumPartitions(sampleRate);
+
+    auto length = getLinearPhaseFirLength(sampleRate);
+    window.resize(static_cast<size_t>(length));
+
+    auto normalisation = besselI0(kaiserBeta);
+
+    for (int n = 0; n < length; ++n)
+    {
+        auto r = 2.0 * n / (length - 1) - 1.0;
+        window[static_cast<size_t>(n)] = static_cast<float>(besselI0(kaiserBeta * std::sqrt(1.0 - r * r)) / normalisation);
+    }
+
+    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+}
+
+std::shared_ptr<const LinearPhaseFilter> LinearPhaseDesigner::design(float lowCutFrequency, float highCutFrequency) const
+{
+    jassert(fft != nullptr); // prepare() first
+
+    auto length = static_cast<int>(window.size());
+    auto centre = (length - 1) / 2;
+
+    // in cycles per sample. a HighCut at or under the LowCut leaves nothing to pass, which is what the IIR cuts get close to as well
+    auto nyquist = preparedSampleRate * 0.5;
+    auto low = juce::jlimit(0.0, nyquist, static_cast<double>(lowCutFrequency)) / preparedSampleRate;
+    auto high = juce::jmax(low, juce::jlimit(0.0, nyquist, static_cast<double>(highCutFrequency)) / preparedSampleRate);
+
+    // the ideal band pass is the HighCut's ideal low pass minus the LowCut's
+    std::vector<float> impulse(static_cast<size_t>(numPartitions * partitionSize), 0.f);
+
+    for (int n = 0; n < length; ++n)
+    {
+        auto m = static_cast<double>(n - centre);
+        auto ideal = m == 0.0 ? 2.0 * (high - low)
+                              : (std::sin(juce::MathConstants<double>::twoPi * high * m)
+                                 - std::sin(juce::MathConstants<double>::twoPi * low * m)) / (juce::MathConstants<double>::pi * m);
+
+        impulse[static_cast<size_t>(n)] = static_cast<float>(ideal) * window[static_cast<size_t>(n)];
+    }
+
+    auto filter = std::make_shared<LinearPhaseFilter>();
+    filter->id = nextId++;
+    filter->numPartitions = numPartitions;
+    filter->spectra.resize(static_cast<size_t>(numPartitions * numBins));
+
+    // each partition zero padded to the FFT size, so its product with an input window is a linear convolution
+    std::vector<float> buffer(static_cast<size_t>(4 * partitionSize));
+
+    for (int k = 0; k < numPartitions; ++k)
+    {
+        std::fill(buffer.begin(), buffer.end(), 0.f);
+        std::copy_n(impulse.begin() + k * partitionSize, partitionSize, buffer.begin());
+
+        fft->performRealOnlyForwardTransform(buffer.data(), true);
+
+        for (int bin = 0; bin < numBins; ++bin)
+            filter->spectra[static_cast<size_t>(k * numBins + bin)] = { buffer[static_cast<size_t>(2 * bin)], buffer[static_cast<size_t>(2 * bin + 1)] };
+    }
+
+    return filter;
+}
+
+//==============================================================================
+void PartitionedConvolver::prepare(double sampleRate, int numChannels)
+{
+    numPartitions = getLinearPhaseNumPartitions(sampleRate);
+    latency = getLinearPhaseLatency(sampleRate);
+
+    channels.resize(static_cast<size_t>(numChannels));
+
+    for (auto& channel : channels)
+    {
+        channel.input.assign(static_cast<size_t>(2 * partitionSize), 0.f);
+        channel.output.assign(static_cast<size_t>(partitionSize), 0.f);
+        channel.delayLine.assign(static_cast<size_t>(numPartitions * numBins), {});
+        channel.running.sum.assign(static_cast<size_t>(numBins), {});
+        channel.incoming.sum.assign(static_cast<size_t>(numBins), {});
+        channel.bypass.assign(static_cast<size_t>(latency), 0.f);
+    }
+
+    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+    fftBuffer.assign(static_cast<size_t>(4 * partitionSize), 0.f);
+    fadeBuffer.assign(static_cast<size_t>(partitionSize), 0.f);
+
+    reset();
+}
+
+void PartitionedConvolver::reset() noexcept
+{
+    resetConvolution();
+
+    for (auto& channel : channels)
+    {
+        std::fill(channel.bypass.begin(), channel.bypass.end(), 0.f);
+        channel.bypassPosition = 0;
+    }
+}
+
+void PartitionedConvolver::resetConvolution() noexcept
+{
+    for (auto& channel : channels)
+    {
+        std::fill(channel.input.begin(), channel.input.end(), 0.f);
+        std::fill(channel.output.begin(), channel.output.end(), 0.f);
+        std::fill(channel.delayLine.begin(), channel.delayLine.end(), std::complex<float>{});
+        channel.head = 0;
+        channel.position = 0;
+
+        // no filter yet, the first one is taken as is rather than faded in from nothing
+        for (auto* accumulation : { &channel.running, &channel.incoming })
+        {
+            std::fill(accumulation->sum.begin(), accumulation->sum.end(), std::complex<float>{});
+            accumulation->filterId = 0;
+            accumulation->numTerms = 0;
+        }
+    }
+}
+
+void PartitionedConvolver::process(int channelIndex, float* samples, int numSamples,
+                                   const LinearPhaseFilter& filter, const LinearPhaseFilter* previous) noexcept
+{
+    jassert(juce::isPositiveAndBelow(channelIndex, static_cast<int>(channels.size())));
+    jassert(filter.numPartitions == numPartitions); // designed for another sample rate
+
+    auto& channel = channels[static_cast<size_t>(channelIndex)];
+
+    while (numSamples > 0)
+    {
+        const auto& running = followFilter(channel, filter, previous);
+
+        // the input goes into the newer half of the window, the output comes from the partition computed last time
+        auto start = channel.position;
+        auto numToCopy = juce::jmin(numSamples, partitionSize - start);
+
+        std::copy_n(samples, numToCopy, channel.input.begin() + partitionSize + start);
+        std::copy_n(channel.output.begin() + start, numToCopy, samples);
+
+        channel.position += numToCopy;
+        samples += numToCopy;
+        numSamples -= numToCopy;
+
+        accumulate(channel, channel.running, running, start);
+
+        if (channel.incoming.filterId != 0)
+            accumulate(channel, channel.incoming, filter, start);
+
+        if (channel.position == partitionSize)
+        {
+            processPartition(channel, running, filter);
+            channel.position = 0;
+        }
+    }
+}
+
+const LinearPhaseFilter& PartitionedConvolver::followFilter(Channel& channel, const LinearPhaseFilter& filter,
+                                                            const LinearPhaseFilter* previous) noexcept
+{
+    if (channel.running.filterId == 0)
+        channel.running.filterId = filter.id;
+
+    // still on the filter we're running, or back on it before the fade got going
+    if (channel.running.filterId == filter.id)
+    {
+        channel.incoming.filterId = 0;
+        return filter;
+    }
+
+    // the old filter's output and the new one's off the same history, faded across the end of this partition. if the
+    // audio thread skipped a set, previous is the filter just before the new one rather than the one we were running,
+    // close enough to the knob position that the fade still covers the step
+    if (previous != nullptr)
+    {
+        jassert(previous->numPartitions == numPartitions);
+
+        if (channel.incoming.filterId != filter.id)
+        {
+            std::fill(channel.incoming.sum.begin(), channel.incoming.sum.end(), std::complex<float>{});
+            channel.incoming.filterId = filter.id;
+            channel.incoming.numTerms = 0;
+        }
+
+        return *previous;
+    }
+
+    // nothing to fade from, the new filter takes over with this partition. its sum so far is kept if it was already
+    // coming in, otherwise it starts over and catches up over the rest of the partition
+    if (channel.incoming.filterId == filter.id)
+    {
+        std::swap(channel.running, channel.incoming);
+    }
+    else
+    {
+        std::fill(channel.running.sum.begin(), channel.running.sum.end(), std::complex<float>{});
+        channel.running.numTerms = 0;
+    }
+
+    channel.running.filterId = filter.id;
+    channel.incoming.filterId = 0;
+    return filter;
+}
+
+void PartitionedConvolver::accumulate(const Channel& channel, Accumulation& accumulation, const LinearPhaseFilter& filter, int start) noexcept
+{
+    // what's left of the older partitions, spread evenly over what's left of the input. all of it once the partition is full
+    auto remaining = numPartitions - 1 - accumulation.numTerms;
+    auto numSamplesLeft = partitionSize - start;
+    auto numTerms = (remaining * (channel.position - start) + numSamplesLeft - 1) / numSamplesLeft;
+
+    for (int i = 0; i < numTerms; ++i)
+    {
+        // partition k of the filter meets the input from k partitions ago. the newest window isn't in the delay line
+        // yet, so that's k - 1 back from head
+        auto k = ++accumulation.numTerms;
+        auto slot = (channel.head - k + 1 + numPartitions) % numPartitions;
+
+        multiplyAdd(channel.delayLine.data() + slot * numBins, filter.spectra.data() + k * numBins, accumulation.sum.data());
+    }
+}
+
+void PartitionedConvolver::processPartition(Channel& channel, const LinearPhaseFilter& running, const LinearPhaseFilter& filter) noexcept
+{
+    std::copy(channel.input.begin(), channel.input.end(), fftBuffer.begin());
+    std::fill(fftBuffer.begin() + 2 * partitionSize, fftBuffer.end(), 0.f);
+    fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+    channel.head = (channel.head + 1) % numPartitions;
+    auto* newest = channel.delayLine.data() + channel.head * numBins;
+
+    for (int bin = 0; bin < numBins; ++bin)
+        newest[bin] = { fftBuffer[static_cast<size_t>(2 * bin)], fftBuffer[static_cast<size_t>(2 * bin + 1)] };
+
+    // the newer half becomes the older one for the next partition
+    std::copy_n(channel.input.begin() + partitionSize, partitionSize, channel.input.begin());
+
+    if (channel.incoming.filterId == 0)
+    {
+        finish(channel.running, running, newest, channel.output.data());
+    }
+    else
+    {
+        finish(channel.running, running, newest, fadeBuffer.data());
+        finish(channel.incoming, filter, newest, channel.output.data());
+
+        for (int i = 0; i < partitionSize; ++i)
+        {
+            auto amount = static_cast<float>(i + 1) / partitionSize;
+            auto& sample = channel.output[static_cast<size_t>(i)];
+            sample = fadeBuffer[static_cast<size_t>(i)] + amount * (sample - fadeBuffer[static_cast<size_t>(i)]);
+        }
+
+        channel.running.filterId = channel.incoming.filterId;
+        channel.incoming.filterId = 0;
+    }
+}
+
+void PartitionedConvolver::finish(Accumulation& accumulation, const LinearPhaseFilter& filter,
+                                  const std::complex<float>* newest, float* destination) noexcept
+{
+    jassert(accumulation.numTerms == numPartitions - 1);
+
+    // the newest partition's term, then the sum starts over for the next partition
+    multiplyAdd(newest, filter.spectra.data(), accumulation.sum.data());
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        fftBuffer[static_cast<size_t>(2 * bin)] = accumulation.sum[static_cast<size_t>(bin)].real();
+        fftBuffer[static_cast<size_t>(2 * bin + 1)] = accumulation.sum[static_cast<size_t>(bin)].imag();
+    }
+
+    std::fill(accumulation.sum.begin(), accumulation.sum.end(), std::complex<float>{});
+    accumulation.numTerms = 0;
+
+    fft->performRealOnlyInverseTransform(fftBuffer.data());
+
+    // overlap-save: the first half wrapped around, the second half is the linear convolution
+    std::copy_n(fftBuffer.begin() + partitionSize, partitionSize, destination);
+}
+
+void PartitionedConvolver::copyChannel(int source, int destination) noexcept
+{
+    const auto& from = channels[static_cast<size_t>(source)];
+    auto& to = channels[static_cast<size_t>(destination)];
+
+    // same sizes on both sides, nothing gets allocated
+    std::copy(from.input.begin(), from.input.end(), to.input.begin());
+    std::copy(from.output.begin(), from.output.end(), to.output.begin());
+    std::copy(from.delayLine.begin(), from.delayLine.end(), to.delayLine.begin());
+    to.head = from.head;
+    to.position = from.position;
+
+    auto copyAccumulation = [](const Accumulation& x, Accumulation& y)
+    {
+        std::copy(x.sum.begin(), x.sum.end(), y.sum.begin());
+        y.filterId = x.filterId;
+        y.numTerms = x.numTerms;
+    };
+
+    copyAccumulation(from.running, to.running);
+    copyAccumulation(from.incoming, to.incoming);
+}
+
+bool PartitionedConvolver::channelsMatch(int a, int b, float tolerance) const noexcept
+{
+    const auto& first = channels[static_cast<size_t>(a)];
+    const auto& second = channels[static_cast<size_t>(b)];
+
+    if (first.head != second.head || first.position != second.position)
+        return false;
+
+    // the sums are built from the delay line alone, so they agree whenever it does and the same terms are in
+    auto sameProgress = [](const Accumulation& x, const Accumulation& y) { return x.filterId == y.filterId && x.numTerms == y.numTerms; };
+
+    if (! sameProgress(first.running, second.running) || ! sameProgress(first.incoming, second.incoming))
+        return false;
+
+    auto samplesMatch = [tolerance](const std::vector<float>& x, const std::vector<float>& y)
+    {
+        return std::equal(x.begin(), x.end(), y.begin(), [tolerance](float p, float q) { return std::abs(p - q) <= tolerance; });
+    };
+
+    // a bin sums a whole window, so it gets that much more room
+    auto binTolerance = tolerance * 2 * partitionSize;
+
+    return samplesMatch(first.input, second.input)
+        && samplesMatch(first.output, second.output)
+        && std::equal(first.delayLine.begin(), first.delayLine.end(), second.delayLine.begin(),
+                      [binTolerance](std::complex<float> p, std::complex<float> q) { return std::abs(p - q) <= binTolerance; });
+}
+
+void PartitionedConvolver::delay(int channelIndex, float* samples, int numSamples) noexcept
+{
+    auto& channel = channels[static_cast<size_t>(channelIndex)];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto& slot = channel.bypass[static_cast<size_t>(channel.bypassPosition)];
+        std::swap(slot, samples[i]);
+
+        if (++channel.bypassPosition == latency)
+            channel.bypassPosition = 0;
+    }
+}
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    LinearPhaseCut.h
+    The "straight line" LowCut/HighCut: a linear phase brickwall FIR, run
+    through uniformly partitioned overlap-save convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// samples per partition. the convolver works a partition behind, so this is part of the latency
+constexpr int linearPhasePartitionSize = 256;
+
+// how many partitions the FIR spans at a sample rate, about 170 ms worth so the transition band stays
+// around 30 Hz wide whatever the rate. the FIR is one sample shorter than the partitions, odd and symmetric
+int getLinearPhaseNumPartitions(double sampleRate) noexcept;
+int getLinearPhaseFirLength(double sampleRate) noexcept;
+
+// the FIR's group delay plus the partition the convolver buffers
+int getLinearPhaseLatency(double sampleRate) noexcept;
+
+// one designed FIR, as the spectra of its zero padded partitions. never modified once designed
+struct LinearPhaseFilter
+{
+    // every design gets a new id, so the convolver can tell when it has to crossfade
+    juce::uint64 id{ 0 };
+    int numPartitions{ 0 };
+
+    // numPartitions * (linearPhasePartitionSize + 1) complex bins
+    std::vector<std::complex<float>> spectra;
+};
+
+//==============================================================================
+/**
+    Designs the band pass between LowCut and HighCut as one windowed sinc. The
+    ideal brickwall is the difference of two ideal low passes, the Kaiser window
+    (beta 8.6, about 86 dB down in the stop band) decides how wide the transition
+    band gets for the length we can afford.
+
+    Not for the audio thread, it allocates every design.
+*/
+class LinearPhaseDesigner
+{
+public:
+    void prepare(double sampleRate);
+    bool isPreparedFor(double sampleRate) const noexcept { return sampleRate == preparedSampleRate; }
+
+    std::shared_ptr<const LinearPhaseFilter> design(float lowCutFrequency, float highCutFrequency) const;
+
+private:
+    double preparedSampleRate{ 0.0 };
+    int numPartitions{ 0 };
+    std::vector<float> window;
+    std::unique_ptr<juce::dsp::FFT> fft;
+
+    static std::atomic<juce::uint64> nextId;
+};
+
+//==============================================================================
+/**
+    Uniformly partitioned overlap-save. Every partition of input gets one forward
+    FFT into a frequency domain delay line, the delay line is multiplied with the
+    filter's partitions and summed, and one inverse FFT gives the next partition of
+    output. Each partition costs the same, however the filter was designed.
+
+    Only the newest partition's product needs the input that just arrived, so that
+    one, the forward and the inverse FFT are all that's left for the block that
+    fills a partition. The older partitions' products go into the sum a few at a
+    time on the blocks in between, in step with how much of the partition has come
+    in, so small blocks don't see the whole convolution land on one of them.
+
+    When the filter changes, the partition where it happens is computed with both
+    the old and the new filter off the same delay line and crossfaded, so the
+    output moves over without a click and is exactly the new filter's from the next
+    partition on.
+
+    All memory is allocated in prepare().
+*/
+class PartitionedConvolver
+{
+public:
+    void prepare(double sampleRate, int numChannels);
+    void reset() noexcept;
+
+    // runs one channel in place. previous is the filter the current one replaced, if the set still holds it
+    void process(int channel, float* samples, int numSamples,
+                 const LinearPhaseFilter& filter, const LinearPhaseFilter* previous) noexcept;
+
+    // clears the convolution history but leaves the bypass delays running
+    void resetConvolution() noexcept;
+
+    // for identical channels: hands one channel's whole history to another, and checks whether two agree
+    void copyChannel(int source, int destination) noexcept;
+    bool channelsMatch(int a, int b, float tolerance) const noexcept;
+
+    // delays a channel that skips the filter (a bypassed LFE) by the same latency, so it stays lined up with the rest
+    void delay(int channel, float* samples, int numSamples) noexcept;
+
+    int getLatency() const noexcept { return latency; }
+
+private:
+    // one filter's sum for the next partition of output, numTerms of the older partitions in so far
+    struct Accumulation
+    {
+        std::vector<std::complex<float>> sum;
+        juce::uint64 filterId{ 0 };
+        int numTerms{ 0 };
+    };
+
+    struct Channel
+    {
+        // the last two partitions of input, the older one first
+        std::vector<float> input;
+        std::vector<float> output;
+
+        // numPartitions spectra of past input windows, newest at head
+        std::vector<std::complex<float>> delayLine;
+        int head{ 0 };
+        int position{ 0 };
+
+        // the filter the channel is running, and the one it fades to at the end of this partition if it changed.
+        // an id of 0 is no filter
+        Accumulation running, incoming;
+
+        std::vector<float> bypass;
+        int bypassPosition{ 0 };
+    };
+
+    const LinearPhaseFilter& followFilter(Channel& channel, const LinearPhaseFilter& filter, const LinearPhaseFilter* previous) noexcept;
+    void accumulate(const Channel& channel, Accumulation& accumulation, const LinearPhaseFilter& filter, int start) noexcept;
+    void processPartition(Channel& channel, const LinearPhaseFilter& running, const LinearPhaseFilter& filter) noexcept;
+    void finish(Accumulation& accumulation, const LinearPhaseFilter& filter, const std::complex<float>* newest, float* destination) noexcept;
+
+    int numPartitions{ 0 };
+    int latency{ 0 };
+
+    std::vector<Channel> channels;
+    std::unique_ptr<juce::dsp::FFT> fft;
+
+    // shared scratch, twice the FFT size as juce::dsp::FFT wants it
+    std::vector<float> fftBuffer;
+    std::vector<float> fadeBuffer;
+};
@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    ParameterState.cpp
+    The plugin's saved state: every parameter's value in a small, versioned
+    binary block.
+
+  ==============================================================================
+*/
+
+#include "ParameterState.h"
+
+namespace
+{
+    void writeUInt16(char* destination, juce::uint16 value) noexcept
+    {
+        value = juce::ByteOrder::swapIfBigEndian(value);
+        std::memcpy(destination, &value, sizeof(value));
+    }
+
+    void writeUInt32(char* destination, juce::uint32 value) noexcept
+    {
+        value = juce::ByteOrder::swapIfBigEndian(value);
+        std::memcpy(destination, &value, sizeof(value));
+    }
+
+    void writeFloat(char* destination, float value) noexcept
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeUInt32(destination, bits);
+    }
+
+    float readFloat(const char* source) noexcept
+    {
+        auto bits = juce::ByteOrder::littleEndianInt(source);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+ParameterState::ParameterState(juce::AudioProcessorValueTreeState& apvts)
+{
+    for (auto* parameter : apvts.processor.getParameters())
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+        {
+            auto parameterID = ranged->getParameterID();
+            entries.push_back({ getKey(parameterID), ranged, apvts.getRawParameterValue(parameterID) });
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+
+    // two ids with the same key would share a record, rename one of them
+    jassert(std::adjacent_find(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.key == b.key; }) == entries.end());
+}
+
+juce::uint32 ParameterState::getKey(const juce::String& parameterID) noexcept
+{
+    // FNV-1a over the utf-8 bytes, fixed forever: it's what old sessions are looked up by
+    juce::uint32 hash = 2166136261u;
+
+    for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+    {
+        hash ^= static_cast<juce::uint8>(*c);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+void ParameterState::save(juce::MemoryBlock& destination) const
+{
+    destination.setSize(static_cast<size_t>(headerSize + recordSize * static_cast<int>(entries.size())), false);
+    auto* data = static_cast<char*>(destination.getData());
+
+    writeUInt32(data, magic);
+    writeUInt16(data + 4, version);
+    writeUInt16(data + 6, static_cast<juce::uint16>(headerSize));
+    writeUInt16(data + 8, static_cast<juce::uint16>(recordSize));
+    writeUInt16(data + 10, 0);
+    writeUInt32(data + 12, static_cast<juce::uint32>(entries.size()));
+
+    auto* record = data + headerSize;
+
+    for (auto& entry : entries)
+    {
+        writeUInt32(record, entry.key);
+        writeFloat(record + 4, entry.value->load());
+        record += recordSize;
+    }
+}
+
+bool ParameterState::restore(const void* data, int sizeInBytes) const
+{
+    if (data == nullptr || sizeInBytes < headerSize)
+        return false;
+
+    auto* bytes = static_cast<const char*>(data);
+
+    if (juce::ByteOrder::littleEndianInt(bytes) != magic)
+        return false;
+
+    auto blockHeaderSize = static_cast<int>(juce::ByteOrder::littleEndianShort(bytes + 6));
+    auto blockRecordSize = static_cast<int>(juce::ByteOrder::littleEndianShort(bytes + 8));
+    auto numRecords = static_cast<juce::int64>(juce::ByteOrder::littleEndianInt(bytes + 12));
+
+    if (blockHeaderSize < headerSize || blockRecordSize < recordSize
+        || blockHeaderSize + numRecords * blockRecordSize > static_cast<juce::int64>(sizeInBytes))
+    {
+        jassertfalse; // ours, but cut short or damaged
+        return false;
+    }
+
+    // everything starts out at its default, then the records go on top
+    constexpr auto notRestored = -1.0f;
+    std::vector<float> normalisedValues(entries.size(), notRestored);
+
+    auto* record = bytes + blockHeaderSize;
+
+    for (juce::int64 i = 0; i < numRecords; ++i, record += blockRecordSize)
+    {
+        auto key = juce::ByteOrder::littleEndianInt(record);
+        auto entry = std::lower_bound(entries.begin(), entries.end(), key, [](const Entry& e, juce::uint32 k) { return e.key < k; });
+
+        if (entry == entries.end() || entry->key != key)
+            continue;
+
+        auto value = readFloat(record + 4);
+
+        if (std::isfinite(value))
+            normalisedValues[static_cast<size_t>(entry - entries.begin())] = entry->parameter->convertTo0to1(value);
+    }
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        auto* parameter = entries[i].parameter;
+        auto normalisedValue = normalisedValues[i] == notRestored ? parameter->getDefaultValue() : normalisedValues[i];
+
+        // the host only hears about the ones that really moved
+        if (normalisedValue != parameter->getValue())
+            parameter->setValueNotifyingHost(normalisedValue);
+    }
+
+    return true;
+}
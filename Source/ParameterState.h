@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    ParameterState.h
+    The plugin's saved state: every parameter's value in a small, versioned
+    binary block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Saves and restores the parameters as a block of a few hundred bytes, with
+    no xml to write or parse on the way, so a project with hundreds of
+    instances loads quickly.
+
+    The block, all little endian:
+
+        uint32  magic, "CEQS"
+        uint16  version
+        uint16  header size in bytes, the records start here
+        uint16  record size in bytes
+        uint16  unused, 0
+        uint32  number of records
+
+    then one record per parameter:
+
+        uint32  key, FNV-1a of the parameter id
+        float   value in the parameter's own units (Hz, dB, a choice's index)
+
+    A parameter is found by its key rather than its position, and its value is
+    stored unnormalised, so adding, removing, reordering or re-ranging
+    parameters keeps old sessions loading. Each way round:
+
+    - an older block with no record for a parameter restores it to its default
+    - a newer block's records for parameters this build doesn't have are skipped
+    - a newer block with a longer header or longer records is read up to what
+      this build knows and the rest skipped, so later versions can only append
+
+    Anything that changes what the existing fields mean needs a new magic.
+
+    Message thread, the same as getStateInformation() and setStateInformation().
+*/
+class ParameterState
+{
+public:
+    explicit ParameterState(juce::AudioProcessorValueTreeState& apvts);
+
+    void save(juce::MemoryBlock& destination) const;
+
+    // false if the data isn't a block this can read, the parameters are left alone then
+    bool restore(const void* data, int sizeInBytes) const;
+
+    static juce::uint32 getKey(const juce::String& parameterID) noexcept;
+
+    static constexpr juce::uint32 magic = 0x53514543;   // "CEQS" read as little endian
+    static constexpr juce::uint16 version = 1;
+    static constexpr int headerSize = 16;
+    static constexpr int recordSize = 8;
+
+private:
+    struct Entry
+    {
+        juce::uint32 key{ 0 };
+        juce::RangedAudioParameter* parameter{ nullptr };
+        std::atomic<float>* value{ nullptr };
+    };
+
+    // sorted by key, so a restore finds each record with a binary search instead of by string
+    std::vector<Entry> entries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterState)
+};
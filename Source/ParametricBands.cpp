@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    ParametricBands.cpp
+    The parametric bands after the fused chain: coefficients and filter memory
+    as structure of arrays, with only the active bands in the processing list.
+
+  ==============================================================================
+*/
+
+#include "ParametricBands.h"
+
+namespace
+{
+    BiquadCoefficients makeBandBiquad(const BandSettings& band, double sampleRate)
+    {
+        using Coefficients = juce::dsp::IIR::ArrayCoefficients<double>;
+        auto gain = juce::Decibels::decibelsToGain(static_cast<double>(band.gainInDecibels));
+
+        switch (band.type)
+        {
+        case BandPeak:      return Coefficients::makePeakFilter(sampleRate, band.freq, band.quality, gain);
+        case BandLowShelf:  return Coefficients::makeLowShelf(sampleRate, band.freq, band.quality, gain);
+        case BandHighShelf: return Coefficients::makeHighShelf(sampleRate, band.freq, band.quality, gain);
+        case BandNotch:     return Coefficients::makeNotch(sampleRate, band.freq, band.quality);
+        case BandLowCut:    return Coefficients::makeHighPass(sampleRate, band.freq, band.quality);
+        case BandHighCut:   return Coefficients::makeLowPass(sampleRate, band.freq, band.quality);
+        case BandOff:       break;
+        }
+
+        jassertfalse; // Off bands never get designed
+        return { 1.0, 0.0, 0.0, 1.0, 0.0, 0.0 };
+    }
+}
+
+PreciseBiquadSection BandCoefficients::getSection(int slot) const noexcept
+{
+    auto index = static_cast<size_t>(slot);
+    return { b0[index], b1[index], b2[index], a1[index], a2[index] };
+}
+
+bool isBandActive(const BandSettings& band) noexcept
+{
+    switch (band.type)
+    {
+    case BandOff:
+        return false;
+
+    case BandPeak:
+    case BandLowShelf:
+    case BandHighShelf:
+        return band.gainInDecibels != 0.0f;
+
+    case BandNotch:
+    case BandLowCut:
+    case BandHighCut:
+        return true;
+    }
+
+    return false;
+}
+
+BandCoefficients makeBandCoefficients(const std::array<BandSettings, maxBands>& bands, double sampleRate)
+{
+    BandCoefficients coefficients;
+
+    auto addSlot = [&coefficients, sampleRate](const BandSettings& settings, int band)
+    {
+        auto section = makePreciseBiquadSection(makeBandBiquad(settings, sampleRate));
+        auto slot = static_cast<size_t>(coefficients.numActive + coefficients.numDormant);
+
+        coefficients.bandIndex[slot] = band;
+        coefficients.b0[slot] = section.b0;
+        coefficients.b1[slot] = section.b1;
+        coefficients.b2[slot] = section.b2;
+        coefficients.a1[slot] = section.a1;
+        coefficients.a2[slot] = section.a2;
+    };
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        if (isBandActive(bands[static_cast<size_t>(band)]))
+        {
+            addSlot(bands[static_cast<size_t>(band)], band);
+            ++coefficients.numActive;
+            coefficients.activeMask |= 1u << band;
+        }
+    }
+
+    // at 0 dB the numerator is the denominator, a pass through whose poles still let old memory ring out
+    for (int band = 0; band < maxBands; ++band)
+    {
+        const auto& settings = bands[static_cast<size_t>(band)];
+
+        if (settings.type != BandOff && ! isBandActive(settings))
+        {
+            addSlot(settings, band);
+            ++coefficients.numDormant;
+            coefficients.dormantMask |= 1u << band;
+        }
+    }
+
+    return coefficients;
+}
+
+int getTailLengthSamples(const BandCoefficients& coefficients, float decayDecibels) noexcept
+{
+    jassert(decayDecibels > 0.0f);
+    auto logThreshold = -static_cast<double>(decayDecibels) * std::log(10.0) / 20.0;
+
+    // the same sum of section decay times the chain's tail uses
+    auto tail = 0.0;
+
+    for (int slot = 0; slot < coefficients.numActive; ++slot)
+    {
+        auto radius = juce::jlimit(0.0, 1.0 - 1.0e-9, getPoleRadius(coefficients.getSection(slot)));
+        tail += radius <= 0.0 ? 2.0 : 2.0 + logThreshold / std::log(radius);
+    }
+
+    return static_cast<int>(juce::jmin(std::ceil(tail), static_cast<double>(std::numeric_limits<int>::max())));
+}
+
+//==============================================================================
+void BandBank::prepare(int newNumChannels)
+{
+    numChannels = newNumChannels;
+    state1.assign(static_cast<size_t>(numChannels * maxBands), 0.0);
+    state2.assign(static_cast<size_t>(numChannels * maxBands), 0.0);
+}
+
+void BandBank::reset() noexcept
+{
+    std::fill(state1.begin(), state1.end(), 0.0);
+    std::fill(state2.begin(), state2.end(), 0.0);
+}
+
+void BandBank::resetBands(juce::uint32 mask) noexcept
+{
+    if (mask == 0)
+        return;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        for (int band = 0; band < maxBands; ++band)
+        {
+            if ((mask & (1u << band)) == 0)
+                continue;
+
+            auto index = static_cast<size_t>(channel * maxBands + band);
+            state1[index] = 0.0;
+            state2[index] = 0.0;
+        }
+    }
+}
+
+bool BandBank::channelsMatch(int first, int second, double tolerance) const noexcept
+{
+    auto a = static_cast<size_t>(first * maxBands);
+    auto b = static_cast<size_t>(second * maxBands);
+
+    for (size_t band = 0; band < static_cast<size_t>(maxBands); ++band)
+        if (std::abs(state1[a + band] - state1[b + band]) > tolerance || std::abs(state2[a + band] - state2[b + band]) > tolerance)
+            return false;
+
+    return true;
+}
+
+void BandBank::copyChannel(int source, int destination) noexcept
+{
+    auto from = static_cast<std::ptrdiff_t>(source * maxBands);
+    auto to = static_cast<std::ptrdiff_t>(destination * maxBands);
+
+    std::copy(state1.begin() + from, state1.begin() + from + maxBands, state1.begin() + to);
+    std::copy(state2.begin() + from, state2.begin() + from + maxBands, state2.begin() + to);
+}
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    ParametricBands.h
+    The parametric bands after the fused chain: coefficients and filter memory
+    as structure of arrays, with only the active bands in the processing list.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "CascadeKernel.h"
+
+static_assert(maxBands <= 32, "the active mask has a bit per band");
+
+// the active bands' sections, normalised and packed to the front in band order. one array per coefficient,
+// so the list is a handful of contiguous rows however many bands there are
+struct BandCoefficients
+{
+    int numActive{ 0 };
+
+    // peaks and shelves sitting at 0 dB, in the slots after the active ones. they pass everything through
+    // untouched, but one that only just got there still has memory from the gain it had, see BandBank
+    int numDormant{ 0 };
+
+    // bit i for band i, and which band each slot of the arrays below is
+    juce::uint32 activeMask{ 0 }, dormantMask{ 0 };
+    std::array<int, maxBands> bandIndex{};
+
+    std::array<double, maxBands> b0{}, b1{}, b2{}, a1{}, a2{};
+
+    PreciseBiquadSection getSection(int slot) const noexcept;
+};
+
+// Off bands, and peaks and shelves at 0 dB, pass everything through untouched and get left out
+bool isBandActive(const BandSettings& band) noexcept;
+
+BandCoefficients makeBandCoefficients(const std::array<BandSettings, maxBands>& bands, double sampleRate);
+
+// how many samples the active bands keep ringing until they are decayDecibels below where they started
+int getTailLengthSamples(const BandCoefficients& coefficients, float decayDecibels) noexcept;
+
+//==============================================================================
+/**
+    The filter memory of every band on every channel, two flat arrays sized in
+    prepare() with a row of maxBands per channel.
+
+    Memory is kept per band rather than per slot, so a band switching on or off
+    doesn't move any other band's memory to a different slot.
+
+    A peak or shelf swept through 0 dB would drop out of the list with its
+    memory still ringing and stop dead, and come back from silence. So the
+    block it leaves in, it runs once more as its dormant slot, which is the
+    same pass through plus the ringing dying away on its own poles. If it comes
+    straight back from there its memory carries on rather than being cleared.
+
+    process() runs
+    one active band over the whole block before the next one, so each band's
+    coefficients and memory stay in registers for the block and the cost is
+    one biquad per active band per sample. Bands that are off cost nothing.
+
+    The arithmetic is double for float and double blocks alike: scalar double
+    is no slower than float, and a low band at a high rate needs the bits the
+    same way the chain's mixed precision sections do.
+*/
+class BandBank
+{
+public:
+    // not on the audio thread
+    void prepare(int numChannels);
+
+    void reset() noexcept;
+
+    // clears the memory of the bands in mask on every channel, for bands that just came in
+    void resetBands(juce::uint32 mask) noexcept;
+
+    // for channels that follow another one's output, the same as the convolver's
+    bool channelsMatch(int first, int second, double tolerance) const noexcept;
+    void copyChannel(int source, int destination) noexcept;
+
+    // releasing is the bands that left the active list this block, their dormant slots run after the active ones
+    template <typename SampleType>
+    void process(const BandCoefficients& coefficients, juce::uint32 releasing, int channel, SampleType* samples, int numSamples) noexcept
+    {
+        jassert(channel >= 0 && channel < numChannels);
+
+        for (int slot = 0; slot < coefficients.numActive; ++slot)
+            processSlot(coefficients, slot, channel, samples, numSamples);
+
+        if (releasing == 0)
+            return;
+
+        for (int slot = coefficients.numActive; slot < coefficients.numActive + coefficients.numDormant; ++slot)
+            if ((releasing & (1u << coefficients.bandIndex[static_cast<size_t>(slot)])) != 0)
+                processSlot(coefficients, slot, channel, samples, numSamples);
+    }
+
+private:
+    template <typename SampleType>
+    void processSlot(const BandCoefficients& coefficients, int slot, int channel, SampleType* samples, int numSamples) noexcept
+    {
+        auto index = static_cast<size_t>(slot);
+        auto stateIndex = static_cast<size_t>(channel) * static_cast<size_t>(maxBands) + static_cast<size_t>(coefficients.bandIndex[index]);
+
+        auto b0 = coefficients.b0[index], b1 = coefficients.b1[index], b2 = coefficients.b2[index];
+        auto a1 = coefficients.a1[index], a2 = coefficients.a2[index];
+        auto s1 = state1[stateIndex], s2 = state2[stateIndex];
+
+        // transposed direct form II, same as the chain's sections
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = static_cast<double>(samples[i]);
+            auto y = b0 * x + s1;
+            s1 = b1 * x - a1 * y + s2;
+            s2 = b2 * x - a2 * y;
+            samples[i] = static_cast<SampleType>(y);
+        }
+
+        state1[stateIndex] = s1;
+        state2[stateIndex] = s2;
+    }
+
+    int numChannels{ 0 };
+    std::vector<double> state1, state2;
+};
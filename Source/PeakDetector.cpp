@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    PeakDetector.cpp
+    The sidechain of the dynamic Peak: a band-pass at the peak's frequency
+    and Q, and an envelope follower that only runs once per control interval.
+
+  ==============================================================================
+*/
+
+#include "PeakDetector.h"
+
+void PeakDetector::prepare(int numChannels, int maxBlockSize, int newControlInterval)
+{
+    jassert(numChannels >= 0 && maxBlockSize > 0 && newControlInterval > 0);
+
+    controlInterval = newControlInterval;
+    states.assign(static_cast<size_t>(numChannels), BiquadState{});
+
+    auto maxIntervals = static_cast<size_t>((maxBlockSize + controlInterval - 1) / controlInterval);
+    powers.assign(maxIntervals, 0.0f);
+    amounts.assign(maxIntervals, 0.0f);
+
+    reset();
+}
+
+void PeakDetector::reset() noexcept
+{
+    std::fill(states.begin(), states.end(), BiquadState{});
+    std::fill(amounts.begin(), amounts.end(), 0.0f);
+    envelopeDecibels = floorDecibels;
+}
+
+void PeakDetector::setBand(float g, float quality) noexcept
+{
+    // the peak's own filter at 0 dB, where k is just 1 / Q
+    bandPass = makeSVFPeakCoefficients(g, quality, 1.0f);
+    k = 1.0f / quality;
+}
+
+void PeakDetector::setTimes(double sampleRate, float newAttackMilliseconds, float newReleaseMilliseconds) noexcept
+{
+    if (sampleRate == timesSampleRate && newAttackMilliseconds == attackMilliseconds && newReleaseMilliseconds == releaseMilliseconds)
+        return;
+
+    // one step of the follower per interval, so the time constants are counted in intervals
+    auto intervalsPerMillisecond = sampleRate / (1000.0 * controlInterval);
+    auto getCoefficient = [intervalsPerMillisecond](float milliseconds)
+    {
+        return static_cast<float>(std::exp(-1.0 / juce::jmax(1.0e-3, milliseconds * intervalsPerMillisecond)));
+    };
+
+    attackCoefficient = getCoefficient(newAttackMilliseconds);
+    releaseCoefficient = getCoefficient(newReleaseMilliseconds);
+    timesSampleRate = sampleRate;
+    attackMilliseconds = newAttackMilliseconds;
+    releaseMilliseconds = newReleaseMilliseconds;
+}
+
+void PeakDetector::startBlock(int numSamples) noexcept
+{
+    jassert(numSamples >= 0 && static_cast<size_t>((numSamples + controlInterval - 1) / controlInterval) <= powers.size());
+
+    blockSize = numSamples;
+    numMeasured = 0;
+    std::fill(powers.begin(), powers.end(), 0.0f);
+}
+
+void PeakDetector::follow(float thresholdDecibels) noexcept
+{
+    for (int start = 0, interval = 0; start < blockSize; start += controlInterval, ++interval)
+    {
+        auto index = static_cast<size_t>(interval);
+        auto numSamples = juce::jmin(controlInterval, blockSize - start) * juce::jmax(1, numMeasured);
+        auto meanPower = powers[index] / static_cast<float>(numSamples);
+        auto levelDecibels = juce::jmax(floorDecibels, 10.0f * std::log10(meanPower + 1.0e-12f));
+
+        auto coefficient = levelDecibels > envelopeDecibels ? attackCoefficient : releaseCoefficient;
+        envelopeDecibels = levelDecibels + coefficient * (envelopeDecibels - levelDecibels);
+
+        amounts[index] = juce::jlimit(0.0f, 1.0f, (envelopeDecibels - thresholdDecibels) / rangeDecibels);
+    }
+}
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    PeakDetector.h
+    The sidechain of the dynamic Peak: a band-pass at the peak's frequency
+    and Q, and an envelope follower that only runs once per control interval.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CascadeKernel.h"
+
+//==============================================================================
+/**
+    Listens to the input through a band-pass at the peak's frequency and Q and
+    works out how much of "Peak Gain" the peak should apply, per control
+    interval.
+
+    The band-pass is the same state variable filter the SVF peak runs, with the
+    gain at unity, reading k * v1. Per channel and sample that's one section
+    plus a square and an add into the interval's power. Everything after that
+    happens once per interval: the mean power in decibels, the attack/release
+    follower, and the amount. The peak then gets new coefficients from that at
+    the same rate, through makeSVFPeakCoefficients(), which is a divide and a
+    few multiplies.
+
+    The channels are linked. The powers of every measured channel are summed,
+    so a stereo sibilant pulls both sides down the same.
+
+    Audio thread only after prepare(), nothing allocates.
+*/
+class PeakDetector
+{
+public:
+    // the full "Peak Gain" this far over the threshold, none at or under it, in a straight line in decibels between
+    static constexpr float rangeDecibels = 10.0f;
+
+    // not on the audio thread. room for maxBlockSize samples between startBlock() and follow()
+    void prepare(int numChannels, int maxBlockSize, int controlInterval);
+
+    // the band-pass memory and the envelope back to silence
+    void reset() noexcept;
+
+    // the band the detector listens to, g as in makeSVFPeakCoefficients()
+    void setBand(float g, float quality) noexcept;
+
+    // only worked out again when something changed, there's an exp in it
+    void setTimes(double sampleRate, float attackMilliseconds, float releaseMilliseconds) noexcept;
+
+    // measure() every channel of the block, then follow() once, then read the amounts
+    void startBlock(int numSamples) noexcept;
+
+    template <typename SampleType>
+    void measure(int channel, const SampleType* samples) noexcept
+    {
+        jassert(channel >= 0 && static_cast<size_t>(channel) < states.size());
+
+        auto& state = states[static_cast<size_t>(channel)];
+        auto s1 = state.s1, s2 = state.s2;
+
+        for (int start = 0, interval = 0; start < blockSize; start += controlInterval, ++interval)
+        {
+            auto end = juce::jmin(blockSize, start + controlInterval);
+            auto power = 0.0f;
+
+            for (int i = start; i < end; ++i)
+            {
+                auto x = static_cast<float>(samples[i]);
+                auto v3 = x - s2;
+                auto v1 = bandPass.a1 * s1 + bandPass.a2 * v3;
+                auto v2 = s2 + bandPass.a2 * s1 + bandPass.a3 * v3;
+                s1 = v1 + v1 - s1;
+                s2 = v2 + v2 - s2;
+
+                auto y = k * v1;
+                power += y * y;
+            }
+
+            powers[static_cast<size_t>(interval)] += power;
+        }
+
+        state.s1 = s1;
+        state.s2 = s2;
+        ++numMeasured;
+    }
+
+    // runs the follower over the intervals measured since startBlock()
+    void follow(float thresholdDecibels) noexcept;
+
+    // 0 to 1, how far towards "Peak Gain" the peak goes in interval n of the block
+    float getAmount(int interval) const noexcept { return amounts[static_cast<size_t>(interval)]; }
+
+private:
+    static constexpr float floorDecibels = -120.0f;
+
+    std::vector<BiquadState> states;
+    std::vector<float> powers, amounts;
+
+    SVFPeakCoefficients bandPass;
+    float k{ 1.0f };
+
+    int controlInterval{ 1 };
+    int blockSize{ 0 };
+    int numMeasured{ 0 };
+
+    float envelopeDecibels{ floorDecibels };
+    float attackCoefficient{ 0.0f }, releaseCoefficient{ 0.0f };
+    double timesSampleRate{ 0.0 };
+    float attackMilliseconds{ -1.0f }, releaseMilliseconds{ -1.0f };
+};
@@ -0,0 +1,288 @@
+/*
+  ==============================================================================
+
+    PerformanceTelemetry.cpp
+    What processBlock() costs, counted by the audio thread without waiting on
+    anything, and an optional writer that dumps it to a file for monitoring.
+
+  ==============================================================================
+*/
+
+#include "PerformanceTelemetry.h"
+
+void PerformanceTelemetry::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    auto ticksPerSecond = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+    ticksPerSample = ticksPerSecond / sampleRate;
+    microsecondsPerTick = 1.0e6 / ticksPerSecond;
+
+    blocks = 0;
+    samples = 0;
+    overruns = 0;
+
+    for (auto& histogram : timeHistograms)
+        for (auto& bucket : histogram)
+            bucket = 0;
+
+    for (int phase = 0; phase < numPhases; ++phase)
+    {
+        totalTicks[static_cast<size_t>(phase)] = 0;
+        maxTicks[static_cast<size_t>(phase)] = 0;
+    }
+
+    for (auto& bucket : loadHistogram)
+        bucket = 0;
+
+    lastLoad = 0.0f;
+    maxLoad = 0.0f;
+
+    transitionBlocks = 0;
+    transitionSamples = 0;
+    transitionTicks = 0;
+
+    // the designer's totals carry on across runs, they only ever go up
+}
+
+void PerformanceTelemetry::recordBlock(int numSamples, juce::int64 start, juce::int64 filteringStart, juce::int64 end, bool isTransition) noexcept
+{
+    if (numSamples <= 0 || ticksPerSample <= 0.0)
+        return;
+
+    if (isTransition)
+    {
+        add(transitionBlocks, juce::uint64{ 1 });
+        add(transitionSamples, static_cast<juce::uint64>(numSamples));
+        add(transitionTicks, end - start);
+    }
+
+    recordTime(coefficientUpdate, filteringStart - start);
+    recordTime(filtering, end - filteringStart);
+
+    add(blocks, juce::uint64{ 1 });
+    add(samples, static_cast<juce::uint64>(numSamples));
+
+    auto load = static_cast<float>(static_cast<double>(end - start) / (numSamples * ticksPerSample));
+    auto bucket = juce::jlimit(0, numLoadBuckets - 1, static_cast<int>(load * (numLoadBuckets - 1)));
+    add(loadHistogram[static_cast<size_t>(bucket)], juce::uint64{ 1 });
+
+    if (load >= 1.0f)
+        add(overruns, juce::uint64{ 1 });
+
+    lastLoad.store(load, std::memory_order_relaxed);
+
+    if (load > maxLoad.load(std::memory_order_relaxed))
+        maxLoad.store(load, std::memory_order_relaxed);
+}
+
+void PerformanceTelemetry::recordTime(Phase phase, juce::int64 ticks) noexcept
+{
+    auto index = static_cast<size_t>(phase);
+    auto microseconds = static_cast<juce::uint32>(juce::jlimit(0.0, 2.0e9, static_cast<double>(ticks) * microsecondsPerTick));
+    auto bucket = microseconds == 0 ? 0 : juce::jmin(numTimeBuckets - 1, 1 + juce::findHighestSetBit(microseconds));
+
+    add(timeHistograms[index][static_cast<size_t>(bucket)], juce::uint64{ 1 });
+    add(totalTicks[index], ticks);
+
+    if (ticks > maxTicks[index].load(std::memory_order_relaxed))
+        maxTicks[index].store(ticks, std::memory_order_relaxed);
+}
+
+void PerformanceTelemetry::recordStageDesigns(const std::array<juce::uint64, numStages>& designs) noexcept
+{
+    for (size_t stage = 0; stage < designs.size(); ++stage)
+        stageDesigns[stage].store(designs[stage], std::memory_order_relaxed);
+}
+
+PerformanceTelemetry::Snapshot PerformanceTelemetry::getSnapshot() const noexcept
+{
+    Snapshot snapshot;
+    snapshot.sampleRate = sampleRate;
+    snapshot.blocks = blocks.load(std::memory_order_relaxed);
+    snapshot.samples = samples.load(std::memory_order_relaxed);
+    snapshot.overruns = overruns.load(std::memory_order_relaxed);
+
+    auto secondsPerTick = microsecondsPerTick * 1.0e-6;
+
+    for (size_t phase = 0; phase < static_cast<size_t>(numPhases); ++phase)
+    {
+        for (size_t bucket = 0; bucket < static_cast<size_t>(numTimeBuckets); ++bucket)
+            snapshot.timeHistograms[phase][bucket] = timeHistograms[phase][bucket].load(std::memory_order_relaxed);
+
+        snapshot.totalSeconds[phase] = static_cast<double>(totalTicks[phase].load(std::memory_order_relaxed)) * secondsPerTick;
+        snapshot.maxSeconds[phase] = static_cast<double>(maxTicks[phase].load(std::memory_order_relaxed)) * secondsPerTick;
+    }
+
+    for (size_t bucket = 0; bucket < static_cast<size_t>(numLoadBuckets); ++bucket)
+        snapshot.loadHistogram[bucket] = loadHistogram[bucket].load(std::memory_order_relaxed);
+
+    snapshot.lastLoad = lastLoad.load(std::memory_order_relaxed);
+    snapshot.maxLoad = maxLoad.load(std::memory_order_relaxed);
+
+    for (size_t stage = 0; stage < static_cast<size_t>(numStages); ++stage)
+        snapshot.stageDesigns[stage] = stageDesigns[stage].load(std::memory_order_relaxed);
+
+    snapshot.transitionBlocks = transitionBlocks.load(std::memory_order_relaxed);
+    snapshot.transitionSamples = transitionSamples.load(std::memory_order_relaxed);
+    snapshot.transitionSeconds = static_cast<double>(transitionTicks.load(std::memory_order_relaxed)) * secondsPerTick;
+
+    return snapshot;
+}
+
+//==============================================================================
+double PerformanceTelemetry::Snapshot::getMeanLoad() const noexcept
+{
+    if (samples == 0 || sampleRate <= 0.0)
+        return 0.0;
+
+    return (totalSeconds[coefficientUpdate] + totalSeconds[filtering]) / (static_cast<double>(samples) / sampleRate);
+}
+
+double PerformanceTelemetry::Snapshot::getTransitionLoad() const noexcept
+{
+    if (transitionSamples == 0 || sampleRate <= 0.0)
+        return 0.0;
+
+    return transitionSeconds / (static_cast<double>(transitionSamples) / sampleRate);
+}
+
+double PerformanceTelemetry::Snapshot::getSteadyStateLoad() const noexcept
+{
+    if (samples <= transitionSamples || sampleRate <= 0.0)
+        return 0.0;
+
+    auto seconds = totalSeconds[coefficientUpdate] + totalSeconds[filtering] - transitionSeconds;
+    return seconds / (static_cast<double>(samples - transitionSamples) / sampleRate);
+}
+
+double PerformanceTelemetry::Snapshot::getLoadPercentile(double percentile) const noexcept
+{
+    juce::uint64 total = 0;
+
+    for (auto count : loadHistogram)
+        total += count;
+
+    if (total == 0)
+        return 0.0;
+
+    auto rank = static_cast<juce::uint64>(std::ceil(percentile * static_cast<double>(total)));
+    juce::uint64 seen = 0;
+
+    for (size_t bucket = 0; bucket < loadHistogram.size(); ++bucket)
+    {
+        seen += loadHistogram[bucket];
+
+        // the overrun bucket has no upper edge, the worst block is the best we can say about it
+        if (seen >= rank)
+            return bucket + 1 < loadHistogram.size() ? static_cast<double>(bucket + 1) / (numLoadBuckets - 1) : maxLoad;
+    }
+
+    return maxLoad;
+}
+
+juce::var PerformanceTelemetry::Snapshot::toVar() const
+{
+    auto toArray = [](const auto& counts)
+    {
+        juce::Array<juce::var> values;
+
+        for (auto count : counts)
+            values.add(static_cast<juce::int64>(count));
+
+        return values;
+    };
+
+    const char* phaseNames[] = { "coefficientUpdate", "filtering" };
+    auto* phases = new juce::DynamicObject();
+
+    for (size_t phase = 0; phase < static_cast<size_t>(numPhases); ++phase)
+    {
+        auto* times = new juce::DynamicObject();
+        times->setProperty("totalSeconds", totalSeconds[phase]);
+        times->setProperty("maxSeconds", maxSeconds[phase]);
+        times->setProperty("histogramMicroseconds", toArray(timeHistograms[phase]));
+        phases->setProperty(phaseNames[phase], juce::var(times));
+    }
+
+    auto* stages = new juce::DynamicObject();
+    stages->setProperty("LowCut", static_cast<juce::int64>(stageDesigns[0]));
+    stages->setProperty("Peak", static_cast<juce::int64>(stageDesigns[1]));
+    stages->setProperty("HighCut", static_cast<juce::int64>(stageDesigns[2]));
+
+    auto* transitions = new juce::DynamicObject();
+    transitions->setProperty("blocks", static_cast<juce::int64>(transitionBlocks));
+    transitions->setProperty("samples", static_cast<juce::int64>(transitionSamples));
+    transitions->setProperty("seconds", transitionSeconds);
+    transitions->setProperty("load", getTransitionLoad());
+
+    auto* object = new juce::DynamicObject();
+    object->setProperty("sampleRate", sampleRate);
+    object->setProperty("blocks", static_cast<juce::int64>(blocks));
+    object->setProperty("samples", static_cast<juce::int64>(samples));
+    object->setProperty("overruns", static_cast<juce::int64>(overruns));
+    object->setProperty("meanLoad", getMeanLoad());
+    object->setProperty("steadyStateLoad", getSteadyStateLoad());
+    object->setProperty("p99Load", getLoadPercentile(0.99));
+    object->setProperty("lastLoad", lastLoad);
+    object->setProperty("maxLoad", maxLoad);
+    object->setProperty("loadHistogram", toArray(loadHistogram));
+    object->setProperty("phases", juce::var(phases));
+    object->setProperty("stageDesigns", juce::var(stages));
+    object->setProperty("transitions", juce::var(transitions));
+    return juce::var(object);
+}
+
+//==============================================================================
+TelemetryExporter::TelemetryExporter(const PerformanceTelemetry& telemetryToExport, std::function<juce::var()> describe)
+    : telemetry(telemetryToExport), describeInstance(std::move(describe))
+{
+    auto directory = juce::SystemStats::getEnvironmentVariable("CUSTOMEQ_TELEMETRY_DIR", {});
+
+    if (directory.isEmpty() || ! juce::File::isAbsolutePath(directory) || ! juce::File(directory).createDirectory())
+        return;
+
+    intervalMs = juce::jmax(100, juce::SystemStats::getEnvironmentVariable("CUSTOMEQ_TELEMETRY_INTERVAL", "5000").getIntValue());
+
+    instanceId = juce::String::toHexString(juce::Random::getSystemRandom().nextInt64());
+    file = juce::File(directory).getChildFile("CustomEQ-" + instanceId + ".json");
+
+    exportThread = std::make_unique<juce::SharedResourcePointer<SharedExportThread>>();
+    (*exportThread)->addTimeSliceClient(this, intervalMs);
+}
+
+TelemetryExporter::~TelemetryExporter()
+{
+    if (exportThread == nullptr)
+        return;
+
+    // blocks until a write that's under way has finished
+    (*exportThread)->removeTimeSliceClient(this);
+    file.deleteFile();
+}
+
+int TelemetryExporter::useTimeSlice()
+{
+    write();
+    return intervalMs;
+}
+
+void TelemetryExporter::write()
+{
+    auto* object = new juce::DynamicObject();
+    object->setProperty("instance", instanceId);
+    object->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+    object->setProperty("machine", juce::SystemStats::getComputerName());
+    object->setProperty("host", juce::File::getSpecialLocation(juce::File::hostApplicationPath).getFileName());
+
+    if (describeInstance != nullptr)
+        object->setProperty("settings", describeInstance());
+
+    object->setProperty("telemetry", telemetry.getSnapshot().toVar());
+
+    // written next to the target and moved over it, so the file is always either the last write or this one
+    juce::TemporaryFile temporary(file);
+
+    if (temporary.getFile().replaceWithText(juce::JSON::toString(juce::var(object))))
+        temporary.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    PerformanceTelemetry.h
+    What processBlock() costs, counted by the audio thread without waiting on
+    anything, and an optional writer that dumps it to a file for monitoring.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Per instance counters for the audio callback, written by the audio thread
+    and read from anywhere.
+
+    Each block is timed in two phases: the coefficient update at the top of the
+    block (picking up a new set, switching kernels, paths or precision) and the
+    filtering after it. Both go into histograms with power of two buckets in
+    microseconds. What the whole block took as a share of the time it lasts in
+    real time goes into a histogram of its own, at 1 or over the host would have
+    had to wait for us.
+
+    Blocks that ran a slope crossfade are counted apart as well. They do more
+    work than any other block, and the load without them is what a session
+    that isn't switching slopes really costs.
+
+    The audio thread is the only writer, so recording is a relaxed load and store
+    per counter, no read-modify-write and no lock. A reader gets every counter
+    whole, but a snapshot taken while audio runs can be a block ahead in one
+    counter and a block behind in another.
+*/
+class PerformanceTelemetry
+{
+public:
+    enum Phase
+    {
+        coefficientUpdate,
+        filtering,
+        numPhases
+    };
+
+    // LowCut, Peak, HighCut, the order of the processor's ChainPositions
+    static constexpr int numStages = 3;
+
+    // bucket 0 is under 1 us, bucket n is [2^(n-1), 2^n) us, the last one takes everything longer
+    static constexpr int numTimeBuckets = 24;
+
+    // 5% of the deadline each, the last one is 100% and over
+    static constexpr int numLoadBuckets = 21;
+
+    // not on the audio thread. clears everything, the counts are per prepared run
+    void prepare(double sampleRate);
+
+    // audio thread: juce::Time::getHighResolutionTicks() at the start of the block, when the filtering started and at the end.
+    // isTransition for a block that ran the old cut configuration next to the new one
+    void recordBlock(int numSamples, juce::int64 start, juce::int64 filteringStart, juce::int64 end, bool isTransition = false) noexcept;
+
+    // audio thread: the designer's running totals from the set that just got picked up
+    void recordStageDesigns(const std::array<juce::uint64, numStages>& designs) noexcept;
+
+    struct Snapshot
+    {
+        double sampleRate{ 0.0 };
+        juce::uint64 blocks{ 0 }, samples{ 0 }, overruns{ 0 };
+
+        std::array<std::array<juce::uint64, numTimeBuckets>, numPhases> timeHistograms{};
+        std::array<double, numPhases> totalSeconds{}, maxSeconds{};
+
+        std::array<juce::uint64, numLoadBuckets> loadHistogram{};
+        float lastLoad{ 0.0f }, maxLoad{ 0.0f };
+
+        std::array<juce::uint64, numStages> stageDesigns{};
+
+        // the share of blocks, samples and callback time that went to crossfading cut configurations
+        juce::uint64 transitionBlocks{ 0 }, transitionSamples{ 0 };
+        double transitionSeconds{ 0.0 };
+
+        // all the time spent in the callback over all the audio it produced, what a host's meter would show
+        double getMeanLoad() const noexcept;
+
+        // the same for the blocks with a crossfade, and for all the others
+        double getTransitionLoad() const noexcept;
+        double getSteadyStateLoad() const noexcept;
+
+        // the upper edge of the load bucket the percentile falls into, 0.99 for the p99
+        double getLoadPercentile(double percentile) const noexcept;
+
+        juce::var toVar() const;
+    };
+
+    Snapshot getSnapshot() const noexcept;
+
+private:
+    void recordTime(Phase phase, juce::int64 ticks) noexcept;
+
+    template <typename Type>
+    static void add(std::atomic<Type>& counter, Type amount) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    double sampleRate{ 0.0 };
+    double ticksPerSample{ 0.0 };
+    double microsecondsPerTick{ 0.0 };
+
+    std::atomic<juce::uint64> blocks{ 0 }, samples{ 0 }, overruns{ 0 };
+
+    std::array<std::array<std::atomic<juce::uint64>, numTimeBuckets>, numPhases> timeHistograms{};
+    std::array<std::atomic<juce::int64>, numPhases> totalTicks{}, maxTicks{};
+
+    std::array<std::atomic<juce::uint64>, numLoadBuckets> loadHistogram{};
+    std::atomic<float> lastLoad{ 0.0f }, maxLoad{ 0.0f };
+
+    std::array<std::atomic<juce::uint64>, numStages> stageDesigns{};
+
+    std::atomic<juce::uint64> transitionBlocks{ 0 }, transitionSamples{ 0 };
+    std::atomic<juce::int64> transitionTicks{ 0 };
+};
+
+//==============================================================================
+/**
+    Writes an instance's telemetry as json every few seconds, for collecting it
+    across a whole fleet of machines.
+
+    Off unless the CUSTOMEQ_TELEMETRY_DIR environment variable names a directory.
+    Every instance gets its own file in there, named after a random id, and each
+    write replaces it in one move so a collector never reads half a file. A tmpfs
+    directory like /dev/shm keeps it all in memory. CUSTOMEQ_TELEMETRY_INTERVAL
+    sets the period in milliseconds, 5000 by default.
+
+    The writing happens on one low priority thread shared by every instance in the
+    process, never on the audio thread. The file goes away with the instance.
+*/
+class TelemetryExporter : private juce::TimeSliceClient
+{
+public:
+    // describeInstance adds whatever identifies the instance to the file, called on the writer thread
+    TelemetryExporter(const PerformanceTelemetry& telemetry, std::function<juce::var()> describeInstance);
+    ~TelemetryExporter() override;
+
+    bool isExporting() const noexcept { return file != juce::File(); }
+    juce::File getFile() const { return file; }
+
+private:
+    int useTimeSlice() override;
+    void write();
+
+    struct SharedExportThread : public juce::TimeSliceThread
+    {
+        SharedExportThread() : juce::TimeSliceThread("CustomEQ Telemetry") { startThread(juce::Thread::Priority::low); }
+        ~SharedExportThread() override { stopThread(2000); }
+    };
+
+    const PerformanceTelemetry& telemetry;
+    std::function<juce::var()> describeInstance;
+
+    juce::String instanceId;
+    juce::File file;
+    int intervalMs{ 5000 };
+
+    // only made when exporting, so instances that don't export never start the thread
+    std::unique_ptr<juce::SharedResourcePointer<SharedExportThread>> exportThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TelemetryExporter)
+};
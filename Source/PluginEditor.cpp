@@ -11,15 +11,46 @@
 
 //==============================================================================
 CustomEQAudioProcessorEditor::CustomEQAudioProcessorEditor (CustomEQAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), spectrumDisplay (p.getAnalyzer()), responseCurveDisplay (p)
 {
+    addAndMakeVisible(spectrumDisplay);
+    addAndMakeVisible(responseCurveDisplay);
+
+    for (auto* button : { &showPreButton, &showPostButton })
+    {
+        button->setToggleState(true, juce::dontSendNotification);
+        addAndMakeVisible(*button);
+    }
+
+    showPreButton.onClick = [this] { spectrumDisplay.setTapVisible(SpectrumAnalyzer::preEQ, showPreButton.getToggleState()); };
+    showPostButton.onClick = [this] { spectrumDisplay.setTapVisible(SpectrumAnalyzer::postEQ, showPostButton.getToggleState()); };
+
+    telemetryLabel.setFont(juce::FontOptions(12.0f));
+    telemetryLabel.setColour(juce::Label::textColourId, juce::Colours::white.withAlpha(0.6f));
+    addAndMakeVisible(telemetryLabel);
+
+    createParameterControls();
+
+    for (int band = 0; band < maxBands; ++band)
+        bandSelector.addItem("Band " + juce::String(band + 1), band + 1);
+
+    bandSelector.onChange = [this] { showBand(bandSelector.getSelectedId() - 1); };
+    bandSelector.setSelectedId(1, juce::dontSendNotification);
+    addAndMakeVisible(bandSelector);
+    showBand(0);
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setResizable(true, true);
+    setResizeLimits(640, 480, 1920, 1200);
+    setSize (900, 720);
+
+    startTimerHz(4);
 }
 
 CustomEQAudioProcessorEditor::~CustomEQAudioProcessorEditor()
 {
+    stopTimer();
 }
 
 //==============================================================================
@@ -27,14 +58,192 @@ void CustomEQAudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (juce::FontOptions (15.0f));
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
 void CustomEQAudioProcessorEditor::resized()
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
+    auto bounds = getLocalBounds().reduced(10);
+
+    auto footer = bounds.removeFromBottom(24);
+    showPostButton.setBounds(footer.removeFromRight(64));
+    showPreButton.setBounds(footer.removeFromRight(64));
+    telemetryLabel.setBounds(footer);
+    bounds.removeFromBottom(6);
+
+    layOutOptions(bounds.removeFromBottom(getOptionsHeight(bounds.getWidth())));
+    bounds.removeFromBottom(6);
+
+    layOutKnobs(bounds.removeFromBottom(120));
+    bounds.removeFromBottom(6);
+
+    layOutBand(bounds.removeFromBottom(bandRowHeight));
+    bounds.removeFromBottom(6);
+
+    spectrumDisplay.setBounds(bounds);
+    responseCurveDisplay.setBounds(bounds);
+}
+
+void CustomEQAudioProcessorEditor::timerCallback()
+{
+    auto snapshot = audioProcessor.getTelemetry().getSnapshot();
+
+    if (snapshot.blocks == 0)
+    {
+        telemetryLabel.setText("not processing", juce::dontSendNotification);
+        return;
+    }
+
+    auto toPercent = [](double load) { return juce::String(100.0 * load, 1) + "%"; };
+    auto& designs = snapshot.stageDesigns;
+
+    telemetryLabel.setText("DSP " + toPercent(snapshot.getMeanLoad()) + " mean, "
+                           + toPercent(snapshot.getLoadPercentile(0.99)) + " p99, "
+                           + toPercent(snapshot.maxLoad) + " max, "
+                           + juce::String(static_cast<juce::int64>(snapshot.overruns)) + " overruns   designs "
+                           + juce::String(static_cast<juce::int64>(designs[CustomEQAudioProcessor::LowCut])) + " / "
+                           + juce::String(static_cast<juce::int64>(designs[CustomEQAudioProcessor::Peak])) + " / "
+                           + juce::String(static_cast<juce::int64>(designs[CustomEQAudioProcessor::HighCut])),
+                           juce::dontSendNotification);
+}
+
+//==============================================================================
+void CustomEQAudioProcessorEditor::createParameterControls()
+{
+    auto& apvts = audioProcessor.apvts;
+
+    for (auto* parameter : audioProcessor.getParameters())
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+
+        if (ranged == nullptr)
+            continue;
+
+        auto parameterID = ranged->getParameterID();
+
+        ParameterControl control;
+        control.label = std::make_unique<juce::Label>(parameterID, ranged->getName(64));
+        control.label->setJustificationType(juce::Justification::centred);
+        control.label->setFont(juce::FontOptions(12.0f));
+
+        if (dynamic_cast<juce::AudioParameterChoice*>(ranged) != nullptr)
+        {
+            auto comboBox = std::make_unique<juce::ComboBox>(parameterID);
+            comboBox->addItemList(ranged->getAllValueStrings(), 1);
+            control.comboBoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, parameterID, *comboBox);
+            control.control = std::move(comboBox);
+        }
+        else if (dynamic_cast<juce::AudioParameterBool*>(ranged) != nullptr)
+        {
+            auto button = std::make_unique<juce::ToggleButton>(ranged->getName(64));
+            control.buttonAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(apvts, parameterID, *button);
+            control.control = std::move(button);
+        }
+        else
+        {
+            auto slider = std::make_unique<juce::Slider>(juce::Slider::RotaryHorizontalVerticalDrag, juce::Slider::TextBoxBelow);
+            slider->setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 18);
+            control.sliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, parameterID, *slider);
+            control.control = std::move(slider);
+        }
+
+        addAndMakeVisible(*control.label);
+        addAndMakeVisible(*control.control);
+
+        if (parameterID.startsWith("Band "))
+        {
+            auto band = parameterID.fromFirstOccurrenceOf("Band ", false, false).getIntValue() - 1;
+            jassert(band >= 0 && band < maxBands);
+
+            // the selector already says which band, "Freq" is enough
+            control.label->setText(parameterID.fromLastOccurrenceOf(" ", false, false), juce::dontSendNotification);
+            bandControls[static_cast<size_t>(juce::jlimit(0, maxBands - 1, band))].push_back(std::move(control));
+            continue;
+        }
+
+        (control.sliderAttachment != nullptr ? knobs : options).push_back(std::move(control));
+    }
+}
+
+void CustomEQAudioProcessorEditor::layOutKnobs(juce::Rectangle<int> area)
+{
+    if (knobs.empty())
+        return;
+
+    auto knobWidth = area.getWidth() / static_cast<int>(knobs.size());
+
+    for (auto& knob : knobs)
+    {
+        auto column = area.removeFromLeft(knobWidth);
+        knob.label->setBounds(column.removeFromTop(16));
+        knob.control->setBounds(column);
+    }
+}
+
+int CustomEQAudioProcessorEditor::getOptionsHeight(int width) const noexcept
+{
+    auto columns = juce::jmax(1, width / optionWidth);
+    auto rows = (static_cast<int>(options.size()) + columns - 1) / columns;
+    return rows * optionHeight;
+}
+
+void CustomEQAudioProcessorEditor::layOutOptions(juce::Rectangle<int> area)
+{
+    auto columns = juce::jmax(1, area.getWidth() / optionWidth);
+    auto columnWidth = area.getWidth() / columns;
+
+    for (size_t i = 0; i < options.size(); ++i)
+    {
+        auto column = static_cast<int>(i) % columns;
+        auto row = static_cast<int>(i) / columns;
+        juce::Rectangle<int> cell(area.getX() + column * columnWidth, area.getY() + row * optionHeight, columnWidth, optionHeight);
+        cell.reduce(4, 2);
+
+        auto& option = options[i];
+
+        // a toggle says what it is on its own
+        if (option.buttonAttachment != nullptr)
+        {
+            option.label->setVisible(false);
+            option.control->setBounds(cell.withTrimmedTop(16));
+            continue;
+        }
+
+        option.label->setBounds(cell.removeFromTop(16));
+        option.control->setBounds(cell);
+    }
+}
+
+void CustomEQAudioProcessorEditor::layOutBand(juce::Rectangle<int> area)
+{
+    auto selectorColumn = area.removeFromLeft(110);
+    bandSelector.setBounds(selectorColumn.withTrimmedTop(16).removeFromTop(24).reduced(4, 0));
+
+    // every band sits in the same place, only the selected one is visible
+    for (auto& controls : bandControls)
+    {
+        if (controls.empty())
+            continue;
+
+        auto row = area;
+        auto columnWidth = row.getWidth() / static_cast<int>(controls.size());
+
+        for (auto& control : controls)
+        {
+            auto column = row.removeFromLeft(columnWidth);
+            control.label->setBounds(column.removeFromTop(16));
+            control.control->setBounds(control.comboBoxAttachment != nullptr ? column.removeFromTop(24).reduced(4, 0) : column);
+        }
+    }
+}
+
+void CustomEQAudioProcessorEditor::showBand(int band)
+{
+    for (size_t i = 0; i < bandControls.size(); ++i)
+    {
+        for (auto& control : bandControls[i])
+        {
+            control.label->setVisible(static_cast<int>(i) == band);
+            control.control->setVisible(static_cast<int>(i) == band);
+        }
+    }
 }
@@ -10,11 +10,24 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "SpectrumDisplay.h"
+#include "ResponseCurveDisplay.h"
 
 //==============================================================================
 /**
+    The spectrum with the EQ curve over it on top, a knob for every continuous
+    parameter under it and a box or a toggle for every choice and switch below
+    those. The controls are made from the parameter layout, so a new parameter
+    shows up here without touching the editor.
+
+    The parametric bands would be a wall of knobs that way, so they share one
+    row and a selector picks which band's controls are in it.
+
+    The footer has what the telemetry says the audio callback costs, refreshed a
+    few times a second.
 */
-class CustomEQAudioProcessorEditor  : public juce::AudioProcessorEditor
+class CustomEQAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                      private juce::Timer
 {
 public:
     CustomEQAudioProcessorEditor (CustomEQAudioProcessor&);
@@ -25,9 +38,45 @@ public:
     void resized() override;
 
 private:
+    // refreshes the telemetry line
+    void timerCallback() override;
+
+    // a control with its name above it, attached to one parameter
+    struct ParameterControl
+    {
+        std::unique_ptr<juce::Label> label;
+        std::unique_ptr<juce::Component> control;
+
+        std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sliderAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> comboBoxAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> buttonAttachment;
+    };
+
+    void createParameterControls();
+    void layOutKnobs(juce::Rectangle<int> area);
+    void layOutOptions(juce::Rectangle<int> area);
+    int getOptionsHeight(int width) const noexcept;
+    void layOutBand(juce::Rectangle<int> area);
+    void showBand(int band);
+
+    static constexpr int optionWidth = 140;
+    static constexpr int optionHeight = 44;
+    static constexpr int bandRowHeight = 100;
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     CustomEQAudioProcessor& audioProcessor;
 
+    SpectrumDisplay spectrumDisplay;
+    ResponseCurveDisplay responseCurveDisplay;
+    juce::ToggleButton showPreButton{ "Pre" }, showPostButton{ "Post" };
+    juce::Label telemetryLabel;
+
+    std::vector<ParameterControl> knobs, options;
+
+    // every band's "Type", "Freq", "Gain" and "Q", only the selected band's are visible
+    std::array<std::vector<ParameterControl>, maxBands> bandControls;
+    juce::ComboBox bandSelector;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CustomEQAudioProcessorEditor)
 };
@@ -22,10 +22,12 @@ CustomEQAudioProcessor::CustomEQAudioProcessor()
                        )
 #endif
 {
+    startTimerHz(10);
 }
 
 CustomEQAudioProcessor::~CustomEQAudioProcessor()
 {
+    stopTimer();
 }
 
 //==============================================================================
@@ -63,7 +65,8 @@ bool CustomEQAudioProcessor::isMidiEffect() const
 
 double CustomEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // follows the coefficients the audio thread is using, so a steep slope near the bottom reports its full ring
+    return tailLengthSeconds.load();
 }
 
 int CustomEQAudioProcessor::getNumPrograms()
@@ -96,22 +99,76 @@ void CustomEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
-    // we must prepare our filters before we use them, we pass a ProcessesSpecObject to the chains which is passed to the link of each chain
-    juce::dsp::ProcessSpec spec; 
-    spec.maximumBlockSize = samplesPerBlock;
-
-    spec.numChannels = 1; // mono is 1 chain
-
-    spec.sampleRate = sampleRate;
+    // one chain per channel of the bus, whatever the layout is. everything that can grow gets its storage here,
+    // so the audio thread never has to allocate
+    auto numChannels = static_cast<size_t>(juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()));
+    constexpr auto numLanes = SIMDSample::SIMDNumElements;
+
+    // we must reset our filters before we use them, a stale state from the last run would ring into the first block
+    channelChains.assign(numChannels, MonoChain{});
+    laneChains.assign((numChannels + numLanes - 1) / numLanes, SIMDCascadeState{});
+    preciseChains.assign(numChannels, PreciseCascadeState{});
+    usingPreciseChains = false;
+
+    // scratch for the interleaved frames of the SIMD path, bigger blocks than this get done in pieces.
+    // room for a whole block at the highest oversampling factor
+    oversamplingBlockSize = juce::jmax(1, samplesPerBlock);
+    auto maxProcessingBlockSize = static_cast<size_t>(oversamplingBlockSize * maxOversamplingFactor);
+    frames.assign(maxProcessingBlockSize, SIMDSample{});
+
+    // a double block on a path without a double version goes through here, a host sized block at a time
+    conversionBuffer.setSize(static_cast<int>(numChannels), oversamplingBlockSize);
+
+    // the cut configuration a slope change fades out from, with memory for every chain and scratch for its output
+    transitionChains.assign(numChannels, MonoChain{});
+    preciseTransitionChains.assign(numChannels, PreciseCascadeState{});
+    transitionBuffer.setSize(static_cast<int>(numChannels), static_cast<int>(maxProcessingBlockSize));
+    preciseTransitionBuffer.setSize(static_cast<int>(numChannels), static_cast<int>(maxProcessingBlockSize));
+    cutTransition.stop();
+
+    linearPhaseConvolver.prepare(sampleRate, static_cast<int>(numChannels));
+    bandBank.prepare(static_cast<int>(numChannels));
+
+    // same for the state variable peak's coefficients
+    peakRamp.assign(maxProcessingBlockSize, SVFPeakCoefficients{});
+    peakDetector.prepare(static_cast<int>(numChannels), static_cast<int>(maxProcessingBlockSize), peakControlInterval);
+    activeTopology = static_cast<PeakTopology>(chainParameters.peakTopology->load());
+
+    for (auto factor : { Oversampling_2x, Oversampling_4x })
+    {
+        for (auto filter : { PolyphaseIIR, EquirippleFIR })
+        {
+            auto index = getOversamplerIndex(factor, filter);
+            auto filterType = filter == PolyphaseIIR ? Oversampler::filterHalfBandPolyphaseIIR : Oversampler::filterHalfBandFIREquiripple;
+
+            // the factor is given as the number of 2x stages, which is what the enum counts. integer latency,
+            // so what we report to the host is exact
+            oversamplers[index] = std::make_unique<Oversampler>(numChannels, static_cast<size_t>(factor), filterType, true, true);
+            oversamplers[index]->initProcessing(static_cast<size_t>(oversamplingBlockSize));
+            oversamplerTails[index] = measureOversamplerTail(*oversamplers[index], oversamplingBlockSize);
+        }
+    }
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    // the LFE is the one channel group you'd normally keep out of the EQ, so it's the one we let bypass
+    auto layout = getChannelLayoutOfBus(true, 0);
+    lfeChannels.clear();
 
-    // coefficient 
-    auto chainSettings = getChainSettings(apvts);
+    for (int channel = 0; channel < static_cast<int>(numChannels); ++channel)
+    {
+        auto type = layout.getTypeOfChannel(channel);
 
-    updatePeakFilter(chainSettings);
+        if (type == juce::AudioChannelSet::LFE || type == juce::AudioChannelSet::LFE2)
+            lfeChannels.push_back(channel);
+    }
 
+    // the chains were just cleared, so there's no lane memory to carry over
+    activeChannels.clear();
+    identicalChannels.clear();
+    processedChannels.clear();
+    activeChannels.reserve(numChannels);
+    identicalChannels.reserve(numChannels);
+    processedChannels.reserve(numChannels);
+    updateActiveChannels(lfeBypass->load() > 0.5f);
 
     // helper functions for IIR
     // inside the implementation
@@ -123,13 +180,63 @@ void CustomEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
 
         but we also have 96 db/oct, with that logic, the orders will have to be 2, 4, 6, and 16 for 5 choices
     */
-    updateFilter();
+    // the first set is designed right here, before the audio thread ever needs one
+    coefficientDesigner.prepare(sampleRate);
+
+    telemetry.prepare(sampleRate);
+    analyzer.prepare(sampleRate);
+    telemetry.recordStageDesigns(coefficientDesigner.getActive().stageDesigns);
+
+    const auto& cascade = coefficientDesigner.getActive().cascade;
+    const auto& settings = coefficientDesigner.getActive().settings;
+
+    activeOversampling = settings.oversampling;
+    activeOversamplingFilter = settings.oversamplingFilter;
+    activeOversampler = activeOversampling == Oversampling_1x ? nullptr
+                                                              : oversamplers[getOversamplerIndex(activeOversampling, activeOversamplingFilter)].get();
+
+    // the smoothers run at the processing rate, so they wait for the oversampling
+    resetPeakSmoothing();
+
+    tailSamples = coefficientDesigner.getActive().tailSamples + getOversamplerTail();
+    tailLengthSeconds = tailSamples / sampleRate;
+    silentSamples = 0;
+    isGated = false;
+
+    const auto& sideCascade = coefficientDesigner.getActive().sideCascade;
+
+    activeLowCutSections = cascade.numLowCutSections;
+    activeHighCutSections = cascade.numHighCutSections;
+    activeCutMode = coefficientDesigner.getActive().settings.cutMode;
+    activePrecision = cascade.precision;
+    midSideActive = shouldUseMidSide(settings);
+    activeSideLowCutSections = sideCascade.numLowCutSections;
+    activeSideHighCutSections = sideCascade.numHighCutSections;
+    activeSidePrecision = sideCascade.precision;
+    activeCutShape = getCutShape(settings);
+    activeCascade = cascade;
+    activeSideCascade = sideCascade;
+
+    if (midSideActive)
+        activeTopology = PeakTopology::Biquad;
+
+    activeBandMask = coefficientDesigner.getActive().bands.activeMask;
+    releasingBandMask = 0;
+    updateKernels();
+
+    // not on the audio thread yet, so the host can hear about the latency straight away
+    pendingLatency = getTotalLatency();
+    setLatencySamples(pendingLatency.load());
+
+    // the lanes have to agree with the scalar kernel, anything beyond rounding noise is a bug in the SIMD path
+    jassert(measureSIMDDeviation(cascade, 512) < 1.0e-4f);
 }
 
 void CustomEQAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    coefficientDesigner.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -140,11 +247,9 @@ bool CustomEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Anything from mono up to big surround and ambisonic buses works, every channel just gets its own chain,
+    // we only need the input and output to match.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -161,6 +266,7 @@ bool CustomEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 void CustomEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    auto blockStart = juce::Time::getHighResolutionTicks();
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -173,28 +279,932 @@ void CustomEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // updating parameter BEFORE audio processing
-    auto chainSettings = getChainSettings(apvts);
-    
-    updatePeakFilter(chainSettings);
-
+    blockHadTransition = false;
+    updateBlockSettings();
+    auto filteringStart = juce::Time::getHighResolutionTicks();
 
-    // we a context for the processing block to run the links in the chain
-    // we must provide an audio block for the context. we need the channels
+    analyzer.push(SpectrumAnalyzer::preEQ, buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
 
     juce::dsp::AudioBlock<float> block(buffer);
+    processChains(block);
+
+    analyzer.push(SpectrumAnalyzer::postEQ, buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
+
+    telemetry.recordBlock(buffer.getNumSamples(), blockStart, filteringStart, juce::Time::getHighResolutionTicks(), blockHadTransition);
+}
+
+void CustomEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ScopedNoDenormals noDenormals;
+    auto blockStart = juce::Time::getHighResolutionTicks();
+
+    for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
+        buffer.clear (i, 0, buffer.getNumSamples());
+
+    blockHadTransition = false;
+    updateBlockSettings();
+    auto filteringStart = juce::Time::getHighResolutionTicks();
+
+    analyzer.push(SpectrumAnalyzer::preEQ, buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
+
+    // the convolver and the oversampler only run in float, so in those modes the buffer takes a round trip through float
+    auto isPrecise = activeCutMode == CutMode::IIR && activeOversampler == nullptr;
+
+    // the double chains and the float ones never run side by side, whichever takes over starts from silence
+    if (isPrecise != usingPreciseChains)
+    {
+        forEachChain([](auto& chain) { chain.reset(); });
+        bandBank.reset();
+        cutTransition.stop();
+        usingPreciseChains = isPrecise;
+    }
+
+    if (isPrecise)
+        processPrecise(buffer);
+    else
+        processConverted(buffer);
+
+    analyzer.push(SpectrumAnalyzer::postEQ, buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
+
+    telemetry.recordBlock(buffer.getNumSamples(), blockStart, filteringStart, juce::Time::getHighResolutionTicks(), blockHadTransition);
+}
+
+bool CustomEQAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+void CustomEQAudioProcessor::updateBlockSettings()
+{
+    auto releasedBands = releasingBandMask;
+    releasingBandMask = 0;
+
+    // updating parameter BEFORE audio processing, just a pointer swap when the designer has something new
+    if (auto* latest = coefficientDesigner.acquireLatest())
+        updateFilter(*latest, releasedBands);
+
+    // a band that let its memory out and didn't come straight back starts from silence whenever it does
+    bandBank.resetBands(releasedBands & ~activeBandMask);
+
+    auto bypassLFE = lfeBypass->load() > 0.5f;
+
+    if (bypassLFE != lfeBypassed)
+        updateActiveChannels(bypassLFE);
+
+    // mixed precision sections need double memory, which the lanes don't have. Mid/Side is its own scalar kernel
+    auto path = activePrecision.isMixed() || midSideActive ? ProcessingPath::Scalar : requestedPath.load();
+
+    if (path != activePath)
+        switchProcessingPath(path);
+
+    // the dynamic peak needs new coefficients every interval, which is what the state variable filter is for.
+    // the Mid/Side kernel only has the biquad peak, so it has no dynamic one either
+    auto isDynamic = ! midSideActive && static_cast<PeakDynamics>(chainParameters.peakDynamics->load()) == PeakDynamics::DynamicPeak;
+
+    if (isDynamic != dynamicPeakActive)
+    {
+        peakDetector.reset();
+        dynamicPeakActive = isDynamic;
+    }
+
+    auto topology = midSideActive ? PeakTopology::Biquad
+                  : isDynamic ? PeakTopology::StateVariable
+                  : static_cast<PeakTopology>(chainParameters.peakTopology->load());
+
+    if (topology != activeTopology)
+        switchPeakTopology(topology);
+}
+
+void CustomEQAudioProcessor::processConverted(juce::AudioBuffer<double>& buffer)
+{
+    auto numChannels = juce::jmin(buffer.getNumChannels(), conversionBuffer.getNumChannels());
+
+    for (int start = 0; start < buffer.getNumSamples(); start += conversionBuffer.getNumSamples())
+    {
+        auto numSamples = juce::jmin(conversionBuffer.getNumSamples(), buffer.getNumSamples() - start);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* source = buffer.getReadPointer(channel, start);
+            auto* destination = conversionBuffer.getWritePointer(channel);
+
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] = static_cast<float>(source[i]);
+        }
+
+        juce::dsp::AudioBlock<float> block(conversionBuffer.getArrayOfWritePointers(), static_cast<size_t>(numChannels), 0, static_cast<size_t>(numSamples));
+        processChains(block);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* source = conversionBuffer.getReadPointer(channel);
+            auto* destination = buffer.getWritePointer(channel, start);
+
+            for (int i = 0; i < numSamples; ++i)
+                destination[i] = static_cast<double>(source[i]);
+        }
+    }
+}
+
+void CustomEQAudioProcessor::processPrecise(juce::AudioBuffer<double>& buffer)
+{
+    // one double pass per active channel, no lanes, no gate and no identical channel copies, the host asked for
+    // double because it wants every bit of it
+    const auto& cascade = coefficientDesigner.getActive().cascade;
+    const auto& sideCascade = coefficientDesigner.getActive().sideCascade;
+    const auto& bands = coefficientDesigner.getActive().bands;
+    auto numSamples = static_cast<size_t>(buffer.getNumSamples());
+
+    // the ramp and the crossfade scratch only hold a prepared block's worth
+    auto chunkSize = activeTopology == PeakTopology::StateVariable || cutTransition.isActive() ? peakRamp.size() : numSamples;
+
+    ++processedBlocks;
+
+    for (size_t start = 0; start < numSamples; start += chunkSize)
+    {
+        auto length = static_cast<int>(juce::jmin(chunkSize, numSamples - start));
+        auto offset = static_cast<int>(start);
+
+        if (dynamicPeakActive)
+            detectPeakBand(buffer, offset, length);
+
+        const auto* ramp = activeTopology == PeakTopology::StateVariable ? updatePeakRamp(length) : nullptr;
+        auto isFading = cutTransition.isActive();
+
+        if (isFading)
+            processPreciseOldCuts(buffer, offset, length, ramp);
+
+        if (midSideActive)
+        {
+            processPreciseMidSideChain(cascade, sideCascade, preciseChains[0], preciseChains[1],
+                                       buffer.getWritePointer(0, offset), buffer.getWritePointer(1, offset), length);
+        }
+        else
+        {
+            for (auto channel : activeChannels)
+                if (channel < buffer.getNumChannels())
+                    processPreciseChain(cascade, preciseChains[static_cast<size_t>(channel)], buffer.getWritePointer(channel, offset), length, ramp);
+        }
+
+        if (isFading)
+            mixPreciseCutTransition(buffer, offset, length);
+
+        for (auto channel : activeChannels)
+            if (channel < buffer.getNumChannels())
+                bandBank.process(bands, releasingBandMask, channel, buffer.getWritePointer(channel, offset), length);
+    }
+}
+
+void CustomEQAudioProcessor::processChains(juce::dsp::AudioBlock<float>& block)
+{
+    // the set stays alive until the next acquireLatest(), so we can read it in place
+    const auto& cascade = coefficientDesigner.getActive().cascade;
+
+    // only ever touch channels the buffer really has, a mono track has no channel 1
+    jassert(block.getNumChannels() >= channelChains.size());
+
+    ++processedBlocks;
+
+    // before the gate, a bypassed LFE keeps playing while everything else is silent
+    if (activeCutMode == CutMode::LinearPhase)
+        delayBypassedChannels(block);
+
+    if (! isInputSilent(block))
+    {
+        // the memory is all zeros while gated, so picking up again is exactly what a cleared chain would do
+        silentSamples = 0;
+        isGated = false;
+    }
+    else if (isGated)
+    {
+        // silence in, silence out, and it's already sitting in the buffer
+        ++gatedBlocks;
+        return;
+    }
+    else
+    {
+        silentSamples += static_cast<int>(block.getNumSamples());
+    }
+
+    // dual mono only needs one pass, the copies get the first channel's output afterwards
+    updateIdenticalChannels(block);
+
+    if (activeOversampler != nullptr)
+        processOversampled(block, cascade);
+    else
+        processIIR(block, cascade);
+
+    if (activeCutMode == CutMode::LinearPhase)
+        processLinearPhase(block);
+
+    copyIdenticalChannels(block);
+
+    if (! identicalChannels.empty())
+        ++identicalChannelBlocks;
+
+    // whatever is left ringing is more than tailDecayDecibels down, clear it rather than grinding through denormal territory
+    if (silentSamples > tailSamples)
+    {
+        resetChains();
+        isGated = true;
+    }
+}
+
+bool CustomEQAudioProcessor::isInputSilent(const juce::dsp::AudioBlock<float>& block) const noexcept
+{
+    auto numSamples = block.getNumSamples();
+
+    // only real digital silence counts, so the output doesn't change by a single bit when the gate is used.
+    // music bails out on the first sample
+    auto isSilent = [&block, numSamples](int channel)
+    {
+        if (static_cast<size_t>(channel) >= block.getNumChannels())
+            return true;
+
+        const auto* samples = block.getChannelPointer(static_cast<size_t>(channel));
+
+        for (size_t i = 0; i < numSamples; ++i)
+            if (samples[i] != 0.0f)
+                return false;
+
+        return true;
+    };
+
+    for (auto channel : activeChannels)
+        if (! isSilent(channel))
+            return false;
+
+    // a bypassed LFE still goes through the oversampler for its latency, so it has to be silent too before we skip it
+    if (activeOversampler != nullptr && lfeBypassed)
+        for (auto channel : lfeChannels)
+            if (! isSilent(channel))
+                return false;
+
+    return true;
+}
+
+void CustomEQAudioProcessor::resetChains() noexcept
+{
+    forEachChain([](auto& chain) { chain.reset(); });
+    bandBank.reset();
+    peakDetector.reset();
+    cutTransition.stop();
+
+    linearPhaseConvolver.resetConvolution();
+
+    if (activeOversampler != nullptr)
+        activeOversampler->reset();
+}
+
+void CustomEQAudioProcessor::processIIR(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade)
+{
+    if (activeTopology != PeakTopology::StateVariable)
+    {
+        processFilters(block, cascade, nullptr);
+        return;
+    }
+
+    // the ramp only holds a prepared block's worth, anything bigger goes in pieces
+    for (size_t start = 0; start < block.getNumSamples(); start += peakRamp.size())
+    {
+        auto numSamples = juce::jmin(peakRamp.size(), block.getNumSamples() - start);
+        auto subBlock = block.getSubBlock(start, numSamples);
+
+        if (dynamicPeakActive)
+            detectPeakBand(subBlock);
+
+        processFilters(subBlock, cascade, updatePeakRamp(static_cast<int>(numSamples)));
+    }
+}
+
+void CustomEQAudioProcessor::processOversampled(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade)
+{
+    // the oversampler only takes as much as it was prepared for at a time
+    for (size_t start = 0; start < block.getNumSamples(); start += static_cast<size_t>(oversamplingBlockSize))
+    {
+        auto subBlock = block.getSubBlock(start, juce::jmin(static_cast<size_t>(oversamplingBlockSize), block.getNumSamples() - start));
+        auto oversampled = activeOversampler->processSamplesUp(subBlock);
+
+        processIIR(oversampled, cascade);
+
+        // the identical channels have to agree on the way back down as well, so their copies happen up here
+        copyIdenticalChannels(oversampled);
+
+        activeOversampler->processSamplesDown(subBlock);
+    }
+}
+
+void CustomEQAudioProcessor::processLinearPhase(juce::dsp::AudioBlock<float>& block)
+{
+    const auto& active = coefficientDesigner.getActive();
+    jassert(active.linearPhase != nullptr);
+
+    auto numSamples = static_cast<int>(block.getNumSamples());
+
+    for (auto channel : processedChannels)
+        if (static_cast<size_t>(channel) < block.getNumChannels())
+            linearPhaseConvolver.process(channel, block.getChannelPointer(static_cast<size_t>(channel)), numSamples,
+                                         *active.linearPhase, active.previousLinearPhase.get());
+}
+
+void CustomEQAudioProcessor::delayBypassedChannels(juce::dsp::AudioBlock<float>& block)
+{
+    if (! lfeBypassed)
+        return;
+
+    auto numSamples = static_cast<int>(block.getNumSamples());
+
+    for (auto channel : lfeChannels)
+        if (static_cast<size_t>(channel) < block.getNumChannels())
+            linearPhaseConvolver.delay(channel, block.getChannelPointer(static_cast<size_t>(channel)), numSamples);
+}
+
+void CustomEQAudioProcessor::switchCutMode(CutMode newMode)
+{
+    forEachChain([](auto& chain)
+    {
+        chain.lowCut = {};
+        chain.highCut = {};
+        chain.preciseLowCut = {};
+        chain.preciseHighCut = {};
+    });
+
+    linearPhaseConvolver.reset();
+    cutTransition.stop();
+
+    activeCutMode = newMode;
+    updateKernels();
+    reportLatency();
+}
+
+void CustomEQAudioProcessor::switchOversampling(OversamplingFactor newFactor, OversamplingFilter newFilter)
+{
+    forEachChain([](auto& chain) { chain.reset(); });
+    bandBank.reset();
+    cutTransition.stop();
+
+    activeOversampling = newFactor;
+    activeOversamplingFilter = newFilter;
+    activeOversampler = newFactor == Oversampling_1x ? nullptr : oversamplers[getOversamplerIndex(newFactor, newFilter)].get();
+
+    if (activeOversampler != nullptr)
+        activeOversampler->reset();
+
+    resetPeakSmoothing();
+    reportLatency();
+}
+
+size_t CustomEQAudioProcessor::getOversamplerIndex(OversamplingFactor factor, OversamplingFilter filter) noexcept
+{
+    jassert(factor != Oversampling_1x);
+    return static_cast<size_t>((static_cast<int>(factor) - 1) * 2 + static_cast<int>(filter));
+}
+
+int CustomEQAudioProcessor::measureOversamplerTail(Oversampler& oversampler, int blockSize)
+{
+    // an impulse up and back down, the tail ends where it's tailDecayDecibels under the impulse
+    constexpr int maxTailSamples = 1 << 15;
+    const auto threshold = std::pow(10.0f, -tailDecayDecibels / 20.0f);
+
+    juce::AudioBuffer<float> buffer(1, blockSize);
+    auto tail = 0;
+
+    for (int start = 0; start < maxTailSamples; start += blockSize)
+    {
+        buffer.clear();
+
+        if (start == 0)
+            buffer.setSample(0, 0, 1.0f);
+
+        juce::dsp::AudioBlock<float> block(buffer);
+        oversampler.processSamplesUp(block);
+        oversampler.processSamplesDown(block);
+
+        for (int i = 0; i < blockSize; ++i)
+            if (std::abs(buffer.getSample(0, i)) > threshold)
+                tail = start + i + 1;
+    }
+
+    oversampler.reset();
+    return tail;
+}
+
+int CustomEQAudioProcessor::getOversamplerTail() const noexcept
+{
+    return activeOversampler != nullptr ? oversamplerTails[getOversamplerIndex(activeOversampling, activeOversamplingFilter)] : 0;
+}
+
+double CustomEQAudioProcessor::getProcessingSampleRate() const
+{
+    return getSampleRate() * getOversamplingFactor(activeOversampling);
+}
+
+int CustomEQAudioProcessor::getTotalLatency() const noexcept
+{
+    auto latency = activeOversampler != nullptr ? juce::roundToInt(activeOversampler->getLatencyInSamples()) : 0;
+
+    if (activeCutMode == CutMode::LinearPhase)
+        latency += linearPhaseConvolver.getLatency();
+
+    return latency;
+}
+
+void CustomEQAudioProcessor::reportLatency()
+{
+    pendingLatency = getTotalLatency();
+}
+
+void CustomEQAudioProcessor::timerCallback()
+{
+    auto latency = pendingLatency.load();
+
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+void CustomEQAudioProcessor::processFilters(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade, const SVFPeakCoefficients* ramp)
+{
+    if (! cutTransition.isActive())
+    {
+        processCuts(block, cascade, ramp);
+        processBands(block);
+        return;
+    }
+
+    // the old configuration needs the input the new one is about to overwrite, so it goes through
+    // transitionBuffer a piece at a time. the bands are the same either side, they run on the mix
+    auto pieceSize = static_cast<size_t>(transitionBuffer.getNumSamples());
+
+    for (size_t start = 0; start < block.getNumSamples(); start += pieceSize)
+    {
+        auto piece = block.getSubBlock(start, juce::jmin(pieceSize, block.getNumSamples() - start));
+        const auto* pieceRamp = ramp != nullptr ? ramp + start : nullptr;
+        auto isFading = cutTransition.isActive();
+
+        if (isFading)
+            processOldCuts(piece, pieceRamp);
+
+        processCuts(piece, cascade, pieceRamp);
+
+        if (isFading)
+            mixCutTransition(piece);
+    }
+
+    processBands(block);
+}
+
+void CustomEQAudioProcessor::processCuts(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade, const SVFPeakCoefficients* ramp)
+{
+    if (midSideActive)
+        processMidSide(block, cascade);
+    else if (activePath == ProcessingPath::SIMD && block.getNumChannels() >= channelChains.size())
+        processSIMD(block, cascade, ramp);
+    else
+        processScalar(block, cascade, ramp);
+}
+
+void CustomEQAudioProcessor::processOldCuts(const juce::dsp::AudioBlock<float>& block, const SVFPeakCoefficients* ramp)
+{
+    // the old configuration always runs scalar, it only lasts for the crossfade. in Mid/Side mode the processed
+    // channels are left and right, so the copies are the same either way
+    auto numSamples = static_cast<int>(block.getNumSamples());
+
+    for (auto channel : processedChannels)
+        juce::FloatVectorOperations::copy(transitionBuffer.getWritePointer(channel), block.getChannelPointer(static_cast<size_t>(channel)), numSamples);
+
+    if (cutTransition.isMidSide)
+    {
+        cutTransition.processMidSide(cutTransition.cascade, cutTransition.sideCascade, transitionChains[0], transitionChains[1],
+                                     transitionBuffer.getWritePointer(0), transitionBuffer.getWritePointer(1), numSamples);
+        return;
+    }
+
+    for (auto channel : processedChannels)
+        cutTransition.process(cutTransition.cascade, transitionChains[static_cast<size_t>(channel)],
+                              transitionBuffer.getWritePointer(channel), numSamples, ramp);
+}
+
+void CustomEQAudioProcessor::mixCutTransition(juce::dsp::AudioBlock<float>& block)
+{
+    auto numSamples = static_cast<int>(block.getNumSamples());
+
+    for (auto channel : processedChannels)
+        crossfade(block.getChannelPointer(static_cast<size_t>(channel)), transitionBuffer.getReadPointer(channel),
+                  numSamples, cutTransition.position, cutTransition.length);
+
+    cutTransition.position = juce::jmin(cutTransition.length, cutTransition.position + numSamples);
+    blockHadTransition = true;
+}
+
+void CustomEQAudioProcessor::processPreciseOldCuts(const juce::AudioBuffer<double>& buffer, int start, int numSamples, const SVFPeakCoefficients* ramp)
+{
+    for (auto channel : activeChannels)
+        if (channel < buffer.getNumChannels())
+            std::copy_n(buffer.getReadPointer(channel, start), numSamples, preciseTransitionBuffer.getWritePointer(channel));
+
+    if (cutTransition.isMidSide)
+    {
+        cutTransition.processPreciseMidSide(cutTransition.cascade, cutTransition.sideCascade, preciseTransitionChains[0], preciseTransitionChains[1],
+                                            preciseTransitionBuffer.getWritePointer(0), preciseTransitionBuffer.getWritePointer(1), numSamples);
+        return;
+    }
+
+    for (auto channel : activeChannels)
+        if (channel < buffer.getNumChannels())
+            cutTransition.processPrecise(cutTransition.cascade, preciseTransitionChains[static_cast<size_t>(channel)],
+                                         preciseTransitionBuffer.getWritePointer(channel), numSamples, ramp);
+}
+
+void CustomEQAudioProcessor::mixPreciseCutTransition(juce::AudioBuffer<double>& buffer, int start, int numSamples)
+{
+    for (auto channel : activeChannels)
+        if (channel < buffer.getNumChannels())
+            crossfade(buffer.getWritePointer(channel, start), preciseTransitionBuffer.getReadPointer(channel),
+                      numSamples, cutTransition.position, cutTransition.length);
+
+    cutTransition.position = juce::jmin(cutTransition.length, cutTransition.position + numSamples);
+    blockHadTransition = true;
+}
+
+void CustomEQAudioProcessor::processBands(juce::dsp::AudioBlock<float>& block)
+{
+    const auto& bands = coefficientDesigner.getActive().bands;
+
+    if (bands.numActive == 0 && releasingBandMask == 0)
+        return;
+
+    auto numSamples = static_cast<int>(block.getNumSamples());
+
+    for (auto channel : processedChannels)
+        if (static_cast<size_t>(channel) < block.getNumChannels())
+            bandBank.process(bands, releasingBandMask, channel, block.getChannelPointer(static_cast<size_t>(channel)), numSamples);
+}
+
+void CustomEQAudioProcessor::processScalar(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade, const SVFPeakCoefficients* ramp)
+{
+    auto numSamples = static_cast<int>(block.getNumSamples());
+
+    for (auto channel : processedChannels)
+        if (static_cast<size_t>(channel) < block.getNumChannels())
+            processChain(cascade, channelChains[static_cast<size_t>(channel)], block.getChannelPointer(static_cast<size_t>(channel)), numSamples, ramp);
+}
+
+void CustomEQAudioProcessor::processMidSide(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade)
+{
+    jassert(block.getNumChannels() >= 2);
+
+    processMidSideChain(cascade, coefficientDesigner.getActive().sideCascade, channelChains[0], channelChains[1],
+                        block.getChannelPointer(0), block.getChannelPointer(1), static_cast<int>(block.getNumSamples()));
+}
+
+void CustomEQAudioProcessor::processSIMD(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade, const SVFPeakCoefficients* ramp)
+{
+    // every channel shares every coefficient, so a group of them can share every instruction too
+    constexpr auto numLanes = SIMDSample::SIMDNumElements;
+    auto numSamples = block.getNumSamples();
+
+    for (size_t group = 0; group * numLanes < processedChannels.size(); ++group)
+    {
+        auto numChannelsInGroup = juce::jmin(numLanes, processedChannels.size() - group * numLanes);
+
+        for (size_t start = 0; start < numSamples; start += frames.size())
+        {
+            auto numFrames = static_cast<int>(juce::jmin(frames.size(), numSamples - start));
+
+            std::array<float*, numLanes> channels{};
+            for (size_t lane = 0; lane < numChannelsInGroup; ++lane)
+                channels[lane] = block.getChannelPointer(static_cast<size_t>(processedChannels[group * numLanes + lane])) + start;
+
+            interleave(channels.data(), static_cast<int>(numChannelsInGroup), frames.data(), numFrames);
+            processLaneChain(cascade, laneChains[group], frames.data(), numFrames, ramp != nullptr ? ramp + start : nullptr);
+            deinterleave(frames.data(), channels.data(), static_cast<int>(numChannelsInGroup), numFrames);
+        }
+    }
+}
+
+void CustomEQAudioProcessor::storeLaneStates()
+{
+    constexpr auto numLanes = SIMDSample::SIMDNumElements;
+
+    for (size_t i = 0; i < processedChannels.size(); ++i)
+        copyStateFromLane(laneChains[i / numLanes], i % numLanes, channelChains[static_cast<size_t>(processedChannels[i])]);
+}
+
+void CustomEQAudioProcessor::loadLaneStates()
+{
+    constexpr auto numLanes = SIMDSample::SIMDNumElements;
+
+    for (size_t i = 0; i < processedChannels.size(); ++i)
+        copyStateToLane(channelChains[static_cast<size_t>(processedChannels[i])], laneChains[i / numLanes], i % numLanes);
+}
+
+void CustomEQAudioProcessor::switchProcessingPath(ProcessingPath newPath)
+{
+    // carry the filter memory across so the switch doesn't click
+    if (newPath == ProcessingPath::SIMD)
+        loadLaneStates();
+    else
+        storeLaneStates();
+
+    activePath = newPath;
+}
+
+void CustomEQAudioProcessor::switchPeakTopology(PeakTopology newTopology)
+{
+    forEachChain([](auto& chain)
+    {
+        chain.peak = {};
+        chain.precisePeak = {};
+    });
+
+    // no glide in from wherever the smoothers were left, the new peak starts on the parameters
+    resetPeakSmoothing();
+
+    // the old configuration's kernel still wants the old peak, stop it rather than run it on memory that's gone
+    cutTransition.stop();
+
+    activeTopology = newTopology;
+    updateKernels();
+}
+
+void CustomEQAudioProcessor::resetPeakSmoothing()
+{
+    auto sampleRate = getProcessingSampleRate();
+    auto peakFreq = chainParameters.peakFreq->load();
+    auto peakGainInDecibels = chainParameters.peakGainInDecibels->load();
+
+    for (auto* smoother : { &peakFrequency, &peakQuality, &peakAmplitude })
+        smoother->reset(sampleRate, peakSmoothingSeconds);
+
+    // approximateTan only holds up to just under nyquist
+    peakFrequency.setCurrentAndTargetValue(juce::jmin(peakFreq, static_cast<float>(sampleRate * 0.47)));
+    peakQuality.setCurrentAndTargetValue(chainParameters.peakQuality->load());
+    peakAmplitude.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(peakGainInDecibels * 0.5f));
+
+    // and the detector hears nothing from before either
+    peakDetector.reset();
+}
+
+const SVFPeakCoefficients* CustomEQAudioProcessor::updatePeakRamp(int numSamples)
+{
+    jassert(static_cast<size_t>(numSamples) <= peakRamp.size());
+
+    auto sampleRate = getProcessingSampleRate();
+    auto piOverSampleRate = static_cast<float>(juce::MathConstants<double>::pi / sampleRate);
+
+    // only the peak values it needs, not the whole of getChainSettings() for every chunk
+    auto peakFreq = chainParameters.peakFreq->load();
+    auto peakGainInDecibels = chainParameters.peakGainInDecibels->load();
+
+    peakFrequency.setTargetValue(juce::jmin(peakFreq, static_cast<float>(sampleRate * 0.47)));
+    peakQuality.setTargetValue(chainParameters.peakQuality->load());
+    peakAmplitude.setTargetValue(juce::Decibels::decibelsToGain(peakGainInDecibels * 0.5f));
+
+    auto* ramp = peakRamp.data();
+
+    // the gain is the detector's, so it changes every interval whether the knobs move or not. frequency and Q
+    // still glide, at control rate like everything else here
+    if (dynamicPeakActive)
+    {
+        for (int i = 0, interval = 0; i < numSamples; i += peakControlInterval, ++interval)
+        {
+            auto length = juce::jmin(peakControlInterval, numSamples - i);
+            auto g = approximateTan(peakFrequency.skip(length) * piOverSampleRate);
+            auto quality = peakQuality.skip(length);
+            auto amplitude = juce::Decibels::decibelsToGain(peakGainInDecibels * peakDetector.getAmount(interval) * 0.5f);
+            std::fill_n(ramp + i, length, makeSVFPeakCoefficients(g, quality, amplitude));
+        }
+
+        return ramp;
+    }
+
+    // settled, one set for the whole block
+    if (! peakFrequency.isSmoothing() && ! peakQuality.isSmoothing() && ! peakAmplitude.isSmoothing())
+    {
+        auto coefficients = makeSVFPeakCoefficients(approximateTan(peakFrequency.getTargetValue() * piOverSampleRate),
+                                                    peakQuality.getTargetValue(), peakAmplitude.getTargetValue());
+        std::fill_n(ramp, numSamples, coefficients);
+        return ramp;
+    }
+
+    auto interval = static_cast<PeakSmoothing>(chainParameters.peakSmoothing->load()) == PeakSmoothing::AudioRate ? 1 : peakControlInterval;
+
+    for (int i = 0; i < numSamples; i += interval)
+    {
+        auto length = juce::jmin(interval, numSamples - i);
+
+        // skip() would take a pow per call, getNextValue() is a single multiply
+        auto advance = [length](PeakSmoother& smoother) { return length == 1 ? smoother.getNextValue() : smoother.skip(length); };
+
+        auto g = approximateTan(advance(peakFrequency) * piOverSampleRate);
+        auto quality = advance(peakQuality);
+        auto amplitude = advance(peakAmplitude);
+        std::fill_n(ramp + i, length, makeSVFPeakCoefficients(g, quality, amplitude));
+    }
+
+    return ramp;
+}
+
+void CustomEQAudioProcessor::startPeakDetection(int numSamples)
+{
+    // the band the peak will be at by the end of its glide, the band-pass doesn't mind jumping
+    auto sampleRate = getProcessingSampleRate();
+    auto frequency = juce::jmin(chainParameters.peakFreq->load(), static_cast<float>(sampleRate * 0.47));
+
+    peakDetector.setBand(approximateTan(frequency * static_cast<float>(juce::MathConstants<double>::pi / sampleRate)),
+                         chainParameters.peakQuality->load());
+    peakDetector.setTimes(sampleRate, chainParameters.peakAttackMilliseconds->load(), chainParameters.peakReleaseMilliseconds->load());
+    peakDetector.startBlock(numSamples);
+}
+
+void CustomEQAudioProcessor::detectPeakBand(const juce::dsp::AudioBlock<float>& block)
+{
+    startPeakDetection(static_cast<int>(block.getNumSamples()));
+
+    for (auto channel : processedChannels)
+        if (static_cast<size_t>(channel) < block.getNumChannels())
+            peakDetector.measure(channel, block.getChannelPointer(static_cast<size_t>(channel)));
+
+    peakDetector.follow(chainParameters.peakThresholdInDecibels->load());
+}
+
+void CustomEQAudioProcessor::detectPeakBand(const juce::AudioBuffer<double>& buffer, int start, int numSamples)
+{
+    startPeakDetection(numSamples);
+
+    for (auto channel : activeChannels)
+        if (channel < buffer.getNumChannels())
+            peakDetector.measure(channel, buffer.getReadPointer(channel, start));
+
+    peakDetector.follow(chainParameters.peakThresholdInDecibels->load());
+}
+
+void CustomEQAudioProcessor::updateActiveChannels(bool bypassLFE)
+{
+    // the lanes are assigned by position in processedChannels, so park their memory in the per channel chains while the list changes
+    if (activePath == ProcessingPath::SIMD)
+        storeLaneStates();
+
+    releaseIdenticalChannels();
+    activeChannels.clear();
+
+    for (int channel = 0; channel < static_cast<int>(channelChains.size()); ++channel)
+    {
+        auto isLFE = std::find(lfeChannels.begin(), lfeChannels.end(), channel) != lfeChannels.end();
+
+        if (isLFE && bypassLFE)
+            continue;
 
-    updateFilter();
+        // an LFE coming back in has been passing audio through untouched, its memory is meaningless
+        if (isLFE)
+        {
+            channelChains[static_cast<size_t>(channel)].reset();
+            preciseChains[static_cast<size_t>(channel)].reset();
+            transitionChains[static_cast<size_t>(channel)].reset();
+            preciseTransitionChains[static_cast<size_t>(channel)].reset();
+        }
+
+        activeChannels.push_back(channel);
+    }
+
+    rebuildProcessedChannels();
+
+    if (activePath == ProcessingPath::SIMD)
+        loadLaneStates();
+
+    lfeBypassed = bypassLFE;
+}
 
+void CustomEQAudioProcessor::updateIdenticalChannels(const juce::dsp::AudioBlock<float>& block)
+{
+    // identical left and right is a silent side, which still runs through its own cascade
+    if (activeChannels.size() < 2 || midSideActive)
+        return;
+
+    // a short block can't be compared channel for channel, so everyone goes back to their own pass
+    if (block.getNumChannels() < channelChains.size())
+    {
+        if (! identicalChannels.empty())
+        {
+            if (activePath == ProcessingPath::SIMD)
+                storeLaneStates();
+
+            releaseIdenticalChannels();
+            rebuildProcessedChannels();
+
+            if (activePath == ProcessingPath::SIMD)
+                loadLaneStates();
+        }
+
+        return;
+    }
+
+    auto numBytes = block.getNumSamples() * sizeof(float);
+    const auto* firstChannel = block.getChannelPointer(static_cast<size_t>(activeChannels[0]));
+
+    auto isIdentical = [&](int channel)
+    {
+        return std::memcmp(block.getChannelPointer(static_cast<size_t>(channel)), firstChannel, numBytes) == 0;
+    };
+
+    auto isFollowing = [this](int channel)
+    {
+        return std::find(identicalChannels.begin(), identicalChannels.end(), channel) != identicalChannels.end();
+    };
+
+    // the common case, nothing changed since the last block. memcmp bails out on the first different sample
+    auto anyChange = false;
+
+    for (size_t i = 1; i < activeChannels.size() && ! anyChange; ++i)
+        anyChange = isIdentical(activeChannels[i]) != isFollowing(activeChannels[i]);
+
+    if (! anyChange)
+        return;
+
+    // the memory has to be in channelChains to compare it and to hand it over
+    if (activePath == ProcessingPath::SIMD)
+        storeLaneStates();
+
+    auto first = activeChannels[0];
+    const auto& firstChain = channelChains[static_cast<size_t>(first)];
+
+    // anything closer than this is far below the float noise of the audio itself, so we just snap it
+    constexpr auto stateTolerance = 1.0e-6f;
+
+    for (size_t i = 1; i < activeChannels.size(); ++i)
+    {
+        auto channel = activeChannels[i];
+        auto& chain = channelChains[static_cast<size_t>(channel)];
+        auto wasFollowing = isFollowing(channel);
+
+        if (isIdentical(channel))
+        {
+            // the convolver remembers a lot further back than the IIR sections, it has to agree as well
+            auto historyMatches = (activeCutMode == CutMode::IIR || linearPhaseConvolver.channelsMatch(first, channel, stateTolerance))
+                                && bandBank.channelsMatch(first, channel, stateTolerance);
+
+            if (! wasFollowing && statesMatch(chain, firstChain, stateTolerance) && historyMatches)
+            {
+                chain = firstChain;
+                transitionChains[static_cast<size_t>(channel)] = transitionChains[static_cast<size_t>(first)];
+                linearPhaseConvolver.copyChannel(first, channel);
+                bandBank.copyChannel(first, channel);
+                identicalChannels.push_back(channel);
+            }
+        }
+        else if (wasFollowing)
+        {
+            // its memory has been the first channel's all along, pick up from exactly there so the split doesn't click
+            chain = firstChain;
+            transitionChains[static_cast<size_t>(channel)] = transitionChains[static_cast<size_t>(first)];
+            linearPhaseConvolver.copyChannel(first, channel);
+            bandBank.copyChannel(first, channel);
+            identicalChannels.erase(std::find(identicalChannels.begin(), identicalChannels.end(), channel));
+        }
+    }
+
+    rebuildProcessedChannels();
+
+    if (activePath == ProcessingPath::SIMD)
+        loadLaneStates();
+}
+
+void CustomEQAudioProcessor::releaseIdenticalChannels()
+{
+    // expects the lane memory to be parked in channelChains already
+    if (! activeChannels.empty())
+    {
+        for (auto channel : identicalChannels)
+        {
+            channelChains[static_cast<size_t>(channel)] = channelChains[static_cast<size_t>(activeChannels[0])];
+            transitionChains[static_cast<size_t>(channel)] = transitionChains[static_cast<size_t>(activeChannels[0])];
+            linearPhaseConvolver.copyChannel(activeChannels[0], channel);
+            bandBank.copyChannel(activeChannels[0], channel);
+        }
+    }
+
+    identicalChannels.clear();
+}
+
+void CustomEQAudioProcessor::rebuildProcessedChannels()
+{
+    processedChannels.clear();
+
+    for (auto channel : activeChannels)
+        if (std::find(identicalChannels.begin(), identicalChannels.end(), channel) == identicalChannels.end())
+            processedChannels.push_back(channel);
+}
+
+void CustomEQAudioProcessor::copyIdenticalChannels(juce::dsp::AudioBlock<float>& block)
+{
+    if (identicalChannels.empty())
+        return;
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    const auto* firstChannel = block.getChannelPointer(static_cast<size_t>(activeChannels[0]));
+    auto numSamples = static_cast<int>(block.getNumSamples());
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-    
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    for (auto channel : identicalChannels)
+        juce::FloatVectorOperations::copy(block.getChannelPointer(static_cast<size_t>(channel)), firstChannel, numSamples);
 }
 
 //==============================================================================
@@ -205,113 +1215,257 @@ bool CustomEQAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* CustomEQAudioProcessor::createEditor()
 {
-    //return new CustomEQAudioProcessorEditor (*this);
-    return new juce::GenericAudioProcessorEditor(*this);
+    return new CustomEQAudioProcessorEditor (*this);
+}
+
+juce::var CustomEQAudioProcessor::describeForTelemetry() const
+{
+    // only plain values and the parameter atomics, this runs on the exporter's thread
+    auto chainSettings = getChainSettings(chainParameters);
+
+    auto* object = new juce::DynamicObject();
+    object->setProperty("sampleRate", getSampleRate());
+    object->setProperty("blockSize", getBlockSize());
+    object->setProperty("channels", getTotalNumInputChannels());
+    object->setProperty("latency", pendingLatency.load());
+    object->setProperty("lowCutSlope", getOrderForSlope(chainSettings.lowCutSlope) * 6);
+    object->setProperty("highCutSlope", getOrderForSlope(chainSettings.highCutSlope) * 6);
+    object->setProperty("cutMode", chainSettings.cutMode == CutMode::LinearPhase ? "Linear Phase" : "IIR");
+    object->setProperty("oversampling", getOversamplingFactor(chainSettings.oversampling));
+    object->setProperty("peakDynamics", chainSettings.peakDynamics == PeakDynamics::DynamicPeak ? "Dynamic" : "Static");
+    object->setProperty("cutCrossfade", cutCrossfade->load());
+    object->setProperty("stereoMode", chainSettings.stereoMode == StereoMode::MidSide ? "Mid/Side" : "Left/Right");
+    object->setProperty("activeBands", static_cast<int>(std::count_if(chainSettings.bands.begin(), chainSettings.bands.end(), isBandActive)));
+    return juce::var(object);
 }
 
 //==============================================================================
 void CustomEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
     // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // straight from the parameter atomics, no tree or xml in between
+    parameterState.save(destData);
 }
 
 void CustomEQAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
+
+    // the designer waits until every parameter is in, so a restore is one design pass rather than one per parameter
+    const CoefficientDesigner::ScopedParameterBatch batch(coefficientDesigner);
+
+    if (parameterState.restore(data, sizeInBytes))
+        return;
+
+    // not ours, but it might be the parameter tree as xml the way JUCE's examples save it
+    if (auto xml = getXmlFromBinary(data, sizeInBytes); xml != nullptr && xml->hasTagName(apvts.state.getType().toString()))
+        apvts.replaceState(juce::ValueTree::fromXml(*xml));
 }
 
-// getting params
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+void CustomEQAudioProcessor::updateFilter(const ChainCoefficients& chainCoefficients, juce::uint32 releasedBands)
 {
-    ChainSettings settings;
+    const auto& cascade = chainCoefficients.cascade;
 
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load(); // units in range we care about, when we get it
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load(); 
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load(); 
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load(); 
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load(); 
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
-    
-    return settings;
-}
+    const auto& settings = chainCoefficients.settings;
 
-void CustomEQAudioProcessor::updateCoefficients(Coefficients& old, const Coefficients& replacements) {
-    *old = *replacements;
-}
+    telemetry.recordStageDesigns(chainCoefficients.stageDesigns);
 
+    // any of these clears every chain anyway, there's nothing left of the old configuration to fade out from
+    auto clearsChains = settings.cutMode != activeCutMode || settings.oversampling != activeOversampling
+                     || settings.oversamplingFilter != activeOversamplingFilter || shouldUseMidSide(settings) != midSideActive;
 
-int CustomEQAudioProcessor::getOrderForSlope(Slope slope) const
-{
-    switch (slope)
+    if (settings.cutMode != activeCutMode)
+        switchCutMode(settings.cutMode);
+
+    if (settings.oversampling != activeOversampling || settings.oversamplingFilter != activeOversamplingFilter)
+        switchOversampling(settings.oversampling, settings.oversamplingFilter);
+
+    tailSamples = chainCoefficients.tailSamples + getOversamplerTail();
+    tailLengthSeconds = tailSamples * chainCoefficients.oversamplingFactor / chainCoefficients.sampleRate;
+
+    const auto& sideCascade = chainCoefficients.sideCascade;
+    auto useMidSide = shouldUseMidSide(settings);
+    auto stereoModeChanged = useMidSide != midSideActive;
+
+    if (stereoModeChanged)
+        switchStereoMode(useMidSide);
+
+    // has to be before the precision switches, the old configuration keeps the memory layout it had
+    auto shape = getCutShape(settings);
+
+    if (shape != activeCutShape && ! clearsChains && activeCutMode == CutMode::IIR)
+        startCutTransition();
+
+    activeCutShape = shape;
+
+    if (cascade.precision != activePrecision)
+        switchSectionPrecision(cascade.precision);
+
+    if (sideCascade.precision != activeSidePrecision)
+        switchSidePrecision(sideCascade.precision);
+
+    // a band that just came in has nothing sensible in its memory, start it from silence. one coming straight back
+    // through 0 dB ran last block, its memory carries on
+    const auto& bands = chainCoefficients.bands;
+    bandBank.resetBands(bands.activeMask & ~activeBandMask & ~releasedBands);
+
+    // one that went to 0 dB rings out through its dormant slot for this block rather than stopping dead
+    releasingBandMask = activeBandMask & ~bands.activeMask & bands.dormantMask;
+    activeBandMask = bands.activeMask;
+
+    activeCascade = cascade;
+    activeSideCascade = sideCascade;
+
+    auto sectionsChanged = cascade.numLowCutSections != activeLowCutSections || cascade.numHighCutSections != activeHighCutSections
+                        || sideCascade.numLowCutSections != activeSideLowCutSections || sideCascade.numHighCutSections != activeSideHighCutSections;
+
+    if (! sectionsChanged && ! stereoModeChanged)
+        return;
+
+    if (midSideActive)
     {
-    case Slope_12: return 2;
-    case Slope_24: return 4;
-    case Slope_36: return 6;
-    case Slope_48: return 8;
-    case Slope_96: return 16;
+        auto updatePath = [](auto& chain, int oldLowCut, int newLowCut, int oldHighCut, int newHighCut)
+        {
+            updateMidSideCutFilter(chain.lowCut, oldLowCut, newLowCut);
+            updateMidSideCutFilter(chain.highCut, oldHighCut, newHighCut);
+            updateMidSideCutFilter(chain.preciseLowCut, oldLowCut, newLowCut);
+            updateMidSideCutFilter(chain.preciseHighCut, oldHighCut, newHighCut);
+        };
+
+        updatePath(channelChains[0], activeLowCutSections, cascade.numLowCutSections, activeHighCutSections, cascade.numHighCutSections);
+        updatePath(preciseChains[0], activeLowCutSections, cascade.numLowCutSections, activeHighCutSections, cascade.numHighCutSections);
+        updatePath(channelChains[1], activeSideLowCutSections, sideCascade.numLowCutSections, activeSideHighCutSections, sideCascade.numHighCutSections);
+        updatePath(preciseChains[1], activeSideLowCutSections, sideCascade.numLowCutSections, activeSideHighCutSections, sideCascade.numHighCutSections);
     }
-    jassertfalse; // unexpected slope
-    return 2;
+    else
+    {
+        forEachChain([this, &cascade](auto& chain)
+        {
+            updateCutFilter(chain.lowCut, activeLowCutSections, cascade.numLowCutSections);
+            updateCutFilter(chain.highCut, activeHighCutSections, cascade.numHighCutSections);
+            updateCutFilter(chain.preciseLowCut, activeLowCutSections, cascade.numLowCutSections);
+            updateCutFilter(chain.preciseHighCut, activeHighCutSections, cascade.numHighCutSections);
+        });
+    }
+
+    activeLowCutSections = cascade.numLowCutSections;
+    activeHighCutSections = cascade.numHighCutSections;
+    activeSideLowCutSections = sideCascade.numLowCutSections;
+    activeSideHighCutSections = sideCascade.numHighCutSections;
+    updateKernels();
 }
 
-void CustomEQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+CustomEQAudioProcessor::CutShape CustomEQAudioProcessor::getCutShape(const ChainSettings& settings) noexcept
 {
-    int lowOrder = getOrderForSlope(chainSettings.lowCutSlope);
+    // the side's slopes only shape anything while Mid/Side is on
+    CutShape shape;
+    shape.lowCut = settings.lowCutSlope;
+    shape.highCut = settings.highCutSlope;
+    shape.filterType = settings.cutFilterType;
+
+    if (settings.stereoMode == StereoMode::MidSide)
+    {
+        shape.sideLowCut = settings.sideLowCutSlope;
+        shape.sideHighCut = settings.sideHighCutSlope;
+    }
 
-    auto cutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(
-        chainSettings.lowCutFreq,
-        getSampleRate(),
-        lowOrder
-    ); // 0, 1, 2 ,3, 4? and double it to get us 2 4 6 8, and 10? should be 16
+    return shape;
+}
+
+void CustomEQAudioProcessor::startCutTransition()
+{
+    // a fade already running is cut short, the new one starts from whatever is playing now
+    auto length = juce::roundToInt(cutCrossfade->load() * 0.001 * getProcessingSampleRate());
 
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+    if (length <= 0)
+    {
+        cutTransition.stop();
+        return;
+    }
 
-    updateCutFilter(leftLowCut, cutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, cutCoefficients, chainSettings.lowCutSlope);
+    // the lanes hold the live memory on the SIMD path
+    if (activePath == ProcessingPath::SIMD)
+        storeLaneStates();
+
+    // same sizes as the live chains, so these are copies into storage prepareToPlay already made
+    std::copy(channelChains.begin(), channelChains.end(), transitionChains.begin());
+    std::copy(preciseChains.begin(), preciseChains.end(), preciseTransitionChains.begin());
+
+    cutTransition.cascade = activeCascade;
+    cutTransition.sideCascade = activeSideCascade;
+    cutTransition.process = processChain;
+    cutTransition.processPrecise = processPreciseChain;
+    cutTransition.processMidSide = processMidSideChain;
+    cutTransition.processPreciseMidSide = processPreciseMidSideChain;
+    cutTransition.isMidSide = midSideActive;
+    cutTransition.position = 0;
+    cutTransition.length = length;
 }
 
-void CustomEQAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+bool CustomEQAudioProcessor::shouldUseMidSide(const ChainSettings& settings) const noexcept
 {
-    // high cut, same thing
-    int highOrder = getOrderForSlope(chainSettings.highCutSlope);
+    // the linear phase convolver runs the same cuts on left and right, there's no side for it to have
+    return settings.stereoMode == StereoMode::MidSide && settings.cutMode == CutMode::IIR && channelChains.size() == 2;
+}
 
-    auto highCutCoefficients = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(
-        chainSettings.highCutFreq,
-        getSampleRate(),
-        highOrder
-    );
+void CustomEQAudioProcessor::switchStereoMode(bool shouldUseMidSide)
+{
+    // the bands stay on left and right either way, so they keep their memory. the lanes are about to be cleared,
+    // there's nothing in them to park first
+    releaseIdenticalChannels();
+    rebuildProcessedChannels();
+
+    forEachChain([](auto& chain) { chain.reset(); });
+    cutTransition.stop();
+    midSideActive = shouldUseMidSide;
+}
 
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+void CustomEQAudioProcessor::switchSidePrecision(SectionPrecision newPrecision)
+{
+    // the side only has memory of its own while Mid/Side is running, and then it's never in the lanes
+    if (midSideActive)
+        changeSectionPrecision(channelChains[1], activeSidePrecision, newPrecision);
 
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+    activeSidePrecision = newPrecision;
 }
 
-void CustomEQAudioProcessor::updateFilter()
+void CustomEQAudioProcessor::updateKernels()
 {
-    auto chainSettings = getChainSettings(apvts);
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+    // the larger count of each cut, the path with fewer runs identity sections for the rest
+    processMidSideChain = getMidSideProcessFunction(juce::jmax(activeLowCutSections, activeSideLowCutSections),
+                                                    juce::jmax(activeHighCutSections, activeSideHighCutSections));
+    processPreciseMidSideChain = getPreciseMidSideProcessFunction(juce::jmax(activeLowCutSections, activeSideLowCutSections),
+                                                                  juce::jmax(activeHighCutSections, activeSideHighCutSections));
+
+    if (activeCutMode == CutMode::LinearPhase)
+    {
+        processChain = getPeakProcessFunction(activeTopology);
+        processLaneChain = getSIMDPeakProcessFunction(activeTopology);
+        processPreciseChain = getPrecisePeakProcessFunction(activeTopology);
+        return;
+    }
+
+    processChain = getCascadeProcessFunction(activeLowCutSections, activeHighCutSections, activeTopology);
+    processLaneChain = getSIMDCascadeProcessFunction(activeLowCutSections, activeHighCutSections, activeTopology);
+    processPreciseChain = getPreciseCascadeProcessFunction(activeLowCutSections, activeHighCutSections, activeTopology);
 }
 
-void CustomEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings) 
+void CustomEQAudioProcessor::switchSectionPrecision(SectionPrecision newPrecision)
 {
-    auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        getSampleRate(),
-        chainSettings.peakFreq,
-        chainSettings.peakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    // the lanes don't have double memory, so what's in them goes through the per channel chains
+    if (activePath == ProcessingPath::SIMD)
+        storeLaneStates();
+
+    // in Mid/Side mode channel 1's chain is the side's, which goes by activeSidePrecision
+    for (size_t channel = 0; channel < channelChains.size(); ++channel)
+        if (! (midSideActive && channel == 1))
+            changeSectionPrecision(channelChains[channel], activePrecision, newPrecision);
+
+    if (activePath == ProcessingPath::SIMD)
+        loadLaneStates();
 
-    // setting coefficients 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    activePrecision = newPrecision;
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout
@@ -381,6 +1535,77 @@ juce::AudioProcessorValueTreeState::ParameterLayout
     layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", stringArray, 0));
     layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
 
+    // table lookups while sweeping, the exact design is swapped back in once the knob stops
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Coefficient Mode", "Coefficient Mode", juce::StringArray{ "Exact", "Table" }, 0));
+
+    // on surround buses, keep the EQ off the LFE channel(s)
+    layout.add(std::make_unique<juce::AudioParameterBool>("LFE Bypass", "LFE Bypass", false));
+
+    // the state variable peak glides with "Peak Freq", "Peak Gain" and "Peak Quality" instead of jumping each time a new design lands
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Peak Topology", "Peak Topology", juce::StringArray{ "Biquad", "SVF" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Peak Smoothing", "Peak Smoothing", juce::StringArray{ "Control Rate", "Audio Rate" }, 0));
+
+    // a dynamic Peak only goes towards "Peak Gain" while its band is over the threshold, all the way there
+    // PeakDetector::rangeDecibels over it. cut for de-essing and taming resonances, boost to bring a band up when it's there
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Peak Dynamics", "Peak Dynamics", juce::StringArray{ "Static", "Dynamic" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Threshold", "Peak Threshold",
+                                                           juce::NormalisableRange<float>(-60.f, 0.f, 0.5f, 1.f), -24.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Attack", "Peak Attack",
+                                                           juce::NormalisableRange<float>(0.1f, 100.f, 0.1f, 0.4f), 5.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Release", "Peak Release",
+                                                           juce::NormalisableRange<float>(5.f, 1000.f, 1.f, 0.4f), 120.f));
+
+    // the "straight line" cut: LowCut and HighCut as one linear phase brickwall, at the price of some latency
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Cut Mode", "Cut Mode", juce::StringArray{ "IIR", "Linear Phase" }, 0));
+
+    // steeper knees for the IIR cuts, each type matches the slope's attenuation an octave out with as few sections as it can
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Cut Filter Type", "Cut Filter Type",
+                                                            juce::StringArray{ "Butterworth", "Chebyshev I", "Chebyshev II", "Elliptic" }, 0));
+
+    // a slope or filter type change fades from the old cuts to the new ones over this long, 0 swaps them straight away
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Cut Crossfade", "Cut Crossfade",
+                                                           juce::NormalisableRange<float>(0.f, 100.f, 1.f, 1.f), 20.f));
+
+    // the IIR chain at 2x or 4x, so a Peak or HighCut up near nyquist keeps the shape it would have in analog
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling", juce::StringArray{ "Off", "2x", "4x" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling Filter", "Oversampling Filter",
+                                                            juce::StringArray{ "Minimum Phase", "Linear Phase" }, 0));
+
+    // "Mixed" keeps the memory of sections with poles right up against the unit circle in double, low cutoffs at high rates
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Precision", "Precision", juce::StringArray{ "Float", "Mixed" }, 1));
+
+    // mid and side through their own cuts and peak on a stereo bus. the main ones are the mid's, the side's
+    // start out the same so flipping the mode changes nothing until a side knob moves
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Stereo Mode", "Stereo Mode", juce::StringArray{ "Left/Right", "Mid/Side" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Side LowCut Freq", "Side LowCut Freq",
+                                                           juce::NormalisableRange<float>(10.f, 20000.f, 1.f, 1.f), 20.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Side HighCut Freq", "Side HighCut Freq",
+                                                           juce::NormalisableRange<float>(10.f, 20000.f, 1.f, 1.f), 20000.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Side Peak Freq", "Side Peak Freq",
+                                                           juce::NormalisableRange<float>(10.f, 20000.f, 1.f, 0.25f), 750.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Side Peak Gain", "Side Peak Gain",
+                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Side Peak Quality", "Side Peak Quality",
+                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Side LowCut Slope", "Side LowCut Slope", stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Side HighCut Slope", "Side HighCut Slope", stringArray, 0));
+
+    // the parametric bands after the chain, all Off to start with so they cost nothing until one gets switched on.
+    // the default frequencies are spread from 30 Hz to 15 kHz, so switching a few on starts somewhere sensible
+    for (int band = 0; band < maxBands; ++band)
+    {
+        auto defaultFreq = std::round(30.f * std::pow(2.f, 9.f * static_cast<float>(band) / static_cast<float>(juce::jmax(1, maxBands - 1))));
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(getBandParameterID(band, "Type"), getBandParameterID(band, "Type"),
+                                                                juce::StringArray{ "Off", "Peak", "Low Shelf", "High Shelf", "Notch", "Low Cut", "High Cut" }, 0));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getBandParameterID(band, "Freq"), getBandParameterID(band, "Freq"),
+                                                               juce::NormalisableRange<float>(10.f, 20000.f, 1.f, 0.25f), defaultFreq));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getBandParameterID(band, "Gain"), getBandParameterID(band, "Gain"),
+                                                               juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getBandParameterID(band, "Q"), getBandParameterID(band, "Q"),
+                                                               juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 0.7f));
+    }
+
 
     return layout;
 }
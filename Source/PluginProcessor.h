@@ -9,31 +9,18 @@
 #pragma once
 
 #include <JuceHeader.h>
-
-// Defining and extracting our parameters from the tree states
-enum Slope 
-{
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48,
-    Slope_96
-};
-
-struct ChainSettings 
-{
-    float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
-    float lowCutFreq{ 0 }, highCutFreq{ 0 };
-    Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
-};
-
-// help func to give us our parameters values
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+#include "ChainSettings.h"
+#include "CoefficientDesigner.h"
+#include "ParameterState.h"
+#include "PeakDetector.h"
+#include "PerformanceTelemetry.h"
+#include "SpectrumAnalyzer.h"
 
 //==============================================================================
 /**
 */
-class CustomEQAudioProcessor  : public juce::AudioProcessor
+class CustomEQAudioProcessor  : public juce::AudioProcessor,
+                                private juce::Timer
 {
 public:
     //==============================================================================
@@ -49,6 +36,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // a double host gets the IIR chain in double all the way through, everything else is converted around the float path
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -77,18 +68,33 @@ public:
         createParameterLayout();
     juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Parameters", createParameterLayout()};
 
-private:
-    // so much of the audio is mono, but we are making a stereo VST, this is how we are going to fix that
-    using Filter = juce::dsp::IIR::Filter<float>; 
+    // how far the "Table" coefficient mode is from the exact designs, measured in prepareToPlay
+    CoefficientTables::Accuracy getCoefficientTableAccuracy() const noexcept { return coefficientDesigner.getTableAccuracy(); }
+
+    // which kernel runs the channels, Scalar is one pass per channel, SIMD runs groups of channels side by side in the lanes of one register.
+    // both give the same output within float rounding, the switch happens at the start of the next block
+    enum class ProcessingPath
+    {
+        Scalar,
+        SIMD
+    };
+
+    void setProcessingPath(ProcessingPath newPath) noexcept { requestedPath = newPath; }
+    ProcessingPath getProcessingPath() const noexcept { return requestedPath; }
 
-    using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter, Filter, Filter, Filter, Filter>; // basically how we are doing 12, 24, 36, etc. is we are just chaining the same filter over and over again
+    // how many blocks went through the chain, and in how many of them at least one channel was
+    // a bit identical copy of the first (dual mono) and got the first channel's output instead of its own pass
+    struct IdenticalChannelStatistics
+    {
+        juce::uint64 blocks{ 0 }, fastPathBlocks{ 0 };
+    };
 
-    // chain for mono 
-    using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+    IdenticalChannelStatistics getIdenticalChannelStatistics() const noexcept { return { processedBlocks.load(), identicalChannelBlocks.load() }; }
 
-    // need 2 mono chains for stereo
-    MonoChain leftChain, rightChain;
+    // blocks that skipped the filters entirely because the input was silent and the tail had run out
+    juce::uint64 getGatedBlockCount() const noexcept { return gatedBlocks.load(); }
 
+    // the stages of the chain, in the order the kernel runs them and the telemetry counts their designs
     enum ChainPositions
     {
         LowCut,
@@ -96,67 +102,316 @@ private:
         HighCut
     };
 
+    // block times, deadline use and coefficient designs per stage, safe to read from the editor at any time
+    const PerformanceTelemetry& getTelemetry() const noexcept { return telemetry; }
+
+    // the pre and post EQ spectra, the editor starts it while it's open
+    SpectrumAnalyzer& getAnalyzer() noexcept { return analyzer; }
+
+    // the newest coefficients for drawing the response, see CoefficientDesigner::getPublished()
+    bool getPublishedCascade(PublishedCascade& destination, juce::uint32& lastSerial) const { return coefficientDesigner.getPublished(destination, lastSerial); }
+
+private:
+    // must be declared after apvts so the pointers are looked up once the tree exists
+    ChainParameters chainParameters { apvts };
+
+    // all the coefficient design happens on its thread, we only ever swap in what it finished
+    CoefficientDesigner coefficientDesigner { chainParameters };
+
+    // what getStateInformation() writes, the parameters as a few hundred bytes of binary
+    ParameterState parameterState { apvts };
+
+    // so much of the audio is mono, but we also run on surround and ambisonic buses, so every channel gets its own chain.
+    // chain for mono is just its filter memory, the kernel runs LowCut -> Peak -> HighCut in one pass over it
+    using MonoChain = CascadeState;
+
+    // one mono chain per channel of the bus, sized in prepareToPlay. the coefficients are shared by all of them
+    std::vector<MonoChain> channelChains;
+
+    // or the same channels in groups, channel processedChannels[group * lanes + n] in lane n of laneChains[group]
+    std::vector<SIMDCascadeState> laneChains;
+    std::vector<SIMDSample> frames;
+
+    // the chains a double precision host runs through, and the float buffer the paths without a double version go through
+    std::vector<PreciseCascadeState> preciseChains;
+    PreciseCascadeProcessFunction processPreciseChain{ nullptr };
+    juce::AudioBuffer<float> conversionBuffer;
+    bool usingPreciseChains{ false };
+
+    // which float sections carry their memory in double, the ones with poles close to the unit circle
+    SectionPrecision activePrecision;
+
+    // "Stereo Mode" on a stereo bus with the IIR cuts. channel 0's chains then hold the mid's memory and channel 1's
+    // the side's, and both go through one kernel that does the encode and decode on the way
+    bool midSideActive{ false };
+    MidSideProcessFunction processMidSideChain{ nullptr };
+    PreciseMidSideProcessFunction processPreciseMidSideChain{ nullptr };
+    int activeSideLowCutSections{ 1 }, activeSideHighCutSections{ 1 };
+    SectionPrecision activeSidePrecision;
+
+    // channels that get filtered, an LFE channel passes straight through while "LFE Bypass" is on
+    std::vector<int> activeChannels;
+    std::vector<int> lfeChannels;
+
+    // active channels whose input and memory are identical to activeChannels[0] just copy its output,
+    // the rest get their own pass through the kernel
+    std::vector<int> identicalChannels;
+    std::vector<int> processedChannels;
+    std::atomic<juce::uint64> processedBlocks{ 0 }, identicalChannelBlocks{ 0 };
+
+    // silence gating: once the input has been digital silence for longer than the cascade's tail the memory
+    // is down below the noise floor, so we clear it and skip the filters until a non zero sample shows up
+    int tailSamples{ 0 };
+    int silentSamples{ 0 };
+    bool isGated{ false };
+    std::atomic<double> tailLengthSeconds{ 0.0 };
+    std::atomic<juce::uint64> gatedBlocks{ 0 };
+
+    std::atomic<float>* lfeBypass{ apvts.getRawParameterValue("LFE Bypass") };
+    bool lfeBypassed{ false };
+
+    // the state variable peak glides its frequency, Q and amplitude towards the parameters right here on the
+    // audio thread, and peakRamp gets the kernel one set of coefficients per sample. multiplicative smoothing of
+    // the amplitude is linear in decibels, so a gain move sounds even all the way
+    using PeakSmoother = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+    PeakSmoother peakFrequency, peakQuality, peakAmplitude;
+    std::vector<SVFPeakCoefficients> peakRamp;
+    PeakTopology activeTopology{ PeakTopology::Biquad };
+
+    static constexpr double peakSmoothingSeconds = 0.02;
+
+    // at control rate the coefficients are rebuilt every this many samples, at audio rate every sample
+    static constexpr int peakControlInterval = 16;
+
+    // "Peak Dynamics": the detector measures the input before the chain runs, and updatePeakRamp() scales
+    // "Peak Gain" by what it found, one set of coefficients per control interval
+    PeakDetector peakDetector;
+    bool dynamicPeakActive{ false };
+
+    // the memory of the parametric bands for every channel, and which bands were running in the last set.
+    // releasingBandMask is the ones that went to 0 dB with this block's set, they run one more block on their memory
+    BandBank bandBank;
+    juce::uint32 activeBandMask{ 0 }, releasingBandMask{ 0 };
+
+    // the linear phase cut, one convolver channel per bus channel. switching "Cut Mode" changes the latency,
+    // which gets reported to the host from the message thread
+    PartitionedConvolver linearPhaseConvolver;
+    CutMode activeCutMode{ CutMode::IIR };
+    std::atomic<int> pendingLatency{ 0 };
+
+    // polls pendingLatency on the message thread. an AsyncUpdater would post a message from the audio
+    // thread, and on Linux that takes the message queue's lock and can allocate
+    void timerCallback() override;
+
+    // the IIR chain runs inside the oversampler at 2x or 4x, the linear phase convolver after it at the host rate.
+    // one oversampler per factor and filter type, all built in prepareToPlay so switching never allocates
+    using Oversampler = juce::dsp::Oversampling<float>;
+    static constexpr int maxOversamplingFactor = 4;
+    std::array<std::unique_ptr<Oversampler>, 4> oversamplers;
+
+    // how long each one keeps ringing after an impulse, in host samples, measured when it's built
+    std::array<int, 4> oversamplerTails{};
+
+    Oversampler* activeOversampler{ nullptr };
+    OversamplingFactor activeOversampling{ OversamplingFactor::Oversampling_1x };
+    OversamplingFilter activeOversamplingFilter{ OversamplingFilter::PolyphaseIIR };
+    int oversamplingBlockSize{ 0 };
+
+    std::atomic<ProcessingPath> requestedPath{ ProcessingPath::SIMD };
+    ProcessingPath activePath{ ProcessingPath::SIMD };
+
+    // the kernel instantiations for the current section counts, swapped when a slope or the cut filter type changes
+    CascadeProcessFunction processChain{ nullptr };
+    SIMDCascadeProcessFunction processLaneChain{ nullptr };
+    int activeLowCutSections{ 1 }, activeHighCutSections{ 1 };
 
-    void updatePeakFilter(const ChainSettings& chainSettings);
-    using Coefficients = Filter::CoefficientsPtr;
-    static void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+    // picks the kernel for the set's section counts and clears the memory of any sections that just came in.
+    // releasedBands are the ones that ran their memory out over the last block
+    void updateFilter(const ChainCoefficients& chainCoefficients, juce::uint32 releasedBands);
+    void updateKernels();
 
-    template<int Index, typename ChainType, typename CoefficientType>
-    void update(ChainType& chain, const CoefficientType& coefficients)
+    // the designer, the LFE bypass and the path and topology switches, everything that happens once at the top of a block
+    void updateBlockSettings();
+
+    // moves the memory of the sections that change precision over, so the switch doesn't click
+    void switchSectionPrecision(SectionPrecision newPrecision);
+    void switchSidePrecision(SectionPrecision newPrecision);
+
+    // a slope or cut filter type change doesn't swap the cut sections in one go. the configuration that was
+    // running keeps going on a copy of its memory next to the new one, and the output fades from one to the
+    // other over "Cut Crossfade". everything it needs is allocated in prepareToPlay, outside a transition
+    // all it costs is a branch per block
+    struct CutShape
+    {
+        Slope lowCut{ Slope::Slope_12 }, highCut{ Slope::Slope_12 }, sideLowCut{ Slope::Slope_12 }, sideHighCut{ Slope::Slope_12 };
+        CutFilterType filterType{ CutFilterType::Butterworth };
+
+        bool operator!=(const CutShape& other) const noexcept
+        {
+            return lowCut != other.lowCut || highCut != other.highCut || sideLowCut != other.sideLowCut
+                || sideHighCut != other.sideHighCut || filterType != other.filterType;
+        }
+    };
+
+    struct CutTransition
+    {
+        CascadeCoefficients cascade, sideCascade;
+        CascadeProcessFunction process{ nullptr };
+        PreciseCascadeProcessFunction processPrecise{ nullptr };
+        MidSideProcessFunction processMidSide{ nullptr };
+        PreciseMidSideProcessFunction processPreciseMidSide{ nullptr };
+        bool isMidSide{ false };
+
+        // in samples at the processing rate
+        int position{ 0 }, length{ 0 };
+
+        bool isActive() const noexcept { return position < length; }
+        void stop() noexcept { position = length; }
+    };
+
+    static CutShape getCutShape(const ChainSettings& settings) noexcept;
+    void startCutTransition();
+
+    // the old configuration over a copy of the block's input in transitionBuffer, then mixed into the new one's output
+    void processOldCuts(const juce::dsp::AudioBlock<float>& block, const SVFPeakCoefficients* ramp);
+    void mixCutTransition(juce::dsp::AudioBlock<float>& block);
+    void processPreciseOldCuts(const juce::AudioBuffer<double>& buffer, int start, int numSamples, const SVFPeakCoefficients* ramp);
+    void mixPreciseCutTransition(juce::AudioBuffer<double>& buffer, int start, int numSamples);
+
+    CutShape activeCutShape;
+    CutTransition cutTransition;
+
+    // copies of the running set's cascades, what a transition starting on the next set fades out from
+    CascadeCoefficients activeCascade, activeSideCascade;
+
+    std::vector<MonoChain> transitionChains;
+    std::vector<PreciseCascadeState> preciseTransitionChains;
+    juce::AudioBuffer<float> transitionBuffer;
+    juce::AudioBuffer<double> preciseTransitionBuffer;
+    std::atomic<float>* cutCrossfade{ apvts.getRawParameterValue("Cut Crossfade") };
+    bool blockHadTransition{ false };
+
+    // left/right memory means nothing as mid/side and the other way round, so both sides start from silence
+    bool shouldUseMidSide(const ChainSettings& settings) const noexcept;
+    void switchStereoMode(bool shouldUseMidSide);
+    void processMidSide(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade);
+
+    // the cut memory of the mode we leave is stale by the time we come back, so both sides start from silence
+    void switchCutMode(CutMode newMode);
+
+    // the chain's memory belongs to the old rate, so it starts from silence at the new one
+    void switchOversampling(OversamplingFactor newFactor, OversamplingFilter newFilter);
+    static size_t getOversamplerIndex(OversamplingFactor factor, OversamplingFilter filter) noexcept;
+    static int measureOversamplerTail(Oversampler& oversampler, int blockSize);
+    int getOversamplerTail() const noexcept;
+
+    // the rate the IIR chain runs at, the host rate times the oversampling factor
+    double getProcessingSampleRate() const;
+
+    // oversampler plus linear phase convolver, handed to the host from the message thread
+    int getTotalLatency() const noexcept;
+    void reportLatency();
+
+    template <typename CutState>
+    static void updateCutFilter(CutState& cutState, int oldNumSections, int newNumSections)
+    {
+        // sections that weren't running have nothing sensible in their memory, start them from silence
+        for (int i = oldNumSections; i < newNumSections; ++i)
+            cutState[static_cast<size_t>(i)] = {};
+    }
+
+    // in Mid/Side mode a path runs identity sections past its own, and their memory has to stay at zero,
+    // so a section leaving the path gets cleared as well as one joining it
+    template <typename CutState>
+    static void updateMidSideCutFilter(CutState& cutState, int oldNumSections, int newNumSections)
     {
-        updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-        chain.template setBypassed<Index>(false);
+        for (int i = juce::jmin(oldNumSections, newNumSections); i < maxCutSections; ++i)
+            cutState[static_cast<size_t>(i)] = {};
     }
 
-    template<typename ChainType, typename CoefficientType>
-    void updateCutFilter(ChainType& leftLowCut, const CoefficientType& cutCoefficients, const Slope& lowCutSlope)
+    // from old to the new output already in samples, in a straight line over the whole transition. the two
+    // are the same input through similar filters, so they add up in phase and a linear fade keeps the level
+    template <typename SampleType>
+    static void crossfade(SampleType* samples, const SampleType* old, int numSamples, int position, int length) noexcept
     {
-        // 8 pos, bypass all
-        leftLowCut.template setBypassed<0>(true);
-        leftLowCut.template setBypassed<1>(true);
-        leftLowCut.template setBypassed<2>(true);
-        leftLowCut.template setBypassed<3>(true);
-        leftLowCut.template setBypassed<4>(true);
-        leftLowCut.template setBypassed<5>(true);
-        leftLowCut.template setBypassed<6>(true);
-        leftLowCut.template setBypassed<7>(true);
-                            
-        // order is 2* ish, helper will return 1 coefficient only
-        // using case slope reversing so no more breaking
-        switch (lowCutSlope)
+        auto step = static_cast<SampleType>(1) / static_cast<SampleType>(length);
+
+        for (int i = 0; i < numSamples; ++i)
         {
-            case Slope_96: {
-                update<7>(leftLowCut, cutCoefficients);
-                update<6>(leftLowCut, cutCoefficients);
-                update<5>(leftLowCut, cutCoefficients);
-                update<4>(leftLowCut, cutCoefficients);
-            }
-            case Slope_48: {
-                update<3>(leftLowCut, cutCoefficients);
-            }
-            case Slope_36: {
-                update<2>(leftLowCut, cutCoefficients);
-            }
-            case Slope_24: {
-                update<1>(leftLowCut, cutCoefficients);
-            }
-            case Slope_12: {
-                update<0>(leftLowCut, cutCoefficients);
-                break;
-            }
+            auto amount = juce::jmin(static_cast<SampleType>(1), static_cast<SampleType>(position + i + 1) * step);
+            samples[i] = old[i] + amount * (samples[i] - old[i]);
         }
     }
 
-    // custom helper for the swtich statement in the cpp
-    int getOrderForSlope(Slope slope) const;
+    // hands the filter memory over between channelChains and the lanes of laneChains
+    void storeLaneStates();
+    void loadLaneStates();
+    void switchProcessingPath(ProcessingPath newPath);
+
+    // rebuilds activeChannels when "LFE Bypass" flips, without allocating
+    void updateActiveChannels(bool bypassLFE);
+
+    // moves channels in and out of identicalChannels as the block's contents change, then copies the outputs over after processing
+    void updateIdenticalChannels(const juce::dsp::AudioBlock<float>& block);
+    void releaseIdenticalChannels();
+    void rebuildProcessedChannels();
+    void copyIdenticalChannels(juce::dsp::AudioBlock<float>& block);
+
+    bool isInputSilent(const juce::dsp::AudioBlock<float>& block) const noexcept;
+    void resetChains() noexcept;
+
+    // every set of chain memory, scalar, lanes and double, whichever of them is running
+    template <typename Function>
+    void forEachChain(Function&& function)
+    {
+        for (auto& chain : channelChains)
+            function(chain);
+
+        for (auto& chain : laneChains)
+            function(chain);
+
+        for (auto& chain : preciseChains)
+            function(chain);
+    }
+
+    // the two peak topologies keep different things in the peak's memory, so a switch starts it from silence
+    void switchPeakTopology(PeakTopology newTopology);
+    void resetPeakSmoothing();
+    const SVFPeakCoefficients* updatePeakRamp(int numSamples);
+
+    // runs the detector over the block, before updatePeakRamp() for the same samples
+    void startPeakDetection(int numSamples);
+    void detectPeakBand(const juce::dsp::AudioBlock<float>& block);
+    void detectPeakBand(const juce::AudioBuffer<double>& buffer, int start, int numSamples);
+
+    void processLinearPhase(juce::dsp::AudioBlock<float>& block);
+    void delayBypassedChannels(juce::dsp::AudioBlock<float>& block);
+
+    // the IIR chain at whatever rate the block is at, processOversampled() wraps it in the way up and back down
+    void processIIR(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade);
+    void processOversampled(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade);
+
+    // the float path for a float block, processChains() is everything processBlock() did before double came along
+    void processChains(juce::dsp::AudioBlock<float>& block);
+    void processConverted(juce::AudioBuffer<double>& buffer);
+    void processPrecise(juce::AudioBuffer<double>& buffer);
+
+    void processFilters(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade, const SVFPeakCoefficients* ramp);
+    void processCuts(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade, const SVFPeakCoefficients* ramp);
+    void processScalar(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade, const SVFPeakCoefficients* ramp);
+    void processSIMD(juce::dsp::AudioBlock<float>& block, const CascadeCoefficients& cascade, const SVFPeakCoefficients* ramp);
+
+    // the parametric bands after the chain, at the same rate, on every channel that got its own pass
+    void processBands(juce::dsp::AudioBlock<float>& block);
 
+    // what the exporter writes next to the telemetry, so a file can be matched to the instance it came from
+    juce::var describeForTelemetry() const;
 
-    // updating the low and high cuts
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    PerformanceTelemetry telemetry;
+    SpectrumAnalyzer analyzer;
 
-    // updating all filter
-    void updateFilter();
+    // last, so it stops writing before anything describeForTelemetry() reads goes away
+    TelemetryExporter telemetryExporter{ telemetry, [this] { return describeForTelemetry(); } };
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CustomEQAudioProcessor)
@@ -0,0 +1,244 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.cpp
+    The magnitude response of the chain at every pixel column of the editor,
+    one cached curve per stage.
+
+  ==============================================================================
+*/
+
+#include "ResponseCurve.h"
+
+namespace
+{
+    // the columns are padded to this, a multiple of every SIMD width we build for
+    constexpr int columnAlignment = 8;
+
+    // the linear phase FIR's Kaiser window (beta 8.6) keeps its stop band about this far down
+    constexpr float linearPhaseStopBandDecibels = -86.0f;
+
+    bool sectionsMatch(const PreciseBiquadSection* a, const PreciseBiquadSection* b, int numSections) noexcept
+    {
+        return std::equal(a, a + numSections, b, [](const PreciseBiquadSection& x, const PreciseBiquadSection& y)
+        {
+            return x.b0 == y.b0 && x.b1 == y.b1 && x.b2 == y.b2 && x.a1 == y.a1 && x.a2 == y.a2;
+        });
+    }
+}
+
+void ResponseCurve::setColumns(int newNumColumns, float minFrequency, float maxFrequency)
+{
+    jassert(newNumColumns >= 0 && minFrequency > 0.0f && maxFrequency > minFrequency);
+
+    numColumns = newNumColumns;
+    numPaddedColumns = (numColumns + columnAlignment - 1) / columnAlignment * columnAlignment;
+
+    frequencies.assign(static_cast<size_t>(numColumns), 0.0f);
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        auto proportion = numColumns > 1 ? static_cast<float>(column) / static_cast<float>(numColumns - 1) : 0.0f;
+        frequencies[static_cast<size_t>(column)] = minFrequency * std::pow(maxFrequency / minFrequency, proportion);
+    }
+
+    // the padding columns sit at DC, where every section is finite
+    phi.assign(static_cast<size_t>(numPaddedColumns), 0.0f);
+    magnitudes.assign(static_cast<size_t>(numPaddedColumns), 1.0f);
+    total.assign(static_cast<size_t>(numPaddedColumns), 0.0f);
+
+    for (auto& stage : stages)
+        stage.assign(static_cast<size_t>(numPaddedColumns), 0.0f);
+
+    if (! hasCascade)
+        return;
+
+    updatePhi();
+
+    for (int stage = 0; stage < numStages; ++stage)
+        evaluate(stage);
+
+    sumStages();
+}
+
+bool ResponseCurve::update(const PublishedCascade& cascade)
+{
+    auto rateChanged = ! hasCascade || cascade.sampleRate != current.sampleRate;
+    auto previous = current;
+    auto hadCascade = hasCascade;
+
+    current = cascade;
+    hasCascade = true;
+
+    if (rateChanged)
+        updatePhi();
+
+    auto anyChanged = false;
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        if (rateChanged || ! hadCascade || stageChanged(stage, previous, cascade))
+        {
+            evaluate(stage);
+            anyChanged = true;
+        }
+    }
+
+    if (anyChanged)
+        sumStages();
+
+    return anyChanged;
+}
+
+void ResponseCurve::updatePhi()
+{
+    // anything past nyquist at the design rate would fold back, so it's held at nyquist instead
+    auto nyquist = static_cast<float>(current.sampleRate * 0.5);
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        auto frequency = juce::jmin(frequencies[static_cast<size_t>(column)], nyquist);
+        auto halfOmega = juce::MathConstants<double>::pi * frequency / current.sampleRate;
+        auto sine = std::sin(halfOmega);
+        phi[static_cast<size_t>(column)] = static_cast<float>(sine * sine);
+    }
+}
+
+bool ResponseCurve::stageChanged(int stage, const PublishedCascade& a, const PublishedCascade& b) noexcept
+{
+    const auto& x = a.cascade;
+    const auto& y = b.cascade;
+    auto modeChanged = a.settings.cutMode != b.settings.cutMode;
+    auto isLinearPhase = b.settings.cutMode == CutMode::LinearPhase;
+
+    switch (stage)
+    {
+    case 0:
+        if (isLinearPhase)
+            return modeChanged || a.settings.lowCutFreq != b.settings.lowCutFreq;
+
+        return modeChanged || x.numLowCutSections != y.numLowCutSections
+            || ! sectionsMatch(x.preciseLowCut.data(), y.preciseLowCut.data(), y.numLowCutSections);
+
+    case 1:
+        return ! sectionsMatch(&x.precisePeak, &y.precisePeak, 1);
+
+    case 2:
+        if (isLinearPhase)
+            return modeChanged || a.settings.highCutFreq != b.settings.highCutFreq;
+
+        return modeChanged || x.numHighCutSections != y.numHighCutSections
+            || ! sectionsMatch(x.preciseHighCut.data(), y.preciseHighCut.data(), y.numHighCutSections);
+
+    case 3:
+        if (a.bands.numActive != b.bands.numActive)
+            return true;
+
+        for (int slot = 0; slot < b.bands.numActive; ++slot)
+        {
+            auto first = a.bands.getSection(slot), second = b.bands.getSection(slot);
+
+            if (! sectionsMatch(&first, &second, 1))
+                return true;
+        }
+
+        return false;
+
+    default:
+        jassertfalse;
+        return true;
+    }
+}
+
+void ResponseCurve::evaluate(int stage)
+{
+    auto* decibels = stages[static_cast<size_t>(stage)].data();
+    const auto& cascade = current.cascade;
+    auto isLinearPhase = current.settings.cutMode == CutMode::LinearPhase;
+
+    ++numStageEvaluations;
+
+    // in linear phase mode the cuts are the FIR, drawn as the brickwall it approximates
+    if (stage == 0)
+    {
+        if (isLinearPhase)
+            evaluateBrickwall(current.settings.lowCutFreq, true, decibels);
+        else
+            evaluateSections(cascade.preciseLowCut.data(), cascade.numLowCutSections, decibels);
+    }
+    else if (stage == 1)
+    {
+        evaluateSections(&cascade.precisePeak, 1, decibels);
+    }
+    else if (stage == 3)
+    {
+        std::array<PreciseBiquadSection, maxBands> sections;
+
+        for (int slot = 0; slot < current.bands.numActive; ++slot)
+            sections[static_cast<size_t>(slot)] = current.bands.getSection(slot);
+
+        evaluateSections(sections.data(), current.bands.numActive, decibels);
+    }
+    else
+    {
+        if (isLinearPhase)
+            evaluateBrickwall(current.settings.highCutFreq, false, decibels);
+        else
+            evaluateSections(cascade.preciseHighCut.data(), cascade.numHighCutSections, decibels);
+    }
+}
+
+void ResponseCurve::evaluateSections(const PreciseBiquadSection* sections, int numSections, float* decibels)
+{
+    auto* magnitude = magnitudes.data();
+    const auto* p = phi.data();
+    auto numValues = numPaddedColumns;
+
+    std::fill(magnitudes.begin(), magnitudes.end(), 1.0f);
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        const auto& section = sections[i];
+        auto b0 = section.b0, b1 = section.b1, b2 = section.b2, a1 = section.a1, a2 = section.a2;
+
+        // the sums are formed in double, that's where a pole next to the unit circle needs the bits
+        auto n0 = static_cast<float>((b0 + b1 + b2) * (b0 + b1 + b2));
+        auto n1 = static_cast<float>(-4.0 * (b0 * b1 + 4.0 * b0 * b2 + b1 * b2));
+        auto n2 = static_cast<float>(16.0 * b0 * b2);
+        auto d0 = static_cast<float>((1.0 + a1 + a2) * (1.0 + a1 + a2));
+        auto d1 = static_cast<float>(-4.0 * (a1 + 4.0 * a2 + a1 * a2));
+        auto d2 = static_cast<float>(16.0 * a2);
+
+        for (int column = 0; column < numValues; ++column)
+        {
+            auto x = p[column];
+            magnitude[column] *= (n0 + x * (n1 + x * n2)) / (d0 + x * (d1 + x * d2));
+        }
+    }
+
+    // squared magnitude, so 10 log10 rather than 20
+    auto floorPower = std::pow(10.0f, floorDecibels / 10.0f);
+
+    for (int column = 0; column < numValues; ++column)
+        decibels[column] = 10.0f * std::log10(juce::jmax(magnitude[column], floorPower));
+}
+
+void ResponseCurve::evaluateBrickwall(float cutoff, bool isHighpass, float* decibels)
+{
+    for (int column = 0; column < numColumns; ++column)
+    {
+        auto frequency = frequencies[static_cast<size_t>(column)];
+        auto isPassed = isHighpass ? frequency >= cutoff : frequency <= cutoff;
+        decibels[column] = isPassed ? 0.0f : linearPhaseStopBandDecibels;
+    }
+
+    std::fill(decibels + numColumns, decibels + numPaddedColumns, 0.0f);
+}
+
+void ResponseCurve::sumStages()
+{
+    juce::FloatVectorOperations::copy(total.data(), stages[0].data(), numPaddedColumns);
+
+    for (size_t stage = 1; stage < stages.size(); ++stage)
+        juce::FloatVectorOperations::add(total.data(), stages[stage].data(), numPaddedColumns);
+}
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.h
+    The magnitude response of the chain at every pixel column of the editor,
+    one cached curve per stage.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesigner.h"
+
+//==============================================================================
+/**
+    Evaluates |H(e^jw)| of the published cascade at numColumns log spaced
+    frequencies and keeps the result in decibels, per stage and summed.
+
+    Each stage's curve is cached, and update() only evaluates again the stages
+    whose sections changed. Moving the Peak knob costs one section, not
+    seventeen. A new sample rate or column count evaluates everything.
+
+    A section's squared magnitude is written in terms of phi = sin^2(w / 2):
+
+        |H|^2 = ((b0 + b1 + b2)^2 - 4 (b0 b1 + 4 b0 b2 + b1 b2) phi + 16 b0 b2 phi^2)
+              / ((1 + a1 + a2)^2 - 4 (a1 + 4 a2 + a1 a2) phi + 16 a2 phi^2)
+
+    The six terms come from the double coefficients once per section. Each
+    column then costs two short polynomials and a divide, with no trig and no
+    complex maths. Nothing cancels either, even for a steep 20 Hz LowCut at an
+    oversampled rate, whose poles sit right on the unit circle. The columns are
+    padded to a whole number of vectors and the inner loop has no branches, so
+    it compiles to packed SIMD. It's written without juce::dsp::SIMDRegister
+    because that has no divide.
+
+    Message thread only, everything is sized in setColumns().
+*/
+class ResponseCurve
+{
+public:
+    // LowCut, Peak, HighCut in the order of the processor's ChainPositions, then the parametric bands together
+    static constexpr int numStages = 4;
+
+    // where a stage's curve bottoms out, so an empty stop band stays on screen
+    static constexpr float floorDecibels = -120.0f;
+
+    void setColumns(int numColumns, float minFrequency, float maxFrequency);
+
+    // evaluates the stages that changed since the last call, true if any did
+    bool update(const PublishedCascade& cascade);
+
+    int getNumColumns() const noexcept { return numColumns; }
+    const float* getDecibels() const noexcept { return total.data(); }
+    const float* getStageDecibels(int stage) const noexcept { return stages[static_cast<size_t>(stage)].data(); }
+
+    // how many stage curves have been evaluated so far, to see what a sweep really costs
+    juce::uint64 getNumStageEvaluations() const noexcept { return numStageEvaluations; }
+
+private:
+    void updatePhi();
+    void evaluate(int stage);
+    void evaluateSections(const PreciseBiquadSection* sections, int numSections, float* decibels);
+    void evaluateBrickwall(float cutoff, bool isHighpass, float* decibels);
+    void sumStages();
+
+    static bool stageChanged(int stage, const PublishedCascade& a, const PublishedCascade& b) noexcept;
+
+    int numColumns{ 0 }, numPaddedColumns{ 0 };
+    std::vector<float> frequencies;
+
+    // sin^2(pi f / fs) per column at the rate the current cascade was designed for
+    std::vector<float> phi;
+    std::vector<float> magnitudes;
+
+    std::array<std::vector<float>, numStages> stages;
+    std::vector<float> total;
+
+    PublishedCascade current;
+    bool hasCascade{ false };
+    juce::uint64 numStageEvaluations{ 0 };
+};
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    ResponseCurveDisplay.cpp
+    The EQ curve drawn over the spectrum, the whole chain and each stage.
+
+  ==============================================================================
+*/
+
+#include "ResponseCurveDisplay.h"
+#include "SpectrumAnalyzer.h"
+
+namespace
+{
+    const juce::Colour totalColour{ 0xffffffff };
+    const juce::Colour zeroLineColour{ 0x40ffffff };
+
+    // LowCut, Peak, HighCut, the parametric bands
+    const juce::Colour stageColours[] = { juce::Colour(0x8066b3ff), juce::Colour(0x80ff7a7a), juce::Colour(0x8074d98a), juce::Colour(0x80d9a6ff) };
+}
+
+ResponseCurveDisplay::ResponseCurveDisplay(CustomEQAudioProcessor& processor)
+    : audioProcessor(processor)
+{
+    setInterceptsMouseClicks(false, false);
+    startTimerHz(maxFramesPerSecond);
+}
+
+ResponseCurveDisplay::~ResponseCurveDisplay()
+{
+    stopTimer();
+}
+
+void ResponseCurveDisplay::paint(juce::Graphics& g)
+{
+    auto zeroY = juce::roundToInt(getHeight() * 0.5f);
+    g.setColour(zeroLineColour);
+    g.drawHorizontalLine(zeroY, 0.0f, static_cast<float>(getWidth()));
+
+    for (size_t stage = 0; stage < stagePaths.size(); ++stage)
+    {
+        g.setColour(stageColours[stage]);
+        g.strokePath(stagePaths[stage], juce::PathStrokeType(1.0f));
+    }
+
+    g.setColour(totalColour);
+    g.strokePath(totalPath, juce::PathStrokeType(2.0f));
+}
+
+void ResponseCurveDisplay::resized()
+{
+    curve.setColumns(juce::jmax(2, getWidth()), SpectrumAnalyzer::minFrequency, SpectrumAnalyzer::maxFrequency);
+
+    // a column per pixel and the corners, once per size rather than per frame
+    totalPath.preallocateSpace(3 * (curve.getNumColumns() + 1));
+
+    for (auto& path : stagePaths)
+        path.preallocateSpace(3 * (curve.getNumColumns() + 1));
+
+    updatePaths();
+    repaint();
+}
+
+void ResponseCurveDisplay::timerCallback()
+{
+    if (! audioProcessor.getPublishedCascade(published, publishedSerial))
+        return;
+
+    if (curve.update(published))
+    {
+        updatePaths();
+        repaint();
+    }
+}
+
+void ResponseCurveDisplay::updatePaths()
+{
+    updatePath(totalPath, curve.getDecibels());
+
+    for (size_t stage = 0; stage < stagePaths.size(); ++stage)
+        updatePath(stagePaths[stage], curve.getStageDecibels(static_cast<int>(stage)));
+}
+
+void ResponseCurveDisplay::updatePath(juce::Path& path, const float* decibels)
+{
+    path.clear();
+
+    auto numColumns = curve.getNumColumns();
+
+    if (numColumns < 2)
+        return;
+
+    // a stop band runs just off the bottom rather than along it
+    auto height = static_cast<float>(getHeight());
+    auto step = static_cast<float>(getWidth()) / static_cast<float>(numColumns - 1);
+    auto getY = [height](float level) { return juce::jmap(juce::jlimit(-rangeDecibels - 1.0f, rangeDecibels + 1.0f, level),
+                                                          -rangeDecibels, rangeDecibels, height, 0.0f); };
+
+    path.startNewSubPath(0.0f, getY(decibels[0]));
+
+    for (int column = 1; column < numColumns; ++column)
+        path.lineTo(static_cast<float>(column) * step, getY(decibels[column]));
+}
@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    ResponseCurveDisplay.h
+    The EQ curve drawn over the spectrum, the whole chain and each stage.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "ResponseCurve.h"
+
+//==============================================================================
+/**
+    A transparent overlay the same size as the SpectrumDisplay under it, with a
+    column per pixel on the same log frequency axis.
+
+    Polls the processor's published coefficients at most maxFramesPerSecond
+    times a second, and only when a new set came in does it look at the stages,
+    evaluate again the ones that changed and repaint. An editor sitting open
+    with nobody touching it costs one spin locked serial check per frame.
+*/
+class ResponseCurveDisplay : public juce::Component,
+                             private juce::Timer
+{
+public:
+    explicit ResponseCurveDisplay(CustomEQAudioProcessor& processor);
+    ~ResponseCurveDisplay() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    // the curve's vertical scale, +-rangeDecibels around 0 dB in the middle
+    static constexpr float rangeDecibels = 30.0f;
+    static constexpr int maxFramesPerSecond = 30;
+
+private:
+    void timerCallback() override;
+    void updatePaths();
+    void updatePath(juce::Path& path, const float* decibels);
+
+    CustomEQAudioProcessor& audioProcessor;
+
+    ResponseCurve curve;
+    PublishedCascade published;
+    juce::uint32 publishedSerial{ 0 };
+
+    juce::Path totalPath;
+    std::array<juce::Path, ResponseCurve::numStages> stagePaths;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ResponseCurveDisplay)
+};
@@ -0,0 +1,228 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+    Pre and post EQ spectra for the editor. The audio thread only drops a mono
+    mix into a fifo, the FFTs run on a background thread.
+
+  ==============================================================================
+*/
+
+#include <numeric>
+#include "SpectrumAnalyzer.h"
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+{
+    for (auto& analysis : analyses)
+        analysis.points.fill(floorDecibels);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    stop();
+}
+
+void SpectrumAnalyzer::prepare(double newSampleRate)
+{
+    // the thread can't be halfway through a frame while the buffers change under it
+    auto wasRegistered = isRegistered;
+
+    if (isRegistered)
+        (*analyzerThread)->removeTimeSliceClient(this);
+
+    isRegistered = false;
+    sampleRate = newSampleRate;
+
+    window.resize(static_cast<size_t>(fftSize));
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), static_cast<size_t>(fftSize),
+                                                             juce::dsp::WindowingFunction<float>::hann, false);
+
+    // a full scale sine reads 0 dB whatever the window takes off it
+    auto windowSum = std::accumulate(window.begin(), window.end(), 0.0f);
+    magnitudeScale = 2.0f / windowSum;
+
+    // performFrequencyOnlyForwardTransform() wants room for the complex result
+    fftBuffer.assign(static_cast<size_t>(2 * fftSize), 0.0f);
+    averagingCoefficient = static_cast<float>(std::exp(-hopSize / (sampleRate * averagingSeconds)));
+
+    for (auto& analysis : analyses)
+    {
+        analysis.history.assign(static_cast<size_t>(fftSize), 0.0f);
+        analysis.historyPosition = 0;
+        analysis.samplesSinceFrame = 0;
+        analysis.averaged.assign(static_cast<size_t>(fftSize / 2 + 1), 0.0f);
+
+        const juce::SpinLock::ScopedLockType lock(pointsLock);
+        analysis.points.fill(floorDecibels);
+        ++analysis.serial;
+    }
+
+    auto getBin = [this](double frequency) { return frequency * fftSize / sampleRate; };
+    auto numBins = fftSize / 2 + 1;
+
+    for (int point = 0; point < numPoints; ++point)
+    {
+        // each point covers the bins half way (on a log scale) to the points either side of it
+        auto frequency = static_cast<double>(getFrequencyOfPoint(point));
+        auto below = std::sqrt(frequency * getFrequencyOfPoint(juce::jmax(0, point - 1)));
+        auto above = std::sqrt(frequency * getFrequencyOfPoint(juce::jmin(numPoints - 1, point + 1)));
+
+        pointBins[static_cast<size_t>(point)] = static_cast<float>(getBin(frequency));
+        lowestBins[static_cast<size_t>(point)] = juce::jlimit(0, numBins, static_cast<int>(std::ceil(getBin(below))));
+        highestBins[static_cast<size_t>(point)] = juce::jlimit(0, numBins, static_cast<int>(std::floor(getBin(above))) + 1);
+    }
+
+    if (wasRegistered)
+    {
+        discardInput = true;
+        (*analyzerThread)->addTimeSliceClient(this);
+        isRegistered = true;
+    }
+}
+
+void SpectrumAnalyzer::start()
+{
+    if (analyzerThread == nullptr)
+        analyzerThread = std::make_unique<juce::SharedResourcePointer<SharedAnalyzerThread>>();
+
+    discardInput = true;
+    running = true;
+
+    if (! isRegistered)
+        (*analyzerThread)->addTimeSliceClient(this);
+
+    isRegistered = true;
+}
+
+void SpectrumAnalyzer::stop()
+{
+    running = false;
+
+    // blocks until a slice that's under way has finished
+    if (isRegistered)
+        (*analyzerThread)->removeTimeSliceClient(this);
+
+    isRegistered = false;
+}
+
+bool SpectrumAnalyzer::getSpectrum(Tap tap, Spectrum& destination, juce::uint32& lastSerial) const
+{
+    const auto& analysis = analyses[static_cast<size_t>(tap)];
+    const juce::SpinLock::ScopedLockType lock(pointsLock);
+
+    if (analysis.serial == lastSerial)
+        return false;
+
+    destination = analysis.points;
+    lastSerial = analysis.serial;
+    return true;
+}
+
+float SpectrumAnalyzer::getFrequencyOfPoint(int point) noexcept
+{
+    return minFrequency * std::pow(maxFrequency / minFrequency, static_cast<float>(point) / static_cast<float>(numPoints - 1));
+}
+
+//==============================================================================
+int SpectrumAnalyzer::useTimeSlice()
+{
+    if (sampleRate <= 0.0)
+        return 50;
+
+    auto discard = discardInput.exchange(false);
+
+    for (int tap = 0; tap < numTaps; ++tap)
+    {
+        auto& input = inputs[static_cast<size_t>(tap)];
+        auto& analysis = analyses[static_cast<size_t>(tap)];
+        const auto scope = input.fifo.read(input.fifo.getNumReady());
+
+        if (discard)
+            continue;
+
+        auto hasNewFrame = false;
+
+        auto feed = [&](int start, int numSamples)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                analysis.history[static_cast<size_t>(analysis.historyPosition)] = input.samples[static_cast<size_t>(start + i)];
+                analysis.historyPosition = (analysis.historyPosition + 1) % fftSize;
+
+                if (++analysis.samplesSinceFrame >= hopSize)
+                {
+                    analysis.samplesSinceFrame = 0;
+                    analyse(static_cast<Tap>(tap));
+                    hasNewFrame = true;
+                }
+            }
+        };
+
+        feed(scope.startIndex1, scope.blockSize1);
+        feed(scope.startIndex2, scope.blockSize2);
+
+        if (hasNewFrame)
+            publish(static_cast<Tap>(tap));
+    }
+
+    // a hop is 5 ms even at 192k, so this keeps up without spinning
+    return 10;
+}
+
+void SpectrumAnalyzer::analyse(Tap tap)
+{
+    auto& analysis = analyses[static_cast<size_t>(tap)];
+
+    // the history is a ring, its oldest sample is where the next one goes
+    for (int i = 0; i < fftSize; ++i)
+    {
+        auto index = static_cast<size_t>((analysis.historyPosition + i) % fftSize);
+        fftBuffer[static_cast<size_t>(i)] = analysis.history[index] * window[static_cast<size_t>(i)];
+    }
+
+    std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+    fft.performFrequencyOnlyForwardTransform(fftBuffer.data(), true);
+
+    for (size_t bin = 0; bin < analysis.averaged.size(); ++bin)
+    {
+        auto magnitude = fftBuffer[bin] * magnitudeScale;
+        analysis.averaged[bin] = magnitude + averagingCoefficient * (analysis.averaged[bin] - magnitude);
+    }
+}
+
+void SpectrumAnalyzer::publish(Tap tap)
+{
+    auto& analysis = analyses[static_cast<size_t>(tap)];
+    const auto& averaged = analysis.averaged;
+    auto lastBin = static_cast<int>(averaged.size()) - 1;
+    Spectrum points;
+
+    for (size_t point = 0; point < points.size(); ++point)
+    {
+        auto magnitude = 0.0f;
+
+        if (pointBins[point] > static_cast<float>(lastBin))
+        {
+            // above nyquist at this rate, nothing there
+        }
+        else if (highestBins[point] - lowestBins[point] < 2)
+        {
+            // down low the points are closer together than the bins, so read in between them
+            auto bin = static_cast<int>(pointBins[point]);
+            auto fraction = pointBins[point] - static_cast<float>(bin);
+            auto next = juce::jmin(bin + 1, lastBin);
+            magnitude = averaged[static_cast<size_t>(bin)] + fraction * (averaged[static_cast<size_t>(next)] - averaged[static_cast<size_t>(bin)]);
+        }
+        else
+        {
+            // up high one point covers many bins, the loudest of them is what the ear picks out
+            magnitude = *std::max_element(averaged.begin() + lowestBins[point], averaged.begin() + highestBins[point]);
+        }
+
+        points[point] = juce::Decibels::gainToDecibels(magnitude, floorDecibels);
+    }
+
+    const juce::SpinLock::ScopedLockType lock(pointsLock);
+    analysis.points = points;
+    ++analysis.serial;
+}
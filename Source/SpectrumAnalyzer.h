@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+    Pre and post EQ spectra for the editor. The audio thread only drops a mono
+    mix into a fifo, the FFTs run on a background thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Two taps, the input before the EQ and the output after it. processBlock()
+    mixes each tap's channels down to mono straight into a single producer,
+    single consumer fifo, which costs one atomic load while no editor is
+    listening and one pass over the block while one is. If the fifo is full the
+    rest of the block is dropped, the audio thread never waits.
+
+    A thread shared by every instance reads the fifos, runs a Hann windowed FFT
+    every hopSize samples, smooths the magnitudes over time and bins them into
+    numPoints log spaced points between minFrequency and maxFrequency. The
+    editor copies the newest points out under a spin lock the audio thread
+    never touches.
+
+    prepare() allocates, everything else is fixed size.
+*/
+class SpectrumAnalyzer : private juce::TimeSliceClient
+{
+public:
+    enum Tap
+    {
+        preEQ,
+        postEQ,
+        numTaps
+    };
+
+    // 4096 points, about 12 Hz per bin at 48k, a new frame every quarter of that
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+
+    static constexpr int numPoints = 256;
+    static constexpr float minFrequency = 20.0f;
+    static constexpr float maxFrequency = 20000.0f;
+
+    // what the points sit at with nothing coming in
+    static constexpr float floorDecibels = -120.0f;
+
+    // how long the magnitudes take to fall to about a third of a change
+    static constexpr double averagingSeconds = 0.1;
+
+    using Spectrum = std::array<float, numPoints>;
+
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer() override;
+
+    // not on the audio thread
+    void prepare(double sampleRate);
+
+    // message thread, while an editor shows the spectrum. stopped, push() returns straight away
+    void start();
+    void stop();
+    bool isRunning() const noexcept { return running.load(std::memory_order_relaxed); }
+
+    // audio thread, wait-free
+    template <typename SampleType>
+    void push(Tap tap, const SampleType* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (! running.load(std::memory_order_relaxed) || numChannels <= 0)
+            return;
+
+        auto& input = inputs[static_cast<size_t>(tap)];
+        const auto scope = input.fifo.write(numSamples);
+        auto gain = 1.0f / static_cast<float>(numChannels);
+
+        mixDown(channels, numChannels, 0, input.samples.data() + scope.startIndex1, scope.blockSize1, gain);
+        mixDown(channels, numChannels, scope.blockSize1, input.samples.data() + scope.startIndex2, scope.blockSize2, gain);
+    }
+
+    // any thread but the audio thread: copies the newest points in decibels if they changed since lastSerial
+    bool getSpectrum(Tap tap, Spectrum& destination, juce::uint32& lastSerial) const;
+
+    // the frequency point n of a Spectrum stands for
+    static float getFrequencyOfPoint(int point) noexcept;
+
+private:
+    int useTimeSlice() override;
+    void analyse(Tap tap);
+    void publish(Tap tap);
+
+    template <typename SampleType>
+    static void mixDown(const SampleType* const* channels, int numChannels, int offset, float* destination, int numSamples, float gain) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto sum = 0.0f;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                sum += static_cast<float>(channels[channel][offset + i]);
+
+            destination[i] = sum * gain;
+        }
+    }
+
+    // audio thread -> analyzer thread
+    struct Input
+    {
+        static constexpr int capacity = 1 << 15;
+
+        juce::AbstractFifo fifo{ capacity };
+        std::array<float, capacity> samples{};
+    };
+
+    // analyzer thread only, apart from points which the editor reads under lock
+    struct Analysis
+    {
+        std::vector<float> history;
+        int historyPosition{ 0 };
+        int samplesSinceFrame{ 0 };
+
+        std::vector<float> averaged;
+        Spectrum points{};
+        juce::uint32 serial{ 0 };
+    };
+
+    std::array<Input, numTaps> inputs;
+    std::array<Analysis, numTaps> analyses;
+
+    double sampleRate{ 0.0 };
+    juce::dsp::FFT fft{ fftOrder };
+    std::vector<float> window;
+    std::vector<float> fftBuffer;
+    float magnitudeScale{ 1.0f };
+    float averagingCoefficient{ 0.0f };
+
+    // for every point, the fractional bin at its frequency and the bins half way to its neighbours
+    std::array<float, numPoints> pointBins{};
+    std::array<int, numPoints> lowestBins{}, highestBins{};
+
+    std::atomic<bool> running{ false };
+
+    // set by start(), whatever sat in the fifos from before is stale
+    std::atomic<bool> discardInput{ false };
+    bool isRegistered{ false };
+
+    mutable juce::SpinLock pointsLock;
+
+    struct SharedAnalyzerThread : public juce::TimeSliceThread
+    {
+        SharedAnalyzerThread() : juce::TimeSliceThread("CustomEQ Analyzer") { startThread(juce::Thread::Priority::low); }
+        ~SharedAnalyzerThread() override { stopThread(2000); }
+    };
+
+    std::unique_ptr<juce::SharedResourcePointer<SharedAnalyzerThread>> analyzerThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzer)
+};
@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.cpp
+    The editor's analyzer view: pre and post EQ spectra over a log frequency
+    grid.
+
+  ==============================================================================
+*/
+
+#include "SpectrumDisplay.h"
+
+namespace
+{
+    const juce::Colour backgroundColour{ 0xff15181c };
+    const juce::Colour gridColour{ 0x26ffffff };
+    const juce::Colour labelColour{ 0x80ffffff };
+    const juce::Colour preColour{ 0x3389a7c9 };
+    const juce::Colour postColour{ 0xffe8b45c };
+}
+
+SpectrumDisplay::SpectrumDisplay(SpectrumAnalyzer& analyzerToShow)
+    : analyzer(analyzerToShow)
+{
+    setOpaque(true);
+
+    for (auto& spectrum : spectra)
+        spectrum.fill(SpectrumAnalyzer::floorDecibels);
+
+    // a point per spectrum point, plus the corners that close the filled one
+    for (auto& path : paths)
+        path.preallocateSpace(3 * (SpectrumAnalyzer::numPoints + 3));
+
+    analyzer.start();
+    startTimerHz(maxFramesPerSecond);
+}
+
+SpectrumDisplay::~SpectrumDisplay()
+{
+    stopTimer();
+    analyzer.stop();
+}
+
+void SpectrumDisplay::setTapVisible(SpectrumAnalyzer::Tap tap, bool shouldBeVisible)
+{
+    visible[static_cast<size_t>(tap)] = shouldBeVisible;
+    repaint();
+}
+
+float SpectrumDisplay::getXForFrequency(float frequency) const noexcept
+{
+    auto proportion = std::log(frequency / SpectrumAnalyzer::minFrequency)
+                    / std::log(SpectrumAnalyzer::maxFrequency / SpectrumAnalyzer::minFrequency);
+    return proportion * static_cast<float>(getWidth());
+}
+
+float SpectrumDisplay::getYForDecibels(float decibels) const noexcept
+{
+    return juce::jmap(decibels, minDecibels, maxDecibels, static_cast<float>(getHeight()), 0.0f);
+}
+
+//==============================================================================
+void SpectrumDisplay::paint(juce::Graphics& g)
+{
+    g.drawImageAt(grid, 0, 0);
+
+    if (visible[SpectrumAnalyzer::preEQ])
+    {
+        g.setColour(preColour);
+        g.fillPath(paths[SpectrumAnalyzer::preEQ]);
+    }
+
+    if (visible[SpectrumAnalyzer::postEQ])
+    {
+        g.setColour(postColour);
+        g.strokePath(paths[SpectrumAnalyzer::postEQ], juce::PathStrokeType(1.5f));
+    }
+}
+
+void SpectrumDisplay::resized()
+{
+    drawGrid();
+
+    for (int tap = 0; tap < SpectrumAnalyzer::numTaps; ++tap)
+        updatePath(static_cast<SpectrumAnalyzer::Tap>(tap));
+}
+
+void SpectrumDisplay::timerCallback()
+{
+    auto hasChanged = false;
+
+    for (int tap = 0; tap < SpectrumAnalyzer::numTaps; ++tap)
+    {
+        auto index = static_cast<size_t>(tap);
+
+        if (visible[index] && analyzer.getSpectrum(static_cast<SpectrumAnalyzer::Tap>(tap), spectra[index], serials[index]))
+        {
+            updatePath(static_cast<SpectrumAnalyzer::Tap>(tap));
+            hasChanged = true;
+        }
+    }
+
+    if (hasChanged)
+        repaint();
+}
+
+void SpectrumDisplay::updatePath(SpectrumAnalyzer::Tap tap)
+{
+    auto& path = paths[static_cast<size_t>(tap)];
+    const auto& spectrum = spectra[static_cast<size_t>(tap)];
+    auto width = static_cast<float>(getWidth());
+    auto bottom = static_cast<float>(getHeight());
+
+    // the points are evenly spaced on the same log scale as the grid, so x is just the index
+    auto step = width / static_cast<float>(SpectrumAnalyzer::numPoints - 1);
+    auto getY = [this](float decibels) { return getYForDecibels(juce::jmax(decibels, minDecibels)); };
+
+    path.clear();
+    path.startNewSubPath(0.0f, getY(spectrum[0]));
+
+    for (int point = 1; point < SpectrumAnalyzer::numPoints; ++point)
+        path.lineTo(static_cast<float>(point) * step, getY(spectrum[static_cast<size_t>(point)]));
+
+    if (tap == SpectrumAnalyzer::preEQ)
+    {
+        path.lineTo(width, bottom);
+        path.lineTo(0.0f, bottom);
+        path.closeSubPath();
+    }
+}
+
+void SpectrumDisplay::drawGrid()
+{
+    if (getWidth() <= 0 || getHeight() <= 0)
+        return;
+
+    grid = juce::Image(juce::Image::RGB, getWidth(), getHeight(), false);
+    juce::Graphics g(grid);
+
+    g.fillAll(backgroundColour);
+    g.setFont(juce::FontOptions(11.0f));
+
+    for (auto frequency : { 20.0f, 50.0f, 100.0f, 200.0f, 500.0f, 1000.0f, 2000.0f, 5000.0f, 10000.0f, 20000.0f })
+    {
+        auto x = getXForFrequency(frequency);
+        g.setColour(gridColour);
+        g.drawVerticalLine(juce::roundToInt(x), 0.0f, static_cast<float>(getHeight()));
+
+        auto text = frequency >= 1000.0f ? juce::String(frequency / 1000.0f, 0) + "k" : juce::String(frequency, 0);
+        g.setColour(labelColour);
+        g.drawText(text, juce::roundToInt(x) + 3, getHeight() - 16, 40, 14, juce::Justification::centredLeft);
+    }
+
+    for (auto decibels = 0.0f; decibels >= minDecibels; decibels -= 12.0f)
+    {
+        auto y = getYForDecibels(decibels);
+        g.setColour(gridColour);
+        g.drawHorizontalLine(juce::roundToInt(y), 0.0f, static_cast<float>(getWidth()));
+
+        g.setColour(labelColour);
+        g.drawText(juce::String(decibels, 0) + " dB", getWidth() - 48, juce::roundToInt(y) + 1, 44, 14, juce::Justification::centredRight);
+    }
+}
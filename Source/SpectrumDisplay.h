@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.h
+    The editor's analyzer view: pre and post EQ spectra over a log frequency
+    grid.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectrumAnalyzer.h"
+
+//==============================================================================
+/**
+    Runs the processor's SpectrumAnalyzer for as long as it exists and draws
+    what comes out of it, the input as a faint filled area and the output as a
+    line on top.
+
+    A timer capped at maxFramesPerSecond polls the analyzer and only repaints
+    when a new spectrum came in, so nothing gets redrawn while the transport is
+    stopped. The paths are rebuilt in place every frame and the grid is drawn
+    once per size into an image. Nothing here ever waits on the audio thread.
+*/
+class SpectrumDisplay : public juce::Component,
+                        private juce::Timer
+{
+public:
+    explicit SpectrumDisplay(SpectrumAnalyzer& analyzer);
+    ~SpectrumDisplay() override;
+
+    void setTapVisible(SpectrumAnalyzer::Tap tap, bool shouldBeVisible);
+    bool isTapVisible(SpectrumAnalyzer::Tap tap) const noexcept { return visible[static_cast<size_t>(tap)]; }
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    // where a frequency or a level ends up, for anything drawn on top of the spectrum
+    float getXForFrequency(float frequency) const noexcept;
+    float getYForDecibels(float decibels) const noexcept;
+
+    static constexpr float minDecibels = -96.0f;
+    static constexpr float maxDecibels = 6.0f;
+    static constexpr int maxFramesPerSecond = 30;
+
+private:
+    void timerCallback() override;
+    void updatePath(SpectrumAnalyzer::Tap tap);
+    void drawGrid();
+
+    SpectrumAnalyzer& analyzer;
+
+    std::array<SpectrumAnalyzer::Spectrum, SpectrumAnalyzer::numTaps> spectra;
+    std::array<juce::uint32, SpectrumAnalyzer::numTaps> serials{};
+    std::array<juce::Path, SpectrumAnalyzer::numTaps> paths;
+    std::array<bool, SpectrumAnalyzer::numTaps> visible{ { true, true } };
+
+    juce::Image grid;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumDisplay)
+};
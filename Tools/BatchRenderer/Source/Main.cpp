@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    CustomEQ Batch Renderer: renders WAV/AIFF files through the EQ chain from
+    the command line, several files at a time.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <map>
+#include "OfflineRenderer.h"
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "usage: CustomEQBatchRenderer [options] <file>...\n"
+                     "\n"
+                     "  --state <file>         start from a saved state, or a preset written by --save-state\n"
+                     "  --set \"<id>=<value>\"   set one parameter, e.g. --set \"LowCut Freq=80\" or --set \"Cut Mode=Linear Phase\".\n"
+                     "                         can be given any number of times, applied after --state\n"
+                     "  --output <folder>      where the rendered files go, next to the inputs with \"_eq\" added otherwise\n"
+                     "  --threads <n>          files rendered at once, one per core by default\n"
+                     "  --block <n>            samples per block, 4096 by default\n"
+                     "  --double               run the chain in double precision\n"
+                     "  --keep-tail            render what still rings past the end of the file\n"
+                     "  --save-state <file>    write the settings out as a preset, no files needed\n"
+                     "  --list-parameters      print every parameter with its current value\n";
+    }
+
+    juce::String describe(const RenderResult& result)
+    {
+        if (result.result.failed())
+            return result.input.getFileName() + ": " + result.result.getErrorMessage();
+
+        return result.input.getFileName() + " -> " + result.output.getFullPathName()
+             + "   " + juce::String(static_cast<double>(result.numSamples) / result.sampleRate, 1) + " s at "
+             + juce::String(result.sampleRate, 0) + " Hz in " + juce::String(result.seconds, 2) + " s, "
+             + juce::String(result.getRealtimeFactor(), 1) + "x real time";
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // the processor's parameter tree expects a message manager to exist, even though nothing here runs a message loop
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray arguments;
+
+    for (int i = 1; i < argc; ++i)
+        arguments.add(juce::CharPointer_UTF8(argv[i]));
+
+    if (arguments.isEmpty() || arguments.contains("--help") || arguments.contains("-h"))
+    {
+        printUsage();
+        return arguments.isEmpty() ? 1 : 0;
+    }
+
+    // the settings get built on this one and copied to the workers
+    CustomEQAudioProcessor settingsProcessor;
+
+    RenderOptions options;
+    auto numThreads = juce::SystemStats::getNumCpus();
+    juce::File saveStateFile;
+    auto shouldListParameters = false;
+    juce::Array<juce::File> files;
+    juce::StringArray overrides;
+
+    auto fail = [](const juce::String& message)
+    {
+        std::cerr << "error: " << message << "\n";
+        return 1;
+    };
+
+    for (int i = 0; i < arguments.size(); ++i)
+    {
+        auto argument = arguments[i];
+
+        // every option but the switches takes the next argument as its value
+        auto takeValue = [&arguments, &i]() -> juce::String
+        {
+            return i + 1 < arguments.size() ? arguments[++i] : juce::String();
+        };
+
+        if (argument == "--state")
+        {
+            auto result = loadStateFile(settingsProcessor, juce::File::getCurrentWorkingDirectory().getChildFile(takeValue()));
+
+            if (result.failed())
+                return fail(result.getErrorMessage());
+        }
+        else if (argument == "--set")              overrides.add(takeValue());
+        else if (argument == "--output")           options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(takeValue());
+        else if (argument == "--threads")          numThreads = takeValue().getIntValue();
+        else if (argument == "--block")            options.blockSize = takeValue().getIntValue();
+        else if (argument == "--double")           options.useDoublePrecision = true;
+        else if (argument == "--keep-tail")        options.keepTail = true;
+        else if (argument == "--save-state")       saveStateFile = juce::File::getCurrentWorkingDirectory().getChildFile(takeValue());
+        else if (argument == "--list-parameters")  shouldListParameters = true;
+        else if (argument.startsWith("--"))        return fail("unknown option " + argument);
+        else                                       files.add(juce::File::getCurrentWorkingDirectory().getChildFile(argument));
+    }
+
+    // the overrides go on top of the state, wherever they were on the command line
+    for (auto& assignment : overrides)
+    {
+        auto result = applyParameterOverride(settingsProcessor, assignment);
+
+        if (result.failed())
+            return fail(result.getErrorMessage());
+    }
+
+    if (numThreads < 1 || options.blockSize < 1)
+        return fail("--threads and --block need to be at least 1");
+
+    if (shouldListParameters)
+        std::cout << describeParameters(settingsProcessor);
+
+    if (saveStateFile != juce::File())
+    {
+        auto xml = settingsProcessor.apvts.copyState().createXml();
+
+        if (xml == nullptr || ! xml->writeTo(saveStateFile))
+            return fail("can't write " + saveStateFile.getFullPathName());
+    }
+
+    if (files.isEmpty())
+        return shouldListParameters || saveStateFile != juce::File() ? 0 : fail("no files to render");
+
+    for (auto& file : files)
+        if (! file.existsAsFile())
+            return fail("no such file " + file.getFullPathName());
+
+    // with --output, the same name from two folders goes to one file, and the workers would write over and delete
+    // each other's renders. the same input given twice does that too
+    std::map<juce::File, juce::File> outputs;
+
+    for (auto& file : files)
+    {
+        auto [existing, isNew] = outputs.emplace(OfflineRenderer::getOutputFile(file, options), file);
+
+        if (! isNew)
+            return fail(existing->second.getFullPathName() + " and " + file.getFullPathName() + " would both render to "
+                        + existing->first.getFullPathName());
+    }
+
+    BatchRenderer batch(settingsProcessor.apvts.copyState(), options, juce::jmin(numThreads, files.size()));
+
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    auto results = batch.render(files, [](const RenderResult& result)
+    {
+        (result.result.failed() ? std::cerr : std::cout) << describe(result) << std::endl;
+    });
+
+    auto seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    auto audioSeconds = 0.0;
+    auto numFailed = 0;
+
+    for (auto& result : results)
+    {
+        if (result.result.failed())
+            ++numFailed;
+        else
+            audioSeconds += static_cast<double>(result.numSamples) / result.sampleRate;
+    }
+
+    std::cout << "\n" << (files.size() - numFailed) << " of " << files.size() << " files, "
+              << juce::String(audioSeconds, 1) << " s of audio in " << juce::String(seconds, 2) << " s, "
+              << juce::String(seconds > 0.0 ? audioSeconds / seconds : 0.0, 1) << "x real time overall" << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Runs audio files through the plugin's processor, for rendering without a
+    host.
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+OfflineRenderer::OfflineRenderer(const juce::ValueTree& state, const RenderOptions& renderOptions)
+    : options(renderOptions)
+{
+    jassert(options.blockSize > 0);
+
+    formats.registerBasicFormats();
+    processor.apvts.replaceState(state.createCopy());
+}
+
+juce::File OfflineRenderer::getOutputFile(const juce::File& input, const RenderOptions& options)
+{
+    if (options.outputDirectory != juce::File())
+        return options.outputDirectory.getChildFile(input.getFileName());
+
+    return input.getParentDirectory().getChildFile(input.getFileNameWithoutExtension() + "_eq" + input.getFileExtension());
+}
+
+RenderResult OfflineRenderer::render(const juce::File& input)
+{
+    RenderResult renderResult;
+    renderResult.input = input;
+    renderResult.output = getOutputFile(input, options);
+
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    auto reader = createReader(input);
+
+    if (reader == nullptr)
+    {
+        renderResult.result = juce::Result::fail("can't read " + input.getFullPathName());
+        return renderResult;
+    }
+
+    renderResult.numSamples = reader->lengthInSamples;
+    renderResult.sampleRate = reader->sampleRate;
+
+    // --output pointing at the input's own folder would have us write over what we're reading
+    if (renderResult.output == input)
+    {
+        renderResult.result = juce::Result::fail("the output would overwrite " + input.getFullPathName());
+        return renderResult;
+    }
+
+    auto writer = createWriter(renderResult.output, *reader);
+
+    if (writer == nullptr)
+    {
+        renderResult.result = juce::Result::fail("can't write " + renderResult.output.getFullPathName());
+        return renderResult;
+    }
+
+    renderResult.result = prepare(*reader);
+
+    if (renderResult.result.wasOk())
+        renderResult.result = process(*reader, *writer);
+
+    processor.releaseResources();
+
+    // the writer finishes the header when it goes, that's part of the time too
+    writer.reset();
+    renderResult.seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    if (renderResult.result.failed())
+        renderResult.output.deleteFile();
+
+    return renderResult;
+}
+
+std::unique_ptr<juce::AudioFormatReader> OfflineRenderer::createReader(const juce::File& input)
+{
+    // wav and aiff can be read straight out of the mapped file, the OS pages it in as we go
+    if (auto* format = formats.findFormatForFileExtension(input.getFileExtension()))
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(input));
+
+        if (mapped != nullptr && mapped->mapEntireFile())
+            return mapped;
+    }
+
+    // anything else, or a file too big to map, gets streamed
+    return std::unique_ptr<juce::AudioFormatReader>(formats.createReaderFor(input));
+}
+
+std::unique_ptr<juce::AudioFormatWriter> OfflineRenderer::createWriter(const juce::File& output, const juce::AudioFormatReader& reader)
+{
+    auto* format = formats.findFormatForFileExtension(output.getFileExtension());
+
+    if (format == nullptr || ! output.getParentDirectory().createDirectory())
+        return nullptr;
+
+    // same depth as the input, a float file stays float
+    auto bitsPerSample = reader.usesFloatingPointData ? 32 : static_cast<int>(reader.bitsPerSample);
+
+    if (! format->getPossibleBitDepths().contains(bitsPerSample))
+        bitsPerSample = 24;
+
+    output.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(output.createOutputStream());
+
+    if (stream == nullptr)
+        return nullptr;
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), reader.sampleRate, reader.numChannels,
+                                                                            bitsPerSample, reader.metadataValues, 0));
+
+    // the writer owns the stream once it exists
+    if (writer != nullptr)
+        stream.release();
+
+    return writer;
+}
+
+juce::Result OfflineRenderer::prepare(const juce::AudioFormatReader& reader)
+{
+    auto numChannels = static_cast<int>(reader.numChannels);
+
+    // the processor takes any layout as long as the input and output match, the file just needs one of the right size
+    if (! processor.setBusesLayout(getLayoutForChannels(numChannels)))
+        return juce::Result::fail("can't run " + juce::String(numChannels) + " channels");
+
+    processor.setProcessingPrecision(options.useDoublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                : juce::AudioProcessor::singlePrecision);
+    processor.setNonRealtime(true);
+    processor.setRateAndBufferSizeDetails(reader.sampleRate, options.blockSize);
+    processor.prepareToPlay(reader.sampleRate, options.blockSize);
+
+    buffer.setSize(numChannels, options.blockSize);
+
+    if (options.useDoublePrecision)
+        preciseBuffer.setSize(numChannels, options.blockSize);
+
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::process(juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer)
+{
+    // the first latency samples out of the chain are its delay, not audio, so they get dropped and we feed
+    // that much silence past the end to make up for them, and the tail's worth on top with --keep-tail
+    auto latency = static_cast<juce::int64>(processor.getLatencySamples());
+    auto tail = options.keepTail ? static_cast<juce::int64>(std::ceil(processor.getTailLengthSeconds() * reader.sampleRate)) : 0;
+    auto numOutputSamples = reader.lengthInSamples + tail;
+
+    juce::int64 readPosition = 0, numWritten = 0;
+
+    while (numWritten < numOutputSamples)
+    {
+        // only ever ask the reader for what the file has. the memory mapped one fails a read past the end rather
+        // than padding it, so the silence out there is ours
+        auto numToRead = static_cast<int>(juce::jlimit<juce::int64>(0, options.blockSize, reader.lengthInSamples - readPosition));
+
+        if (numToRead > 0 && ! reader.read(&buffer, 0, numToRead, readPosition, true, true))
+            return juce::Result::fail("read error at sample " + juce::String(readPosition));
+
+        if (numToRead < options.blockSize)
+            buffer.clear(numToRead, options.blockSize - numToRead);
+
+        if (options.useDoublePrecision)
+        {
+            preciseBuffer.makeCopyOf(buffer, true);
+            processor.processBlock(preciseBuffer, midi);
+            buffer.makeCopyOf(preciseBuffer, true);
+        }
+        else
+        {
+            processor.processBlock(buffer, midi);
+        }
+
+        auto numSkipped = static_cast<int>(juce::jlimit<juce::int64>(0, options.blockSize, latency - readPosition));
+        auto numToWrite = static_cast<int>(juce::jmin<juce::int64>(options.blockSize - numSkipped, numOutputSamples - numWritten));
+        readPosition += options.blockSize;
+
+        if (numToWrite <= 0)
+            continue;
+
+        if (! writer.writeFromAudioSampleBuffer(buffer, numSkipped, numToWrite))
+            return juce::Result::fail("write error at sample " + juce::String(numWritten));
+
+        numWritten += numToWrite;
+    }
+
+    return juce::Result::ok();
+}
+
+//==============================================================================
+class BatchRenderer::Worker : public juce::ThreadPoolJob
+{
+public:
+    Worker(OfflineRenderer& rendererToUse, const juce::Array<juce::File>& filesToRender, std::atomic<int>& next,
+           std::vector<RenderResult>& resultsToFill, std::function<void(const RenderResult&)> finished)
+        : juce::ThreadPoolJob("CustomEQ Batch Renderer"),
+          renderer(rendererToUse), files(filesToRender), nextFile(next), results(resultsToFill), onFinished(std::move(finished))
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        for (auto index = nextFile++; index < files.size() && ! shouldExit(); index = nextFile++)
+        {
+            auto& result = results[static_cast<size_t>(index)];
+            result = renderer.render(files[index]);
+            onFinished(result);
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    OfflineRenderer& renderer;
+    const juce::Array<juce::File>& files;
+    std::atomic<int>& nextFile;
+    std::vector<RenderResult>& results;
+    std::function<void(const RenderResult&)> onFinished;
+};
+
+BatchRenderer::BatchRenderer(const juce::ValueTree& state, const RenderOptions& options, int numThreads)
+{
+    jassert(numThreads > 0);
+
+    // the processors all get built here on the message thread, the workers only ever render
+    for (int i = 0; i < numThreads; ++i)
+        renderers.push_back(std::make_unique<OfflineRenderer>(state, options));
+}
+
+std::vector<RenderResult> BatchRenderer::render(const juce::Array<juce::File>& files, Callback onFinished)
+{
+    std::vector<RenderResult> results(static_cast<size_t>(files.size()));
+    std::atomic<int> nextFile{ 0 };
+
+    auto finished = [this, &onFinished](const RenderResult& result)
+    {
+        const juce::ScopedLock lock(callbackLock);
+
+        if (onFinished != nullptr)
+            onFinished(result);
+    };
+
+    // declared before the pool, so the pool is gone before the jobs are
+    std::vector<std::unique_ptr<Worker>> workers;
+    auto numWorkers = juce::jmin(static_cast<int>(renderers.size()), files.size());
+    juce::ThreadPool pool(juce::jmax(1, numWorkers));
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(*renderers[static_cast<size_t>(i)], files, nextFile, results, finished));
+        pool.addJob(workers.back().get(), false);
+    }
+
+    for (auto& worker : workers)
+        pool.waitForJobToFinish(worker.get(), -1);
+
+    return results;
+}
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Runs audio files through the plugin's processor, for rendering without a
+    host. One renderer owns one processor, so each worker thread gets its own.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Shared/ProcessorSettings.h"
+
+// how a batch gets rendered, the same for every file in it
+struct RenderOptions
+{
+    // empty means next to the input, with "_eq" added to the name
+    juce::File outputDirectory;
+
+    // samples per processBlock() call, also how much of the file is read at a time
+    int blockSize{ 4096 };
+
+    // runs the chain through the double processBlock(), the float one otherwise
+    bool useDoublePrecision{ false };
+
+    // renders what's still ringing after the end of the file instead of cutting it off there
+    bool keepTail{ false };
+};
+
+struct RenderResult
+{
+    juce::File input, output;
+    juce::Result result{ juce::Result::ok() };
+
+    juce::int64 numSamples{ 0 };
+    double sampleRate{ 0.0 };
+
+    // wall clock, reading and writing included
+    double seconds{ 0.0 };
+
+    // how many seconds of audio a second of rendering gets through
+    double getRealtimeFactor() const noexcept
+    {
+        return seconds > 0.0 && sampleRate > 0.0 ? (static_cast<double>(numSamples) / sampleRate) / seconds : 0.0;
+    }
+};
+
+//==============================================================================
+/**
+    Renders one file at a time through its own CustomEQAudioProcessor. The file
+    is streamed a block at a time, memory mapped when the format allows it, and
+    the output comes out latency compensated, so it lines up with the input
+    sample for sample.
+
+    Construct and load the state on the message thread, render() can then run on
+    any one thread.
+*/
+class OfflineRenderer
+{
+public:
+    OfflineRenderer(const juce::ValueTree& state, const RenderOptions& options);
+
+    RenderResult render(const juce::File& input);
+
+    // where render() writes the output for an input, main() uses it to catch two inputs landing on the same file
+    static juce::File getOutputFile(const juce::File& input, const RenderOptions& options);
+
+private:
+    std::unique_ptr<juce::AudioFormatReader> createReader(const juce::File& input);
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(const juce::File& output, const juce::AudioFormatReader& reader);
+
+    juce::Result prepare(const juce::AudioFormatReader& reader);
+    juce::Result process(juce::AudioFormatReader& reader, juce::AudioFormatWriter& writer);
+
+    RenderOptions options;
+    juce::AudioFormatManager formats;
+    CustomEQAudioProcessor processor;
+
+    juce::AudioBuffer<float> buffer;
+    juce::AudioBuffer<double> preciseBuffer;
+    juce::MidiBuffer midi;
+
+    JUCE_DECLARE_NON_COPYABLE(OfflineRenderer)
+};
+
+//==============================================================================
+/**
+    Renders a list of files on a pool of threads, one OfflineRenderer per thread.
+    The threads take the next file off the list as they finish one, so a long
+    file doesn't hold up the short ones behind it.
+*/
+class BatchRenderer
+{
+public:
+    BatchRenderer(const juce::ValueTree& state, const RenderOptions& options, int numThreads);
+
+    // called from the worker threads as each file finishes, one at a time
+    using Callback = std::function<void(const RenderResult&)>;
+
+    // blocks until every file is done, the results are in the order of the files
+    std::vector<RenderResult> render(const juce::Array<juce::File>& files, Callback onFinished);
+
+private:
+    class Worker;
+
+    std::vector<std::unique_ptr<OfflineRenderer>> renderers;
+    juce::CriticalSection callbackLock;
+
+    JUCE_DECLARE_NON_COPYABLE(BatchRenderer)
+};
@@ -0,0 +1,302 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    CustomEQ Benchmark: times processBlock() across slopes, block sizes,
+    sample rates, channel counts and parameter automation.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "ProcessorBenchmark.h"
+#include "StateBenchmark.h"
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "usage: CustomEQBenchmark [options]\n"
+                     "\n"
+                     "  --slopes <list>        dB/oct of the cuts, e.g. 12,48,96. all five by default\n"
+                     "  --blocks <list>        block sizes, 16,64,256,1024,4096 by default\n"
+                     "  --rates <list>         sample rates, 44100,48000,96000,192000 by default\n"
+                     "  --channels <list>      channel counts, 1,2,6 by default\n"
+                     "  --bands <list>         parametric bands switched on, 0 by default. with 0 in the list too,\n"
+                     "                         e.g. 0,1,4,16, it prints what each band adds per sample\n"
+                     "  --automation <list>    static, all (every parameter at once), each (one case per parameter)\n"
+                     "                         or parameter ids. static,all by default\n"
+                     "  --full                 every power of two from 16 to 4096, every common rate up to 192k,\n"
+                     "                         1 to 16 channels and static,each,all\n"
+                     "  --seconds <s>          audio timed per case, 0.5 by default\n"
+                     "  --state <file>         start every case from a saved state\n"
+                     "  --set \"<id>=<value>\"   set one parameter for every case, e.g. --set \"Oversampling=2x\"\n"
+                     "  --double               time the double precision processBlock()\n"
+                     "  --save-restore <n>     instead of processBlock(), time saving and restoring the state of\n"
+                     "                         n prepared instances, binary against xml. uses the first --rates\n"
+                     "                         and --blocks entry\n"
+                     "  --json <file>          write the results as json\n"
+                     "  --csv <file>           write the results as csv\n"
+                     "  --baseline <file>      compare against the json of an earlier run, exits with 1 on a regression\n"
+                     "  --tolerance <percent>  how much slower a case may get before it counts, 10 by default\n";
+    }
+
+    juce::StringArray splitList(const juce::String& list)
+    {
+        auto items = juce::StringArray::fromTokens(list, ",", "");
+        items.trim();
+        items.removeEmptyStrings();
+        return items;
+    }
+
+    juce::Array<Slope> parseSlopes(const juce::String& list)
+    {
+        juce::Array<Slope> slopes;
+
+        for (auto& item : splitList(list))
+        {
+            switch (item.getIntValue())
+            {
+            case 12: slopes.add(Slope_12); break;
+            case 24: slopes.add(Slope_24); break;
+            case 36: slopes.add(Slope_36); break;
+            case 48: slopes.add(Slope_48); break;
+            case 96: slopes.add(Slope_96); break;
+            default: break;
+            }
+        }
+
+        return slopes;
+    }
+
+    // unlike the other lists 0 is allowed here, it's the baseline the marginal cost is taken against
+    juce::Array<int> parseBandCounts(const juce::String& list)
+    {
+        juce::Array<int> counts;
+
+        for (auto& item : splitList(list))
+            if (item.containsOnly("0123456789") && item.getIntValue() <= maxBands)
+                counts.add(item.getIntValue());
+
+        return counts;
+    }
+
+    template <typename Type>
+    juce::Array<Type> parseNumbers(const juce::String& list)
+    {
+        juce::Array<Type> numbers;
+
+        for (auto& item : splitList(list))
+            if (item.getDoubleValue() > 0.0)
+                numbers.add(static_cast<Type>(item.getDoubleValue()));
+
+        return numbers;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // the processor's parameter tree expects a message manager to exist, even though nothing here runs a message loop
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray arguments;
+
+    for (int i = 1; i < argc; ++i)
+        arguments.add(juce::CharPointer_UTF8(argv[i]));
+
+    if (arguments.contains("--help") || arguments.contains("-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    auto fail = [](const juce::String& message)
+    {
+        std::cerr << "error: " << message << "\n";
+        return 1;
+    };
+
+    CustomEQAudioProcessor settingsProcessor;
+
+    juce::Array<Slope> slopes{ Slope_12, Slope_24, Slope_36, Slope_48, Slope_96 };
+    juce::Array<int> blockSizes{ 16, 64, 256, 1024, 4096 };
+    juce::Array<double> sampleRates{ 44100.0, 48000.0, 96000.0, 192000.0 };
+    juce::Array<int> channelCounts{ 1, 2, 6 };
+    juce::Array<int> bandCounts{ 0 };
+    juce::StringArray automation{ "static", "all" };
+
+    BenchmarkOptions options;
+    juce::File jsonFile, csvFile, baselineFile;
+    auto tolerance = 10.0;
+    auto stateInstances = 0;
+
+    for (int i = 0; i < arguments.size(); ++i)
+    {
+        auto argument = arguments[i];
+
+        auto takeValue = [&arguments, &i]() -> juce::String
+        {
+            return i + 1 < arguments.size() ? arguments[++i] : juce::String();
+        };
+
+        auto takeFile = [&takeValue]
+        {
+            return juce::File::getCurrentWorkingDirectory().getChildFile(takeValue());
+        };
+
+        if (argument == "--full")
+        {
+            blockSizes = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+            sampleRates = { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+            channelCounts = { 1, 2, 4, 6, 8, 12, 16 };
+            automation = { "static", "each", "all" };
+        }
+        else if (argument == "--state")
+        {
+            auto result = loadStateFile(settingsProcessor, takeFile());
+
+            if (result.failed())
+                return fail(result.getErrorMessage());
+        }
+        else if (argument == "--set")
+        {
+            auto result = applyParameterOverride(settingsProcessor, takeValue());
+
+            if (result.failed())
+                return fail(result.getErrorMessage());
+        }
+        else if (argument == "--slopes")      slopes = parseSlopes(takeValue());
+        else if (argument == "--blocks")      blockSizes = parseNumbers<int>(takeValue());
+        else if (argument == "--rates")       sampleRates = parseNumbers<double>(takeValue());
+        else if (argument == "--channels")    channelCounts = parseNumbers<int>(takeValue());
+        else if (argument == "--bands")       bandCounts = parseBandCounts(takeValue());
+        else if (argument == "--automation")  automation = splitList(takeValue());
+        else if (argument == "--seconds")     options.secondsPerCase = takeValue().getDoubleValue();
+        else if (argument == "--double")      options.useDoublePrecision = true;
+        else if (argument == "--save-restore") stateInstances = takeValue().getIntValue();
+        else if (argument == "--json")        jsonFile = takeFile();
+        else if (argument == "--csv")         csvFile = takeFile();
+        else if (argument == "--baseline")    baselineFile = takeFile();
+        else if (argument == "--tolerance")   tolerance = takeValue().getDoubleValue();
+        else                                  return fail("unknown option " + argument);
+    }
+
+    if (slopes.isEmpty() || blockSizes.isEmpty() || sampleRates.isEmpty() || channelCounts.isEmpty() || bandCounts.isEmpty() || automation.isEmpty())
+        return fail("nothing to run, every list needs at least one entry");
+
+    if (options.secondsPerCase <= 0.0)
+        return fail("--seconds needs to be more than 0");
+
+    if (stateInstances > 0)
+    {
+        StateBenchmark stateBenchmark(stateInstances, sampleRates[0], blockSizes[0]);
+        juce::Array<juce::var> stateResults;
+
+        for (auto& result : { stateBenchmark.runBinary(), stateBenchmark.runXml() })
+        {
+            stateResults.add(result.toVar());
+
+            std::cout << result.format.paddedRight(' ', 8)
+                      << juce::String(result.stateBytes).paddedLeft(' ', 6) << " bytes"
+                      << "   save " << juce::String(result.meanSaveMicroseconds, 2) << " us (max " << juce::String(result.maxSaveMicroseconds, 2) << ")"
+                      << "   restore " << juce::String(result.meanRestoreMicroseconds, 2) << " us (max " << juce::String(result.maxRestoreMicroseconds, 2) << ")"
+                      << "   " << juce::String(result.designPassesPerRestore, 2) << " design passes per restore" << std::endl;
+        }
+
+        if (jsonFile == juce::File())
+            return 0;
+
+        auto* report = new juce::DynamicObject();
+        report->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+        report->setProperty("state", stateResults);
+
+        if (! jsonFile.replaceWithText(juce::JSON::toString(juce::var(report))))
+            return fail("can't write " + jsonFile.getFullPathName());
+
+        return 0;
+    }
+
+    juce::var baseline;
+
+    if (baselineFile != juce::File())
+    {
+        baseline = juce::JSON::parse(baselineFile);
+
+        if (baseline["results"].getArray() == nullptr)
+            return fail("no results in " + baselineFile.getFullPathName());
+    }
+
+    options.state = settingsProcessor.apvts.copyState();
+    ProcessorBenchmark benchmark(options);
+
+    // "each" turns into one case per parameter, anything else has to be a parameter id
+    juce::StringArray automatedParameters;
+
+    for (auto& entry : automation)
+    {
+        if (entry == "static")
+            automatedParameters.add({});
+        else if (entry == "all")
+            automatedParameters.add(BenchmarkCase::allParameters);
+        else if (entry == "each")
+            automatedParameters.addArray(benchmark.getAutomatableParameters());
+        else if (settingsProcessor.apvts.getParameter(entry) != nullptr)
+            automatedParameters.add(entry);
+        else
+            return fail("no parameter called \"" + entry + "\"");
+    }
+
+    std::vector<BenchmarkResult> results;
+
+    // every combination, the band counts next to each other so the marginal cost compares like with like
+    std::vector<BenchmarkCase> cases;
+
+    for (auto slope : slopes)
+        for (auto sampleRate : sampleRates)
+            for (auto numChannels : channelCounts)
+                for (auto blockSize : blockSizes)
+                    for (auto numBands : bandCounts)
+                        for (auto& automatedParameter : automatedParameters)
+                            cases.push_back({ slope, blockSize, sampleRate, numChannels, numBands, automatedParameter });
+
+    for (auto& benchmarkCase : cases)
+    {
+        auto result = benchmark.run(benchmarkCase);
+        results.push_back(result);
+
+        std::cout << result.benchmarkCase.getId().paddedRight(' ', 72)
+                  << juce::String(result.nanosecondsPerSample, 2).paddedLeft(' ', 9) << " ns/sample"
+                  << juce::String(result.nanosecondsPerBlock / 1000.0, 2).paddedLeft(' ', 10) << " us/block"
+                  << "   p99 " << juce::String(result.p99BlockNanoseconds / 1000.0, 2) << " us"
+                  << "   max " << juce::String(result.maxBlockNanoseconds / 1000.0, 2) << " us"
+                  << "   " << juce::String(100.0 * result.realtimeLoad, 2) << "% of real time" << std::endl;
+    }
+
+    auto bandCost = describeBandCost(results);
+
+    if (! bandCost.isEmpty())
+        std::cout << "\nmarginal cost of a band:\n" << bandCost.joinIntoString("\n") << std::endl;
+
+    if (jsonFile != juce::File() && ! jsonFile.replaceWithText(juce::JSON::toString(makeReport(results))))
+        return fail("can't write " + jsonFile.getFullPathName());
+
+    if (csvFile != juce::File() && ! csvFile.replaceWithText(makeCsv(results)))
+        return fail("can't write " + csvFile.getFullPathName());
+
+    if (baselineFile == juce::File())
+        return 0;
+
+    auto regressions = findRegressions(results, baseline, tolerance / 100.0);
+
+    if (regressions.isEmpty())
+    {
+        std::cout << "\nno regressions against " << baselineFile.getFileName() << std::endl;
+        return 0;
+    }
+
+    std::cout << "\n" << regressions.size() << " regressions against " << baselineFile.getFileName() << ":\n"
+              << regressions.joinIntoString("\n") << std::endl;
+    return 1;
+}
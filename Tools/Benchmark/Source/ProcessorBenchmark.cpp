@@ -0,0 +1,336 @@
+/*
+  ==============================================================================
+
+    ProcessorBenchmark.cpp
+    Times CustomEQAudioProcessor::processBlock() headlessly.
+
+  ==============================================================================
+*/
+
+#include <numeric>
+#include "ProcessorBenchmark.h"
+
+namespace
+{
+    int getSlopeDecibels(Slope slope) noexcept
+    {
+        switch (slope)
+        {
+        case Slope_12: return 12;
+        case Slope_24: return 24;
+        case Slope_36: return 36;
+        case Slope_48: return 48;
+        case Slope_96: return 96;
+        }
+        jassertfalse; // unexpected slope
+        return 12;
+    }
+
+    // the nearest rank, the same way on every machine
+    double getPercentile(const std::vector<double>& sorted, double percentile) noexcept
+    {
+        jassert(! sorted.empty());
+        auto rank = static_cast<size_t>(std::ceil(percentile * static_cast<double>(sorted.size())));
+        return sorted[juce::jlimit<size_t>(1, sorted.size(), rank) - 1];
+    }
+}
+
+juce::String BenchmarkCase::getId() const
+{
+    auto automation = automatedParameter.isEmpty() ? juce::String("static")
+                    : automatedParameter == allParameters ? juce::String("all")
+                    : automatedParameter;
+
+    // no bands leaves the id as it was before there were any, so older baselines still match
+    return "slope=" + juce::String(getSlopeDecibels(slope)) + " block=" + juce::String(blockSize)
+         + " rate=" + juce::String(sampleRate, 0) + " channels=" + juce::String(numChannels)
+         + (numBands > 0 ? " bands=" + juce::String(numBands) : juce::String())
+         + " automation=" + automation;
+}
+
+juce::var BenchmarkResult::toVar() const
+{
+    auto* object = new juce::DynamicObject();
+    object->setProperty("id", benchmarkCase.getId());
+    object->setProperty("slope", getSlopeDecibels(benchmarkCase.slope));
+    object->setProperty("blockSize", benchmarkCase.blockSize);
+    object->setProperty("sampleRate", benchmarkCase.sampleRate);
+    object->setProperty("channels", benchmarkCase.numChannels);
+    object->setProperty("bands", benchmarkCase.numBands);
+    object->setProperty("automation", benchmarkCase.automatedParameter);
+    object->setProperty("blocks", numBlocks);
+    object->setProperty("nsPerSample", nanosecondsPerSample);
+    object->setProperty("nsPerBlock", nanosecondsPerBlock);
+    object->setProperty("medianBlockNs", medianBlockNanoseconds);
+    object->setProperty("p99BlockNs", p99BlockNanoseconds);
+    object->setProperty("maxBlockNs", maxBlockNanoseconds);
+    object->setProperty("realtimeLoad", realtimeLoad);
+    return juce::var(object);
+}
+
+//==============================================================================
+ProcessorBenchmark::ProcessorBenchmark(const BenchmarkOptions& benchmarkOptions)
+    : options(benchmarkOptions)
+{
+    jassert(options.secondsPerCase > 0.0);
+}
+
+juce::StringArray ProcessorBenchmark::getAutomatableParameters() const
+{
+    CustomEQAudioProcessor processor;
+    juce::StringArray parameterIDs;
+
+    for (auto* parameter : processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            parameterIDs.add(ranged->getParameterID());
+
+    return parameterIDs;
+}
+
+BenchmarkResult ProcessorBenchmark::run(const BenchmarkCase& benchmarkCase)
+{
+    CustomEQAudioProcessor processor;
+    setUpProcessor(processor, benchmarkCase);
+
+    auto blockSize = benchmarkCase.blockSize;
+    auto blocksPerSecond = benchmarkCase.sampleRate / blockSize;
+    auto numWarmUpBlocks = static_cast<int>(std::ceil(options.warmUpSeconds * blocksPerSecond));
+    auto numBlocks = juce::jmax(100, static_cast<int>(std::ceil(options.secondsPerCase * blocksPerSecond)));
+    auto blocksPerSweep = juce::jmax(2, juce::roundToInt(blocksPerSecond));
+
+    // a second of noise, different on every channel so the dual mono shortcut never applies, played in a loop
+    juce::AudioBuffer<float> noise(benchmarkCase.numChannels, juce::jmax(blockSize, juce::roundToInt(benchmarkCase.sampleRate)));
+    fillNoise(noise);
+
+    juce::AudioBuffer<float> buffer(benchmarkCase.numChannels, blockSize);
+    juce::AudioBuffer<double> preciseBuffer(options.useDoublePrecision ? benchmarkCase.numChannels : 0, blockSize);
+    juce::MidiBuffer midi;
+
+    std::vector<double> blockNanoseconds;
+    blockNanoseconds.reserve(static_cast<size_t>(numBlocks));
+    auto noisePosition = 0;
+
+    for (int block = 0; block < numWarmUpBlocks + numBlocks; ++block)
+    {
+        automate(processor, benchmarkCase, block, blocksPerSweep);
+
+        if (noisePosition + blockSize > noise.getNumSamples())
+            noisePosition = 0;
+
+        for (int channel = 0; channel < benchmarkCase.numChannels; ++channel)
+            buffer.copyFrom(channel, 0, noise, channel, noisePosition, blockSize);
+
+        noisePosition += blockSize;
+
+        if (options.useDoublePrecision)
+            preciseBuffer.makeCopyOf(buffer, true);
+
+        auto start = juce::Time::getHighResolutionTicks();
+
+        if (options.useDoublePrecision)
+            processor.processBlock(preciseBuffer, midi);
+        else
+            processor.processBlock(buffer, midi);
+
+        auto end = juce::Time::getHighResolutionTicks();
+
+        if (block >= numWarmUpBlocks)
+            blockNanoseconds.push_back(juce::Time::highResolutionTicksToSeconds(end - start) * 1.0e9);
+    }
+
+    processor.releaseResources();
+
+    BenchmarkResult result;
+    result.benchmarkCase = benchmarkCase;
+    result.numBlocks = numBlocks;
+
+    auto total = std::accumulate(blockNanoseconds.begin(), blockNanoseconds.end(), 0.0);
+    result.nanosecondsPerBlock = total / numBlocks;
+    result.nanosecondsPerSample = result.nanosecondsPerBlock / blockSize;
+    result.realtimeLoad = result.nanosecondsPerBlock / (1.0e9 / blocksPerSecond);
+
+    std::sort(blockNanoseconds.begin(), blockNanoseconds.end());
+    result.medianBlockNanoseconds = getPercentile(blockNanoseconds, 0.5);
+    result.p99BlockNanoseconds = getPercentile(blockNanoseconds, 0.99);
+    result.maxBlockNanoseconds = blockNanoseconds.back();
+
+    return result;
+}
+
+void ProcessorBenchmark::setUpProcessor(CustomEQAudioProcessor& processor, const BenchmarkCase& benchmarkCase)
+{
+    if (options.state.isValid())
+        processor.apvts.replaceState(options.state.createCopy());
+
+    // the side's slopes too, so a Mid/Side run (--set "Stereo Mode=Mid/Side") has both paths as steep as the case
+    for (auto* parameterID : { "LowCut Slope", "HighCut Slope", "Side LowCut Slope", "Side HighCut Slope" })
+    {
+        auto* parameter = processor.apvts.getParameter(parameterID);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(static_cast<float>(benchmarkCase.slope)));
+    }
+
+    for (int band = 0; band < juce::jmin(benchmarkCase.numBands, maxBands); ++band)
+    {
+        auto setValue = [&processor, band](const juce::String& name, float value)
+        {
+            auto* parameter = processor.apvts.getParameter(getBandParameterID(band, name));
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        };
+
+        setValue("Type", static_cast<float>(BandType::BandPeak));
+        setValue("Freq", 40.0f * std::pow(2.0f, 8.0f * static_cast<float>(band) / static_cast<float>(maxBands)));
+        setValue("Gain", 3.0f);
+    }
+
+    auto isLayoutSupported = processor.setBusesLayout(getLayoutForChannels(benchmarkCase.numChannels));
+    jassert(isLayoutSupported); // every channel count should be fine, only a disabled bus isn't
+    juce::ignoreUnused(isLayoutSupported);
+
+    processor.setProcessingPrecision(options.useDoublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                : juce::AudioProcessor::singlePrecision);
+    processor.setRateAndBufferSizeDetails(benchmarkCase.sampleRate, benchmarkCase.blockSize);
+    processor.prepareToPlay(benchmarkCase.sampleRate, benchmarkCase.blockSize);
+}
+
+void ProcessorBenchmark::automate(CustomEQAudioProcessor& processor, const BenchmarkCase& benchmarkCase, int blockIndex, int blocksPerSweep)
+{
+    if (benchmarkCase.automatedParameter.isEmpty())
+        return;
+
+    // a triangle over the whole range, up and back down once per sweep
+    auto phase = static_cast<float>(blockIndex % blocksPerSweep) / static_cast<float>(blocksPerSweep);
+    auto value = phase < 0.5f ? 2.0f * phase : 2.0f - 2.0f * phase;
+
+    if (benchmarkCase.automatedParameter != BenchmarkCase::allParameters)
+    {
+        if (auto* parameter = processor.apvts.getParameter(benchmarkCase.automatedParameter))
+            parameter->setValueNotifyingHost(value);
+
+        return;
+    }
+
+    for (auto* parameter : processor.getParameters())
+        parameter->setValueNotifyingHost(value);
+}
+
+void ProcessorBenchmark::fillNoise(juce::AudioBuffer<float>& buffer)
+{
+    auto gain = juce::Decibels::decibelsToGain(-12.0f);
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        auto* samples = buffer.getWritePointer(channel);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            samples[i] = gain * (2.0f * random.nextFloat() - 1.0f);
+    }
+}
+
+//==============================================================================
+juce::var makeReport(const std::vector<BenchmarkResult>& results)
+{
+    auto* machine = new juce::DynamicObject();
+    machine->setProperty("cpu", juce::SystemStats::getCpuModel());
+    machine->setProperty("cores", juce::SystemStats::getNumCpus());
+    machine->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    machine->setProperty("juce", juce::SystemStats::getJUCEVersion());
+
+    juce::Array<juce::var> cases;
+
+    for (auto& result : results)
+        cases.add(result.toVar());
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    report->setProperty("machine", juce::var(machine));
+    report->setProperty("results", cases);
+    return juce::var(report);
+}
+
+juce::String makeCsv(const std::vector<BenchmarkResult>& results)
+{
+    juce::String csv("id,slope,blockSize,sampleRate,channels,bands,automation,blocks,nsPerSample,nsPerBlock,medianBlockNs,p99BlockNs,maxBlockNs,realtimeLoad\n");
+
+    for (auto& result : results)
+    {
+        auto& benchmarkCase = result.benchmarkCase;
+
+        csv << "\"" << benchmarkCase.getId() << "\"," << getSlopeDecibels(benchmarkCase.slope) << "," << benchmarkCase.blockSize << ","
+            << juce::String(benchmarkCase.sampleRate, 0) << "," << benchmarkCase.numChannels << "," << benchmarkCase.numBands
+            << ",\"" << benchmarkCase.automatedParameter << "\","
+            << result.numBlocks << "," << juce::String(result.nanosecondsPerSample, 3) << "," << juce::String(result.nanosecondsPerBlock, 1) << ","
+            << juce::String(result.medianBlockNanoseconds, 1) << "," << juce::String(result.p99BlockNanoseconds, 1) << ","
+            << juce::String(result.maxBlockNanoseconds, 1) << "," << juce::String(result.realtimeLoad, 6) << "\n";
+    }
+
+    return csv;
+}
+
+juce::StringArray describeBandCost(const std::vector<BenchmarkResult>& results)
+{
+    juce::StringArray lines;
+
+    for (auto& result : results)
+    {
+        if (result.benchmarkCase.numBands == 0)
+            continue;
+
+        auto withoutBands = result.benchmarkCase;
+        withoutBands.numBands = 0;
+        auto baselineId = withoutBands.getId();
+
+        for (auto& other : results)
+        {
+            if (other.benchmarkCase.getId() != baselineId)
+                continue;
+
+            auto perBand = (result.nanosecondsPerSample - other.nanosecondsPerSample) / result.benchmarkCase.numBands;
+            lines.add(result.benchmarkCase.getId() + ": " + juce::String(perBand, 3) + " ns/sample per band");
+            break;
+        }
+    }
+
+    return lines;
+}
+
+juce::StringArray findRegressions(const std::vector<BenchmarkResult>& results, const juce::var& baseline, double tolerance)
+{
+    juce::StringArray regressions;
+    const auto* baselineResults = baseline["results"].getArray();
+
+    if (baselineResults == nullptr)
+        return regressions;
+
+    auto describe = [tolerance](const juce::String& name, double before, double after) -> juce::String
+    {
+        if (before <= 0.0 || after <= before * (1.0 + tolerance))
+            return {};
+
+        return name + " " + juce::String(before, 1) + " -> " + juce::String(after, 1)
+             + " (+" + juce::String(100.0 * (after / before - 1.0), 0) + "%)";
+    };
+
+    for (auto& result : results)
+    {
+        auto id = result.benchmarkCase.getId();
+
+        for (auto& before : *baselineResults)
+        {
+            if (before["id"].toString() != id)
+                continue;
+
+            // the max is one block and mostly down to the OS, only the mean and the p99 are steady enough to hold a release to
+            juce::StringArray changes;
+            changes.add(describe("ns/sample", before["nsPerSample"], result.nanosecondsPerSample));
+            changes.add(describe("p99 ns", before["p99BlockNs"], result.p99BlockNanoseconds));
+            changes.removeEmptyStrings();
+
+            if (! changes.isEmpty())
+                regressions.add(id + ": " + changes.joinIntoString(", "));
+
+            break;
+        }
+    }
+
+    return regressions;
+}
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    ProcessorBenchmark.h
+    Times CustomEQAudioProcessor::processBlock() headlessly, one case per
+    slope, block size, sample rate, channel count and automated parameter.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Shared/ProcessorSettings.h"
+
+// one point of the matrix
+struct BenchmarkCase
+{
+    Slope slope{ Slope::Slope_12 };
+    int blockSize{ 512 };
+    double sampleRate{ 48000.0 };
+    int numChannels{ 2 };
+
+    // how many parametric bands are switched on, Peaks at +3 dB spread over the spectrum
+    int numBands{ 0 };
+
+    // the parameter that moves every block, empty for static parameters, allParameters for every one of them at once
+    juce::String automatedParameter;
+
+    static constexpr const char* allParameters = "*";
+
+    // the same for every run of the same case, so results from two releases can be matched up
+    juce::String getId() const;
+};
+
+struct BenchmarkResult
+{
+    BenchmarkCase benchmarkCase;
+    int numBlocks{ 0 };
+
+    double nanosecondsPerSample{ 0.0 };
+    double nanosecondsPerBlock{ 0.0 };
+    double medianBlockNanoseconds{ 0.0 };
+    double p99BlockNanoseconds{ 0.0 };
+    double maxBlockNanoseconds{ 0.0 };
+
+    // the mean block time as a share of how long the block lasts in real time, per channel count that's the CPU a host would see
+    double realtimeLoad{ 0.0 };
+
+    juce::var toVar() const;
+};
+
+// how every case gets run
+struct BenchmarkOptions
+{
+    // parameters applied before every case, the slope of the case goes on top
+    juce::ValueTree state;
+
+    // how much audio each case times, after the warm up
+    double secondsPerCase{ 0.5 };
+    double warmUpSeconds{ 0.1 };
+
+    bool useDoublePrecision{ false };
+};
+
+//==============================================================================
+/**
+    Runs one case at a time on a fresh processor, so nothing one case did (a
+    cache warmed up, a gated chain) carries over into the next.
+
+    The input is white noise at -12 dBFS, refreshed before every block outside
+    the timed part, so the gate never kicks in and the chain always does its full
+    work. Only the processBlock() call is timed.
+
+    Automation sweeps the parameter up and down its whole range once a second,
+    with a new value every block, the way a host drawing an automation curve
+    would. The designer thread picks it up as it would in a session.
+
+    Construct and run on the message thread.
+*/
+class ProcessorBenchmark
+{
+public:
+    explicit ProcessorBenchmark(const BenchmarkOptions& options);
+
+    BenchmarkResult run(const BenchmarkCase& benchmarkCase);
+
+    // ids of every parameter that can be automated, for expanding "each" on the command line
+    juce::StringArray getAutomatableParameters() const;
+
+private:
+    void setUpProcessor(CustomEQAudioProcessor& processor, const BenchmarkCase& benchmarkCase);
+    void automate(CustomEQAudioProcessor& processor, const BenchmarkCase& benchmarkCase, int blockIndex, int blocksPerSweep);
+    void fillNoise(juce::AudioBuffer<float>& buffer);
+
+    BenchmarkOptions options;
+    juce::Random random{ 0x5eed };
+
+    JUCE_DECLARE_NON_COPYABLE(ProcessorBenchmark)
+};
+
+//==============================================================================
+// the whole run as json: the machine it ran on and one object per case
+juce::var makeReport(const std::vector<BenchmarkResult>& results);
+juce::String makeCsv(const std::vector<BenchmarkResult>& results);
+
+// what each switched on band adds per sample, against the same case with no bands, one line per case that has bands
+juce::StringArray describeBandCost(const std::vector<BenchmarkResult>& results);
+
+// cases whose mean or p99 got more than tolerance (0.1 is 10%) slower than in the baseline report, one line each
+juce::StringArray findRegressions(const std::vector<BenchmarkResult>& results, const juce::var& baseline, double tolerance);
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    StateBenchmark.cpp
+    Times getStateInformation() and setStateInformation() per instance, the
+    binary state against the parameter tree as xml.
+
+  ==============================================================================
+*/
+
+#include <numeric>
+#include "StateBenchmark.h"
+
+namespace
+{
+    double ticksToMicroseconds(juce::int64 ticks) noexcept
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6;
+    }
+
+    // the designers run on their own thread, give them until nothing has been published for a while
+    void waitForDesigners(std::vector<std::unique_ptr<CustomEQAudioProcessor>>& processors, std::vector<juce::uint32>& serials)
+    {
+        constexpr int quietMilliseconds = 100;
+        constexpr int timeoutMilliseconds = 5000;
+
+        PublishedCascade published;
+        auto lastChange = juce::Time::getMillisecondCounter();
+        auto start = lastChange;
+
+        while (juce::Time::getMillisecondCounter() - lastChange < quietMilliseconds
+               && juce::Time::getMillisecondCounter() - start < timeoutMilliseconds)
+        {
+            for (size_t i = 0; i < processors.size(); ++i)
+                if (processors[i]->getPublishedCascade(published, serials[i]))
+                    lastChange = juce::Time::getMillisecondCounter();
+
+            juce::Thread::sleep(5);
+        }
+    }
+}
+
+juce::var StateBenchmarkResult::toVar() const
+{
+    auto* object = new juce::DynamicObject();
+    object->setProperty("format", format);
+    object->setProperty("instances", numInstances);
+    object->setProperty("stateBytes", stateBytes);
+    object->setProperty("meanSaveUs", meanSaveMicroseconds);
+    object->setProperty("maxSaveUs", maxSaveMicroseconds);
+    object->setProperty("meanRestoreUs", meanRestoreMicroseconds);
+    object->setProperty("maxRestoreUs", maxRestoreMicroseconds);
+    object->setProperty("designPassesPerRestore", designPassesPerRestore);
+    return juce::var(object);
+}
+
+//==============================================================================
+StateBenchmark::StateBenchmark(int instances, double rate, int block)
+    : numInstances(instances), sampleRate(rate), blockSize(block)
+{
+    jassert(numInstances > 0 && sampleRate > 0.0 && blockSize > 0);
+}
+
+StateBenchmarkResult StateBenchmark::runBinary()
+{
+    return run("binary",
+               [](CustomEQAudioProcessor& processor, juce::MemoryBlock& data) { processor.getStateInformation(data); },
+               [](CustomEQAudioProcessor& processor, const juce::MemoryBlock& data)
+               {
+                   processor.setStateInformation(data.getData(), static_cast<int>(data.getSize()));
+               });
+}
+
+StateBenchmarkResult StateBenchmark::runXml()
+{
+    // what most plugins do: the whole tree through xml, with nothing holding the designer off
+    return run("xml",
+               [](CustomEQAudioProcessor& processor, juce::MemoryBlock& data)
+               {
+                   if (auto xml = processor.apvts.copyState().createXml())
+                       juce::AudioProcessor::copyXmlToBinary(*xml, data);
+               },
+               [](CustomEQAudioProcessor& processor, const juce::MemoryBlock& data)
+               {
+                   if (auto xml = juce::AudioProcessor::getXmlFromBinary(data.getData(), static_cast<int>(data.getSize())))
+                       processor.apvts.replaceState(juce::ValueTree::fromXml(*xml));
+               });
+}
+
+StateBenchmarkResult StateBenchmark::run(const juce::String& format, SaveFunction save, RestoreFunction restore)
+{
+    juce::Random random{ 0x5eed };
+
+    std::vector<std::unique_ptr<CustomEQAudioProcessor>> sources, targets;
+    std::vector<juce::MemoryBlock> states(static_cast<size_t>(numInstances));
+
+    for (int i = 0; i < numInstances; ++i)
+    {
+        sources.push_back(std::make_unique<CustomEQAudioProcessor>());
+        randomiseParameters(*sources.back(), random);
+
+        // prepared, so the designer is watching the way it is in a session that's loading
+        targets.push_back(std::make_unique<CustomEQAudioProcessor>());
+        targets.back()->setRateAndBufferSizeDetails(sampleRate, blockSize);
+        targets.back()->prepareToPlay(sampleRate, blockSize);
+    }
+
+    std::vector<double> saveMicroseconds, restoreMicroseconds;
+
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        save(*sources[i], states[i]);
+        saveMicroseconds.push_back(ticksToMicroseconds(juce::Time::getHighResolutionTicks() - start));
+    }
+
+    // where every designer stands before the restore, the serial counts the sets published
+    std::vector<juce::uint32> serials(targets.size(), 0);
+    waitForDesigners(targets, serials);
+    auto serialsBefore = serials;
+
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        restore(*targets[i], states[i]);
+        restoreMicroseconds.push_back(ticksToMicroseconds(juce::Time::getHighResolutionTicks() - start));
+    }
+
+    waitForDesigners(targets, serials);
+
+    for (auto& target : targets)
+        target->releaseResources();
+
+    auto designPasses = 0.0;
+
+    for (size_t i = 0; i < serials.size(); ++i)
+        designPasses += static_cast<double>(serials[i] - serialsBefore[i]);
+
+    StateBenchmarkResult result;
+    result.format = format;
+    result.numInstances = numInstances;
+    result.stateBytes = static_cast<int>(states.front().getSize());
+    result.meanSaveMicroseconds = std::accumulate(saveMicroseconds.begin(), saveMicroseconds.end(), 0.0) / numInstances;
+    result.maxSaveMicroseconds = *std::max_element(saveMicroseconds.begin(), saveMicroseconds.end());
+    result.meanRestoreMicroseconds = std::accumulate(restoreMicroseconds.begin(), restoreMicroseconds.end(), 0.0) / numInstances;
+    result.maxRestoreMicroseconds = *std::max_element(restoreMicroseconds.begin(), restoreMicroseconds.end());
+    result.designPassesPerRestore = designPasses / numInstances;
+    return result;
+}
+
+void StateBenchmark::randomiseParameters(CustomEQAudioProcessor& processor, juce::Random& random)
+{
+    for (auto* parameter : processor.getParameters())
+    {
+        // anywhere but the default, which is where a fresh instance already is
+        auto value = random.nextFloat();
+
+        if (std::abs(value - parameter->getDefaultValue()) < 0.05f)
+            value = 1.0f - value;
+
+        parameter->setValueNotifyingHost(value);
+    }
+
+    auto* coefficientMode = processor.apvts.getParameter("Coefficient Mode");
+    coefficientMode->setValueNotifyingHost(coefficientMode->convertTo0to1(static_cast<float>(CoefficientMode::Exact)));
+}
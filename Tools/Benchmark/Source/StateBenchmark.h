@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    StateBenchmark.h
+    Times getStateInformation() and setStateInformation() per instance, the
+    binary state against the parameter tree as xml.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Shared/ProcessorSettings.h"
+
+struct StateBenchmarkResult
+{
+    // "binary" or "xml"
+    juce::String format;
+    int numInstances{ 0 };
+    int stateBytes{ 0 };
+
+    double meanSaveMicroseconds{ 0.0 };
+    double maxSaveMicroseconds{ 0.0 };
+    double meanRestoreMicroseconds{ 0.0 };
+    double maxRestoreMicroseconds{ 0.0 };
+
+    // coefficient sets each instance's designer published for one restore, 1 is the least there can be
+    double designPassesPerRestore{ 0.0 };
+
+    juce::var toVar() const;
+};
+
+//==============================================================================
+/**
+    Loads a project the way a host does: numInstances prepared processors, all
+    of them restored one after the other on the message thread, each from a
+    state where every parameter differs from its default so every stage has to
+    be designed again.
+
+    Only the save and restore calls are timed. Afterwards it waits for every
+    designer to settle and counts what they published, which is how the batch
+    restore shows it designs once where the xml one designs as often as the
+    designer thread happens to look in between parameters.
+*/
+class StateBenchmark
+{
+public:
+    StateBenchmark(int numInstances, double sampleRate, int blockSize);
+
+    StateBenchmarkResult runBinary();
+    StateBenchmarkResult runXml();
+
+private:
+    using SaveFunction = std::function<void(CustomEQAudioProcessor&, juce::MemoryBlock&)>;
+    using RestoreFunction = std::function<void(CustomEQAudioProcessor&, const juce::MemoryBlock&)>;
+
+    StateBenchmarkResult run(const juce::String& format, SaveFunction save, RestoreFunction restore);
+
+    // every parameter somewhere other than its default, Exact coefficients so the tables don't add a pass of their own
+    static void randomiseParameters(CustomEQAudioProcessor& processor, juce::Random& random);
+
+    int numInstances{ 0 };
+    double sampleRate{ 48000.0 };
+    int blockSize{ 512 };
+
+    JUCE_DECLARE_NON_COPYABLE(StateBenchmark)
+};
@@ -0,0 +1,234 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    CustomEQ Realtime Safety Check: drives every parameter through its range
+    while processBlock() runs, and fails on any allocation or lock it makes,
+    or on the SIMD path putting out something the scalar path doesn't.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "RealtimeSafety.h"
+#include "PathEquivalence.h"
+#include "../../Shared/ProcessorSettings.h"
+
+namespace
+{
+    // the bus, rate and block size a run is prepared with, each one gets a fresh processor
+    struct Configuration
+    {
+        juce::String name;
+        int numChannels;
+        double sampleRate;
+        int blockSize;
+        bool useDoublePrecision;
+        CustomEQAudioProcessor::ProcessingPath path;
+    };
+
+    using Path = CustomEQAudioProcessor::ProcessingPath;
+
+    const Configuration configurations[] =
+    {
+        { "stereo, 48k, 512, SIMD",     2,  48000.0,  512, false, Path::SIMD },
+        { "stereo, 48k, 512, scalar",   2,  48000.0,  512, false, Path::Scalar },
+        { "mono, 44.1k, 64",            1,  44100.0,   64, false, Path::SIMD },
+        { "5.1, 96k, 256",              6,  96000.0,  256, false, Path::SIMD },
+        { "7.1.4, 48k, 1024",          12,  48000.0, 1024, false, Path::SIMD },
+        { "stereo, 192k, 333, double",  2, 192000.0,  333, true,  Path::SIMD }
+    };
+
+    // how far apart the steps of a continuous parameter's sweep are, and how many blocks each step gets
+    constexpr int stepsPerSweep = 24;
+    constexpr int blocksPerStep = 3;
+    constexpr int randomBlocks = 400;
+
+    class Harness
+    {
+    public:
+        explicit Harness(const Configuration& configurationToRun) : configuration(configurationToRun)
+        {
+            processor.setBusesLayout(getLayoutForChannels(configuration.numChannels));
+            processor.setProcessingPrecision(configuration.useDoublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                              : juce::AudioProcessor::singlePrecision);
+            processor.setProcessingPath(configuration.path);
+            processor.setRateAndBufferSizeDetails(configuration.sampleRate, configuration.blockSize);
+            processor.prepareToPlay(configuration.sampleRate, configuration.blockSize);
+
+            // as if the editor were open, so the analyzer's side of the callback gets checked too
+            processor.getAnalyzer().start();
+
+            buffer.setSize(configuration.numChannels, configuration.blockSize);
+            preciseBuffer.setSize(configuration.numChannels, configuration.blockSize);
+        }
+
+        ~Harness()
+        {
+            processor.getAnalyzer().stop();
+            processor.releaseResources();
+        }
+
+        // one parameter at a time through every value it has, or stepsPerSweep of them, and back to where it started
+        void sweepEveryParameter()
+        {
+            for (auto* parameter : processor.getParameters())
+            {
+                auto defaultValue = parameter->getValue();
+                auto numSteps = parameter->getNumSteps() <= stepsPerSweep ? parameter->getNumSteps() : stepsPerSweep;
+
+                for (int step = 0; step < numSteps; ++step)
+                    setAndProcess(*parameter, static_cast<float>(step) / static_cast<float>(juce::jmax(1, numSteps - 1)));
+
+                setAndProcess(*parameter, defaultValue);
+            }
+        }
+
+        // every parameter at a random value every block, with random block sizes up to the prepared one
+        void randomiseEverything()
+        {
+            for (int block = 0; block < randomBlocks; ++block)
+            {
+                for (auto* parameter : processor.getParameters())
+                    parameter->setValueNotifyingHost(random.nextFloat());
+
+                process(1 + random.nextInt(configuration.blockSize));
+            }
+        }
+
+    private:
+        void setAndProcess(juce::AudioProcessorParameter& parameter, float value)
+        {
+            parameter.setValueNotifyingHost(value);
+
+            // a little time between blocks, so the designer thread gets to publish and the audio thread picks the new set up
+            for (int block = 0; block < blocksPerStep; ++block)
+            {
+                process(configuration.blockSize);
+                juce::Thread::sleep(1);
+            }
+        }
+
+        void process(int numSamples)
+        {
+            // noise, so the silence gate never skips the chain. filled in before the check starts
+            for (int channel = 0; channel < configuration.numChannels; ++channel)
+            {
+                auto* samples = buffer.getWritePointer(channel);
+
+                for (int i = 0; i < numSamples; ++i)
+                    samples[i] = 0.25f * (2.0f * random.nextFloat() - 1.0f);
+            }
+
+            if (configuration.useDoublePrecision)
+            {
+                for (int channel = 0; channel < configuration.numChannels; ++channel)
+                    for (int i = 0; i < numSamples; ++i)
+                        preciseBuffer.setSample(channel, i, buffer.getSample(channel, i));
+
+                juce::AudioBuffer<double> block(preciseBuffer.getArrayOfWritePointers(), configuration.numChannels, numSamples);
+                const RealtimeSafety::ScopedCheck check;
+                processor.processBlock(block, midi);
+            }
+            else
+            {
+                juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), configuration.numChannels, numSamples);
+                const RealtimeSafety::ScopedCheck check;
+                processor.processBlock(block, midi);
+            }
+        }
+
+        Configuration configuration;
+        CustomEQAudioProcessor processor;
+        juce::AudioBuffer<float> buffer;
+        juce::AudioBuffer<double> preciseBuffer;
+        juce::MidiBuffer midi;
+        juce::Random random{ 0x5eed };
+    };
+
+    // the hooks have to be live, or a clean run means nothing
+    bool hooksAreWorking()
+    {
+        juce::CriticalSection lock;
+
+        {
+            const RealtimeSafety::ScopedCheck check;
+            std::unique_ptr<int> allocation(new int(1));
+            const juce::ScopedLock scopedLock(lock);
+        }
+
+        auto reports = RealtimeSafety::takeReports();
+        auto sawLock = std::any_of(reports.begin(), reports.end(), [](auto& report) { return report.violation == RealtimeSafety::Violation::lock; });
+
+        return ! reports.empty() && (sawLock || ! RealtimeSafety::canInterceptSystemCalls());
+    }
+}
+
+//==============================================================================
+int main (int, char*[])
+{
+    // the processor's parameter tree expects a message manager to exist, even though nothing here runs a message loop
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    if (! hooksAreWorking())
+    {
+        std::cerr << "error: the allocation and lock hooks aren't being called, nothing would get caught" << std::endl;
+        return 1;
+    }
+
+    if (! RealtimeSafety::canInterceptSystemCalls())
+        std::cout << "only operator new and delete are checked on this platform, malloc and locks need Linux\n\n";
+
+    auto numViolations = 0;
+
+    for (auto& configuration : configurations)
+    {
+        {
+            Harness harness(configuration);
+            harness.sweepEveryParameter();
+            harness.randomiseEverything();
+        }
+
+        auto reports = RealtimeSafety::takeReports();
+
+        if (reports.empty())
+        {
+            std::cout << configuration.name << ": ok" << std::endl;
+            continue;
+        }
+
+        std::cout << configuration.name << ": " << static_cast<int>(reports.size()) << " violations\n";
+
+        for (auto& report : reports)
+        {
+            std::cout << "\n  " << RealtimeSafety::getDescription(report.violation) << " in " << report.function
+                      << " (" << report.count << " times)\n" << report.stackTrace << "\n";
+        }
+
+        numViolations += static_cast<int>(reports.size());
+    }
+
+    if (numViolations != 0)
+        std::cout << "\n" << numViolations << " places on the audio thread that allocate or lock" << std::endl;
+
+    // the lanes against the scalar kernel, then whole processors on either path
+    auto mismatches = PathEquivalence::checkKernels();
+    auto processorMismatches = PathEquivalence::checkProcessors();
+    mismatches.insert(mismatches.end(), processorMismatches.begin(), processorMismatches.end());
+
+    if (mismatches.empty())
+    {
+        std::cout << "\nSIMD against scalar: ok" << std::endl;
+        return numViolations == 0 ? 0 : 1;
+    }
+
+    std::cout << "\nSIMD against scalar: " << static_cast<int>(mismatches.size()) << " cases over "
+              << juce::String(PathEquivalence::maxDeviation) << "\n";
+
+    for (auto& mismatch : mismatches)
+        std::cout << "  " << mismatch.description << ": " << juce::String(mismatch.deviation) << "\n";
+
+    std::cout << std::flush;
+    return 1;
+}
@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    PathEquivalence.cpp
+    Checks that the SIMD path puts out what the scalar path does, for every
+    slope, cut filter type, peak topology and channel count.
+
+  ==============================================================================
+*/
+
+#include "PathEquivalence.h"
+#include "../../Shared/ProcessorSettings.h"
+
+namespace PathEquivalence
+{
+    namespace
+    {
+        const char* const slopeNames[] = { "12", "24", "36", "48", "96" };
+        const char* const filterTypeNames[] = { "Butterworth", "Chebyshev I", "Chebyshev II", "Elliptic" };
+        const char* const topologyNames[] = { "biquad peak", "SVF peak" };
+        const char* const precisionNames[] = { "Float", "Mixed" };
+
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+        constexpr int numBlocks = 8;
+        constexpr int maxChannels = 8;
+
+        // a low cut, a boosted peak and a high cut far enough apart that every stage shapes the noise
+        constexpr float lowCutFrequency = 40.0f, peakFrequency = 1000.0f, peakGainInDecibels = 6.0f, highCutFrequency = 12000.0f;
+
+        // the way the designer does it, makeCutFilterCoefficients() doesn't take Butterworth
+        CutCoefficients makeCut(CutFilterType type, float frequency, Slope slope, bool isHighpass)
+        {
+            return type == Butterworth ? makeCutCoefficients(frequency, sampleRate, getOrderForSlope(slope), isHighpass)
+                                       : makeCutFilterCoefficients(type, frequency, sampleRate, slope, isHighpass);
+        }
+
+        juce::String describe(int slope, int filterType, int topology)
+        {
+            return juce::String(slopeNames[slope]) + " dB/Oct " + filterTypeNames[filterType] + ", " + topologyNames[topology];
+        }
+
+        void setParameter(CustomEQAudioProcessor& processor, const juce::String& parameterID, float value)
+        {
+            auto* parameter = processor.apvts.getParameter(parameterID);
+            jassert(parameter != nullptr);
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+
+        float getDeviation(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+        {
+            auto deviation = 0.0f;
+
+            for (int channel = 0; channel < a.getNumChannels(); ++channel)
+                for (int i = 0; i < a.getNumSamples(); ++i)
+                    deviation = juce::jmax(deviation, std::abs(a.getSample(channel, i) - b.getSample(channel, i)));
+
+            return deviation;
+        }
+    }
+
+    std::vector<Mismatch> checkKernels()
+    {
+        std::vector<Mismatch> mismatches;
+
+        ChainSettings peakSettings;
+        peakSettings.peakFreq = peakFrequency;
+        peakSettings.peakQuality = 1.0f;
+        peakSettings.peakGainInDecibels = peakGainInDecibels;
+
+        CutCoefficients peak{};
+        peak[0] = makePeakCoefficients(peakSettings, sampleRate);
+
+        // the SVF peak's coefficients held still, the same for every sample
+        auto g = static_cast<float>(std::tan(juce::MathConstants<double>::pi * peakFrequency / sampleRate));
+        std::vector<SVFPeakCoefficients> peakRamp(static_cast<size_t>(blockSize),
+                                                  makeSVFPeakCoefficients(g, 1.0f, juce::Decibels::decibelsToGain(peakGainInDecibels * 0.5f)));
+
+        for (int filterType = Butterworth; filterType <= Elliptic; ++filterType)
+        {
+            for (int slope = Slope_12; slope <= Slope_96; ++slope)
+            {
+                auto type = static_cast<CutFilterType>(filterType);
+                auto numSections = getNumCutSections(type, static_cast<Slope>(slope));
+
+                auto cascade = makeCascadeCoefficients(makeCut(type, lowCutFrequency, static_cast<Slope>(slope), true), numSections,
+                                                       peak,
+                                                       makeCut(type, highCutFrequency, static_cast<Slope>(slope), false), numSections);
+
+                for (int topology = Biquad; topology <= StateVariable; ++topology)
+                {
+                    auto deviation = measureSIMDDeviation(cascade, blockSize, topology == StateVariable ? peakRamp.data() : nullptr);
+
+                    if (! (deviation <= maxDeviation))
+                        mismatches.push_back({ "kernel, " + describe(slope, filterType, topology), deviation });
+                }
+            }
+        }
+
+        return mismatches;
+    }
+
+    std::vector<Mismatch> checkProcessors()
+    {
+        std::vector<Mismatch> mismatches;
+
+        // the same noise into both, different on every channel so the identical channel pass never kicks in
+        juce::AudioBuffer<float> input(maxChannels, blockSize * numBlocks);
+        juce::Random random(0x5eed);
+
+        for (int channel = 0; channel < maxChannels; ++channel)
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                input.setSample(channel, i, 0.25f * (2.0f * random.nextFloat() - 1.0f));
+
+        for (int numChannels = 1; numChannels <= maxChannels; ++numChannels)
+        {
+            CustomEQAudioProcessor simd, scalar;
+            simd.setProcessingPath(CustomEQAudioProcessor::ProcessingPath::SIMD);
+            scalar.setProcessingPath(CustomEQAudioProcessor::ProcessingPath::Scalar);
+
+            for (auto* processor : { &simd, &scalar })
+            {
+                processor->setBusesLayout(getLayoutForChannels(numChannels));
+                processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+                setParameter(*processor, "LowCut Freq", lowCutFrequency);
+                setParameter(*processor, "HighCut Freq", highCutFrequency);
+                setParameter(*processor, "Peak Freq", peakFrequency);
+                setParameter(*processor, "Peak Gain", peakGainInDecibels);
+            }
+
+            juce::AudioBuffer<float> simdOutput(numChannels, blockSize), scalarOutput(numChannels, blockSize);
+            juce::MidiBuffer midi;
+
+            for (int precision = 0; precision < 2; ++precision)
+            {
+                for (int filterType = Butterworth; filterType <= Elliptic; ++filterType)
+                {
+                    for (int slope = Slope_12; slope <= Slope_96; ++slope)
+                    {
+                        for (int topology = Biquad; topology <= StateVariable; ++topology)
+                        {
+                            // prepareToPlay designs the first set from the parameters straight away, so both start on the
+                            // same coefficients and the designer thread has nothing left to change afterwards
+                            for (auto* processor : { &simd, &scalar })
+                            {
+                                setParameter(*processor, "Precision", static_cast<float>(precision));
+                                setParameter(*processor, "Cut Filter Type", static_cast<float>(filterType));
+                                setParameter(*processor, "LowCut Slope", static_cast<float>(slope));
+                                setParameter(*processor, "HighCut Slope", static_cast<float>(slope));
+                                setParameter(*processor, "Peak Topology", static_cast<float>(topology));
+                                processor->prepareToPlay(sampleRate, blockSize);
+                            }
+
+                            auto deviation = 0.0f;
+
+                            for (int block = 0; block < numBlocks; ++block)
+                            {
+                                for (int channel = 0; channel < numChannels; ++channel)
+                                {
+                                    simdOutput.copyFrom(channel, 0, input, channel, block * blockSize, blockSize);
+                                    scalarOutput.copyFrom(channel, 0, input, channel, block * blockSize, blockSize);
+                                }
+
+                                simd.processBlock(simdOutput, midi);
+                                scalar.processBlock(scalarOutput, midi);
+                                deviation = juce::jmax(deviation, getDeviation(simdOutput, scalarOutput));
+                            }
+
+                            if (! (deviation <= maxDeviation))
+                                mismatches.push_back({ juce::String(numChannels) + " channels, " + precisionNames[precision] + ", "
+                                                     + describe(slope, filterType, topology), deviation });
+                        }
+                    }
+                }
+            }
+
+            simd.releaseResources();
+            scalar.releaseResources();
+        }
+
+        return mismatches;
+    }
+}
@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    PathEquivalence.h
+    Checks that the SIMD path puts out what the scalar path does, for every
+    slope, cut filter type, peak topology and channel count.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+    Two levels. The kernels: every slope and cut filter type as designed, with the biquad peak and with the
+    state variable one, through measureSIMDDeviation(). The processor: two of them prepared with the same
+    settings, one asked for the SIMD path and one for the scalar one, fed the same noise for a few blocks on
+    1 to 8 channels, so the lane packing, the short last lane group and the fallback to scalar for mixed
+    precision cascades get checked as well.
+
+    Anything further apart than maxDeviation is reported. The lanes run the same float maths as the scalar
+    kernel, so what's left is rounding.
+*/
+namespace PathEquivalence
+{
+    constexpr float maxDeviation = 1.0e-4f;
+
+    struct Mismatch
+    {
+        juce::String description;
+        float deviation{ 0.0f };
+    };
+
+    std::vector<Mismatch> checkKernels();
+    std::vector<Mismatch> checkProcessors();
+}
@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+    Catches allocations and locks on a thread while it's inside a checked
+    scope, with a stack trace of where they happened.
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+#include <mutex>
+#include <new>
+#include <utility>
+
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+namespace RealtimeSafety
+{
+    namespace
+    {
+        // plain bool, so reading it from inside malloc never needs an allocation of its own
+        thread_local bool isChecking = false;
+
+        std::mutex reportLock;
+        std::vector<Report> reports;
+    }
+
+    bool canInterceptSystemCalls() noexcept
+    {
+       #if JUCE_LINUX
+        return true;
+       #else
+        return false;
+       #endif
+    }
+
+    ScopedCheck::ScopedCheck() noexcept : wasChecking(isChecking) { isChecking = true; }
+    ScopedCheck::~ScopedCheck() noexcept { isChecking = wasChecking; }
+
+    ScopedSuspend::ScopedSuspend() noexcept : wasChecking(isChecking) { isChecking = false; }
+    ScopedSuspend::~ScopedSuspend() noexcept { isChecking = wasChecking; }
+
+    void reportIfChecking(Violation violation, const char* function) noexcept
+    {
+        if (! isChecking)
+            return;
+
+        // the stack trace and the report allocate and lock too, none of that is the audio thread's doing
+        const ScopedSuspend suspend;
+
+        try
+        {
+            auto stackTrace = juce::SystemStats::getStackBacktrace();
+            const std::lock_guard<std::mutex> lock(reportLock);
+
+            for (auto& report : reports)
+            {
+                if (report.violation == violation && report.stackTrace == stackTrace)
+                {
+                    ++report.count;
+                    return;
+                }
+            }
+
+            reports.push_back({ violation, function, stackTrace });
+        }
+        catch (...)
+        {
+        }
+    }
+
+    std::vector<Report> takeReports()
+    {
+        const ScopedSuspend suspend;
+        const std::lock_guard<std::mutex> lock(reportLock);
+        return std::exchange(reports, {});
+    }
+
+    juce::String getDescription(Violation violation)
+    {
+        switch (violation)
+        {
+        case Violation::allocation:   return "allocation";
+        case Violation::deallocation: return "deallocation";
+        case Violation::lock:         return "lock";
+        }
+        return {};
+    }
+}
+
+using RealtimeSafety::Violation;
+
+//==============================================================================
+// operator new and delete, every variant, on top of malloc and free so they pair up with anything else's
+
+namespace
+{
+    void* allocate(std::size_t size, const char* function)
+    {
+        RealtimeSafety::reportIfChecking(Violation::allocation, function);
+        const RealtimeSafety::ScopedSuspend suspend;
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void* allocateAligned(std::size_t size, std::align_val_t alignment, const char* function)
+    {
+        RealtimeSafety::reportIfChecking(Violation::allocation, function);
+        const RealtimeSafety::ScopedSuspend suspend;
+        auto alignmentBytes = static_cast<std::size_t>(alignment);
+        auto roundedSize = (juce::jmax<std::size_t>(size, 1) + alignmentBytes - 1) / alignmentBytes * alignmentBytes;
+
+       #if JUCE_WINDOWS
+        return _aligned_malloc(roundedSize, alignmentBytes);
+       #else
+        return std::aligned_alloc(alignmentBytes, roundedSize);
+       #endif
+    }
+
+    void deallocate(void* pointer, const char* function) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+
+        RealtimeSafety::reportIfChecking(Violation::deallocation, function);
+        const RealtimeSafety::ScopedSuspend suspend;
+        std::free(pointer);
+    }
+
+    void deallocateAligned(void* pointer, const char* function) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+
+        RealtimeSafety::reportIfChecking(Violation::deallocation, function);
+        const RealtimeSafety::ScopedSuspend suspend;
+
+       #if JUCE_WINDOWS
+        _aligned_free(pointer);
+       #else
+        std::free(pointer);
+       #endif
+    }
+
+    template <typename Pointer>
+    Pointer throwIfNull(Pointer pointer)
+    {
+        if (pointer == nullptr)
+            throw std::bad_alloc();
+
+        return pointer;
+    }
+}
+
+void* operator new (std::size_t size)                                                   { return throwIfNull(allocate(size, "operator new")); }
+void* operator new[] (std::size_t size)                                                 { return throwIfNull(allocate(size, "operator new[]")); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept                   { return allocate(size, "operator new"); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept                 { return allocate(size, "operator new[]"); }
+void* operator new (std::size_t size, std::align_val_t alignment)                       { return throwIfNull(allocateAligned(size, alignment, "operator new")); }
+void* operator new[] (std::size_t size, std::align_val_t alignment)                     { return throwIfNull(allocateAligned(size, alignment, "operator new[]")); }
+void* operator new (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept   { return allocateAligned(size, alignment, "operator new"); }
+void* operator new[] (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment, "operator new[]"); }
+
+void operator delete (void* pointer) noexcept                                           { deallocate(pointer, "operator delete"); }
+void operator delete[] (void* pointer) noexcept                                         { deallocate(pointer, "operator delete[]"); }
+void operator delete (void* pointer, std::size_t) noexcept                              { deallocate(pointer, "operator delete"); }
+void operator delete[] (void* pointer, std::size_t) noexcept                            { deallocate(pointer, "operator delete[]"); }
+void operator delete (void* pointer, const std::nothrow_t&) noexcept                    { deallocate(pointer, "operator delete"); }
+void operator delete[] (void* pointer, const std::nothrow_t&) noexcept                  { deallocate(pointer, "operator delete[]"); }
+void operator delete (void* pointer, std::align_val_t) noexcept                         { deallocateAligned(pointer, "operator delete"); }
+void operator delete[] (void* pointer, std::align_val_t) noexcept                       { deallocateAligned(pointer, "operator delete[]"); }
+void operator delete (void* pointer, std::size_t, std::align_val_t) noexcept            { deallocateAligned(pointer, "operator delete"); }
+void operator delete[] (void* pointer, std::size_t, std::align_val_t) noexcept          { deallocateAligned(pointer, "operator delete[]"); }
+void operator delete (void* pointer, std::align_val_t, const std::nothrow_t&) noexcept  { deallocateAligned(pointer, "operator delete"); }
+void operator delete[] (void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { deallocateAligned(pointer, "operator delete[]"); }
+
+//==============================================================================
+#if JUCE_LINUX
+// glibc's own entry points, what the replacements below forward to
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* pointer);
+
+    void* malloc(size_t size) noexcept
+    {
+        RealtimeSafety::reportIfChecking(Violation::allocation, "malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept
+    {
+        RealtimeSafety::reportIfChecking(Violation::allocation, "calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size) noexcept
+    {
+        RealtimeSafety::reportIfChecking(Violation::allocation, "realloc");
+        return __libc_realloc(pointer, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) noexcept
+    {
+        RealtimeSafety::reportIfChecking(Violation::allocation, "aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept
+    {
+        RealtimeSafety::reportIfChecking(Violation::allocation, "posix_memalign");
+        *pointer = __libc_memalign(alignment, size);
+        return *pointer != nullptr ? 0 : ENOMEM;
+    }
+
+    void free(void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            RealtimeSafety::reportIfChecking(Violation::deallocation, "free");
+
+        __libc_free(pointer);
+    }
+
+    // the real lock functions only have compat versions under their internal names, so they're looked up
+    // the first time they're needed. a plain pointer rather than a function static, whose guard could lock.
+    // glibc's own locking doesn't come through here, so the lookup can't recurse
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        static int (*lock)(pthread_mutex_t*) = nullptr;
+
+        if (lock == nullptr)
+            lock = reinterpret_cast<int (*)(pthread_mutex_t*)>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+
+        RealtimeSafety::reportIfChecking(Violation::lock, "pthread_mutex_lock");
+        return lock(mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock) noexcept
+    {
+        static int (*lock)(pthread_rwlock_t*) = nullptr;
+
+        if (lock == nullptr)
+            lock = reinterpret_cast<int (*)(pthread_rwlock_t*)>(dlsym(RTLD_NEXT, "pthread_rwlock_rdlock"));
+
+        RealtimeSafety::reportIfChecking(Violation::lock, "pthread_rwlock_rdlock");
+        return lock(rwlock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* rwlock) noexcept
+    {
+        static int (*lock)(pthread_rwlock_t*) = nullptr;
+
+        if (lock == nullptr)
+            lock = reinterpret_cast<int (*)(pthread_rwlock_t*)>(dlsym(RTLD_NEXT, "pthread_rwlock_wrlock"));
+
+        RealtimeSafety::reportIfChecking(Violation::lock, "pthread_rwlock_wrlock");
+        return lock(rwlock);
+    }
+}
+#endif
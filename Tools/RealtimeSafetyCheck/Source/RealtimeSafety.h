@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+    Catches allocations and locks on a thread while it's inside a checked
+    scope, with a stack trace of where they happened.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+    The hooks replace operator new and delete everywhere. On Linux malloc, calloc, realloc, free,
+    the aligned allocations and the pthread mutex and rwlock locks are replaced as well, they forward
+    to glibc, so anything that allocates or blocks through them gets seen, JUCE and the standard
+    library included. Elsewhere only operator new and delete are caught.
+
+    The check is per thread, whatever other threads (the coefficient designer, the message thread)
+    do is never reported.
+*/
+namespace RealtimeSafety
+{
+    enum class Violation
+    {
+        allocation,
+        deallocation,
+        lock
+    };
+
+    struct Report
+    {
+        Violation violation{ Violation::allocation };
+        juce::String function;
+        juce::String stackTrace;
+
+        // the same violation from the same place only gets stored once
+        int count{ 1 };
+    };
+
+    // false where only operator new and delete are hooked
+    bool canInterceptSystemCalls() noexcept;
+
+    // everything the calling thread does while one of these exists gets checked
+    class ScopedCheck
+    {
+    public:
+        ScopedCheck() noexcept;
+        ~ScopedCheck() noexcept;
+
+    private:
+        bool wasChecking;
+        JUCE_DECLARE_NON_COPYABLE(ScopedCheck)
+    };
+
+    // lets the calling thread through unchecked, for the hooks' own work
+    class ScopedSuspend
+    {
+    public:
+        ScopedSuspend() noexcept;
+        ~ScopedSuspend() noexcept;
+
+    private:
+        bool wasChecking;
+        JUCE_DECLARE_NON_COPYABLE(ScopedSuspend)
+    };
+
+    // called by the hooks, stores a report with the stack trace if the calling thread is being checked
+    void reportIfChecking(Violation violation, const char* function) noexcept;
+
+    // everything reported so far, from every thread, and starts over
+    std::vector<Report> takeReports();
+
+    juce::String getDescription(Violation violation);
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    ProcessorSettings.cpp
+    Setting up a CustomEQAudioProcessor from the command line, shared by the
+    tools in this folder.
+
+  ==============================================================================
+*/
+
+#include "ProcessorSettings.h"
+
+juce::Result loadStateFile(CustomEQAudioProcessor& processor, const juce::File& file)
+{
+    juce::MemoryBlock data;
+
+    if (! file.loadFileAsData(data))
+        return juce::Result::fail("can't read " + file.getFullPathName());
+
+    // a preset written by --save-state is the parameter tree as xml, anything else is up to setStateInformation()
+    if (auto xml = juce::parseXML(file); xml != nullptr && xml->hasTagName(processor.apvts.state.getType().toString()))
+        processor.apvts.replaceState(juce::ValueTree::fromXml(*xml));
+    else
+        processor.setStateInformation(data.getData(), static_cast<int>(data.getSize()));
+
+    return juce::Result::ok();
+}
+
+juce::Result applyParameterOverride(CustomEQAudioProcessor& processor, const juce::String& assignment)
+{
+    auto parameterID = assignment.upToFirstOccurrenceOf("=", false, false).trim();
+    auto value = assignment.fromFirstOccurrenceOf("=", false, false).trim();
+
+    auto* parameter = processor.apvts.getParameter(parameterID);
+
+    if (parameter == nullptr)
+        return juce::Result::fail("no parameter called \"" + parameterID + "\"");
+
+    if (value.isEmpty())
+        return juce::Result::fail("no value for \"" + parameterID + "\"");
+
+    // a choice falls back to its first entry for text it doesn't know, so that has to be caught here
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(parameter))
+        if (! choice->choices.contains(value))
+            return juce::Result::fail("\"" + parameterID + "\" is one of " + choice->choices.joinIntoString(", "));
+
+    parameter->setValueNotifyingHost(parameter->getValueForText(value));
+    return juce::Result::ok();
+}
+
+juce::String describeParameters(const CustomEQAudioProcessor& processor)
+{
+    juce::String description;
+
+    for (auto* parameter : processor.getParameters())
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+
+        if (ranged == nullptr)
+            continue;
+
+        description << "\"" << ranged->getParameterID() << "\" = " << ranged->getCurrentValueAsText();
+
+        if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(ranged))
+            description << "   (" << choice->choices.joinIntoString(", ") << ")";
+
+        description << "\n";
+    }
+
+    return description;
+}
+
+juce::AudioProcessor::BusesLayout getLayoutForChannels(int numChannels)
+{
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    return layout;
+}
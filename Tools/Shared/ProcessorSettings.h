@@ -0,0 +1,26 @@
+/*
+  ==============================================================================
+
+    ProcessorSettings.h
+    Setting up a CustomEQAudioProcessor from the command line, shared by the
+    tools in this folder.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+// everything a state file can set up: the parameter tree as xml, or whatever getStateInformation() wrote
+juce::Result loadStateFile(CustomEQAudioProcessor& processor, const juce::File& file);
+
+// "<parameter id>=<value>", the value as the parameter would display it, so "80" for a frequency or "Linear Phase" for a choice
+juce::Result applyParameterOverride(CustomEQAudioProcessor& processor, const juce::String& assignment);
+
+// one line per parameter, its id, current value and the choices if it has any
+juce::String describeParameters(const CustomEQAudioProcessor& processor);
+
+// the layout a file or a benchmark case with this many channels runs on, the input and output always match
+juce::AudioProcessor::BusesLayout getLayoutForChannels(int numChannels);